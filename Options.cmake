@@ -27,6 +27,16 @@ macro(PD_setup_options)
 
     pd_supports_sanitizers()
 
+    set(PD_MAX_LIGHTS
+        "5"
+        CACHE STRING "Maximum number of lights of each type supported by shaders")
+    set(PD_MAX_CLUSTERED_LIGHTS
+        "1024"
+        CACHE STRING "Maximum number of point and spot lights supported by clustered lighting")
+    set(PD_SHADER_DEFINES
+        ""
+        CACHE STRING "Additional preprocessor definitions passed to every shader")
+
     if(NOT PROJECT_IS_TOP_LEVEL)
         option(PD_BUILD_APP "Build app" ON)
         option(PD_ENABLE_IPO "Enable IPO/LTO" OFF)
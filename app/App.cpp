@@ -72,14 +72,14 @@ namespace
     std::_Exit(signalValue);
 }
 
+constexpr auto rotationVelocity = 500.F;
+constexpr auto moveVelocity = 2.5F;
+
 void processCamera(float deltaTime,
                    const app::GlfwWindow& window,
                    panda::gfx::vulkan::Transform& cameraObject,
                    panda::gfx::Camera& camera)
 {
-    static constexpr auto rotationVelocity = 500.F;
-    static constexpr auto moveVelocity = 2.5F;
-
     if (window.getMouseHandler().getButtonState(GLFW_MOUSE_BUTTON_LEFT) == app::MouseHandler::ButtonState::Pressed)
     {
         cameraObject.rotation +=
@@ -121,6 +121,28 @@ void processCamera(float deltaTime,
     });
 }
 
+void latchCamera(float deltaTime,
+                 const app::GlfwWindow& window,
+                 const panda::gfx::vulkan::Transform& cameraObject,
+                 panda::gfx::Camera& camera)
+{
+    if (window.getMouseHandler().getButtonState(GLFW_MOUSE_BUTTON_LEFT) != app::MouseHandler::ButtonState::Pressed)
+    {
+        return;
+    }
+
+    // Only the view is latched, the camera object picks the pending motion up once its events are processed
+    const auto pendingRotation =
+        app::RotationHandler {window}.getRotation(window.getMouseHandler().getPendingCursorDelta());
+    auto rotation = cameraObject.rotation + glm::vec3 {pendingRotation * rotationVelocity * deltaTime, 0};
+    rotation.x = glm::clamp(rotation.x, -glm::half_pi<float>(), glm::half_pi<float>());
+
+    camera.setViewYXZ(panda::gfx::view::YXZ {
+        .position = cameraObject.translation,
+        .rotation = {-rotation.x, rotation.y, 0}
+    });
+}
+
 class TimeData
 {
 public:
@@ -176,9 +198,17 @@ auto App::run() -> int
     static constexpr auto defaultWidth = uint32_t {1920};
     static constexpr auto defaultHeight = uint32_t {1080};
     _window = std::make_unique<GlfwWindow>(glm::uvec2 {defaultWidth, defaultHeight}, config::appName.data());
-    _api = std::make_unique<panda::gfx::vulkan::Context>(*_window, 10);
+    _api = std::make_unique<panda::gfx::vulkan::Context>(
+        *_window,
+        panda::gfx::vulkan::ContextConfig {.instancedObjectsCount = 10,
+                                           .useSingleRendering = true,
+                                           .useClusteredLighting = true,
+                                           .useOnDemandRendering = true,
+                                           .useLateLatching = true});
+    _scene.setMaxPunctualLights(_api->getMaxPunctualLights());
 
     setDefaultScene();
+    connectRedrawRequests();
     mainLoop();
     return 0;
 }
@@ -195,6 +225,10 @@ auto App::mainLoop() -> void
 
     [[maybe_unused]] const auto gui = GuiManager {*_window};
 
+    _api->setCameraLatch([this, &currentTime, &cameraObject](panda::gfx::Camera& camera) {
+        latchCamera(currentTime.getDelta(), *_window, cameraObject, camera);
+    });
+
     while (!_window->shouldClose()) [[likely]]
     {
         if (!_window->isMinimized())
@@ -211,13 +245,45 @@ auto App::mainLoop() -> void
                                                      .far = 100});
             processCamera(currentTime.getDelta(), *_window, cameraObject, _scene.getCamera());
 
-            _api->makeFrame(currentTime.getDelta(), _scene);
+            if (_api->isRedrawRequired(_scene))
+            {
+                _api->makeFrame(currentTime.getDelta(), _scene);
+            }
+            else
+            {
+                _window->waitForInput(idleWaitTimeout);
+                currentTime.update();
+            }
         }
         else [[unlikely]]
         {
             _window->waitForInput();
         }
     }
+
+    _api->setCameraLatch({});
+}
+
+auto App::connectRedrawRequests() -> void
+{
+    _keyboardStateChangedReceiver = utils::signals::keyboardStateChanged.connect([this](auto data) {
+        if (data.id == _window->getId())
+        {
+            _api->requestRedraw();
+        }
+    });
+    _mouseButtonStateChangedReceiver = utils::signals::mouseButtonStateChanged.connect([this](auto data) {
+        if (data.id == _window->getId())
+        {
+            _api->requestRedraw();
+        }
+    });
+    _cursorPositionChangedReceiver = utils::signals::cursorPositionChanged.connect([this](auto data) {
+        if (data.id == _window->getId())
+        {
+            _api->requestRedraw();
+        }
+    });
 }
 
 auto App::initializeLogger() -> void
@@ -257,6 +323,8 @@ void App::setDefaultScene()
     road.transform.translation = {};
     road.transform.rotation = {glm::pi<float>(), -glm::quarter_pi<float>(), 0};
     road.transform.scale = {1.F, 1.F, 1.F};
+    road.isOccluder = true;
+    road.isStatic = true;
 
     auto& f1Car = _scene.addObject("F1", {f1Mesh});
     f1Car.transform.rotation = {0, glm::quarter_pi<float>() + glm::half_pi<float>(), 0};
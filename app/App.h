@@ -3,6 +3,7 @@
 #include <panda/gfx/vulkan/Context.h>
 #include <panda/gfx/vulkan/Scene.h>
 
+#include <chrono>
 #include <memory>
 
 #include "GlfwWindow.h"
@@ -22,10 +23,16 @@ private:
     static auto registerSignalHandlers() -> void;
     auto mainLoop() -> void;
     auto setDefaultScene() -> void;
+    auto connectRedrawRequests() -> void;
+
+    static constexpr auto idleWaitTimeout = std::chrono::milliseconds {250};
 
     panda::gfx::vulkan::Scene _scene {};
 
     utils::signals::NewMeshAdded::ReceiverT _newMeshAddedReceiver;
+    utils::signals::KeyboardStateChanged::ReceiverT _keyboardStateChangedReceiver;
+    utils::signals::MouseButtonStateChanged::ReceiverT _mouseButtonStateChangedReceiver;
+    utils::signals::CursorPositionChanged::ReceiverT _cursorPositionChangedReceiver;
     std::unique_ptr<GlfwWindow> _window;
     std::unique_ptr<panda::gfx::vulkan::Context> _api;
 };
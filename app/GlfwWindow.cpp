@@ -11,8 +11,10 @@
 #include <vulkan/vulkan_core.h>
 
 #include <bit>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <glm/ext/vector_double2.hpp>
 #include <glm/ext/vector_uint2.hpp>
 #include <memory>
 #include <span>
@@ -149,6 +151,11 @@ auto GlfwWindow::waitForInput() -> void
     glfwWaitEvents();
 }
 
+auto GlfwWindow::waitForInput(std::chrono::duration<double> timeout) -> void
+{
+    glfwWaitEventsTimeout(timeout.count());
+}
+
 auto GlfwWindow::setKeyCallback(GLFWkeyfun callback) const noexcept -> GLFWkeyfun
 {
     return glfwSetKeyCallback(_window, callback);
@@ -164,6 +171,13 @@ auto GlfwWindow::setCursorPositionCallback(GLFWcursorposfun callback) const noex
     return glfwSetCursorPosCallback(_window, callback);
 }
 
+auto GlfwWindow::getCursorPosition() const -> glm::dvec2
+{
+    auto position = glm::dvec2 {};
+    glfwGetCursorPos(_window, &position.x, &position.y);
+    return position;
+}
+
 auto GlfwWindow::getId() const -> size_t
 {
     return makeId(_window);
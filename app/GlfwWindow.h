@@ -5,6 +5,8 @@
 #include <panda/utils/Signals.h>
 #include <vulkan/vulkan_core.h>
 
+#include <chrono>
+#include <glm/ext/vector_double2.hpp>
 #include <glm/ext/vector_uint2.hpp>
 #include <memory>
 #include <vector>
@@ -35,10 +37,12 @@ public:
     [[nodiscard]] auto getId() const -> Id override;
     auto processInput() -> void override;
     auto waitForInput() -> void override;
+    auto waitForInput(std::chrono::duration<double> timeout) -> void override;
 
     auto setKeyCallback(GLFWkeyfun callback) const noexcept -> GLFWkeyfun;
     auto setMouseButtonCallback(GLFWmousebuttonfun callback) const noexcept -> GLFWmousebuttonfun;
     auto setCursorPositionCallback(GLFWcursorposfun callback) const noexcept -> GLFWcursorposfun;
+    [[nodiscard]] auto getCursorPosition() const -> glm::dvec2;
 
     [[nodiscard]] auto getKeyboardHandler() const noexcept -> const KeyboardHandler&;
     [[nodiscard]] auto getMouseHandler() const noexcept -> const MouseHandler&;
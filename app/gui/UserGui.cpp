@@ -196,7 +196,7 @@ auto UserGui::addLight(panda::gfx::vulkan::Scene& scene) -> void
             }
             else
             {
-                panda::log::Warning("Can't add more point lights. Max number is {}", panda::gfx::maxLights);
+                panda::log::Warning("Can't add more point lights. Max number is {}", scene.getMaxPunctualLights());
             }
             break;
         case 2:
@@ -210,7 +210,7 @@ auto UserGui::addLight(panda::gfx::vulkan::Scene& scene) -> void
             }
             else
             {
-                panda::log::Warning("Can't add more spot lights. Max number is {}", panda::gfx::maxLights);
+                panda::log::Warning("Can't add more spot lights. Max number is {}", scene.getMaxPunctualLights());
             }
             break;
         default:
@@ -125,4 +125,14 @@ auto MouseHandler::getCursorDeltaPosition() const -> glm::vec2
 {
     return glm::vec2 {_currentPosition - _previousPosition};
 }
+
+auto MouseHandler::getPendingCursorDelta() const -> glm::vec2
+{
+    // Motion which happened since the last processed event, the events themselves are delivered on the next poll
+    if (ImGui::GetIO().WantCaptureMouse)
+    {
+        return {};
+    }
+    return glm::vec2 {_window.getCursorPosition() - _currentPosition};
+}
 }
@@ -31,6 +31,7 @@ public:
     [[nodiscard]] auto getButtonState(int button) const -> ButtonState;
     [[nodiscard]] auto getCursorPosition() const -> glm::vec2;
     [[nodiscard]] auto getCursorDeltaPosition() const -> glm::vec2;
+    [[nodiscard]] auto getPendingCursorDelta() const -> glm::vec2;
 
 private:
     std::array<ButtonState, GLFW_MOUSE_BUTTON_LAST> _states {};
@@ -16,10 +16,14 @@ RotationHandler::RotationHandler(const GlfwWindow& window)
 
 auto RotationHandler::getRotation() const -> glm::vec2
 {
-    const auto delta = _window.getMouseHandler().getCursorDeltaPosition();
+    return getRotation(_window.getMouseHandler().getCursorDeltaPosition());
+}
+
+auto RotationHandler::getRotation(glm::vec2 cursorDelta) const -> glm::vec2
+{
     const auto ratio = getPixelsToAngleRatio();
 
-    return {delta.y * ratio.y, delta.x * ratio.x};
+    return {cursorDelta.y * ratio.y, cursorDelta.x * ratio.x};
 }
 
 auto RotationHandler::getPixelsToAngleRatio() const -> glm::vec2
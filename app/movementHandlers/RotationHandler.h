@@ -12,6 +12,7 @@ class RotationHandler
 public:
     explicit RotationHandler(const GlfwWindow& window);
     [[nodiscard]] auto getRotation() const -> glm::vec2;
+    [[nodiscard]] auto getRotation(glm::vec2 cursorDelta) const -> glm::vec2;
 
 private:
     [[nodiscard]] auto getPixelsToAngleRatio() const -> glm::vec2;
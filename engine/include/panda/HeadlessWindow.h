@@ -0,0 +1,41 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <vulkan/vulkan_core.h>
+
+#include <chrono>
+#include <glm/ext/vector_uint2.hpp>
+#include <vector>
+
+#include "panda/Window.h"
+
+namespace panda
+{
+
+// Window without a surface, the context renders into offscreen images which can be read back on the CPU
+class HeadlessWindow : public Window
+{
+public:
+    explicit HeadlessWindow(glm::uvec2 size);
+
+    [[nodiscard]] auto shouldClose() const -> bool override;
+    [[nodiscard]] auto isMinimized() const -> bool override;
+    [[nodiscard]] auto getSize() const -> glm::uvec2 override;
+    [[nodiscard]] auto getRequiredExtensions() const -> std::vector<const char*> override;
+    [[nodiscard]] auto createSurface(VkInstance instance) const -> VkSurfaceKHR override;
+    [[nodiscard]] auto getId() const -> Id override;
+    auto processInput() -> void override;
+    auto waitForInput() -> void override;
+    auto waitForInput(std::chrono::duration<double> timeout) -> void override;
+
+    auto close() noexcept -> void;
+
+private:
+    glm::uvec2 _size;
+    bool _shouldClose = false;
+};
+
+}
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <source_location>
 #include <span>
@@ -96,6 +97,7 @@ private:
     auto log(Level level, std::string_view message, const std::source_location& location) -> void;
     auto flush() -> void;
 
+    std::mutex _mutex;
     std::set<Level> _levels = {Level::Debug, Level::Info, Level::Warning, Level::Error};
     std::vector<LogData> _buffer;
     std::unique_ptr<fmt::ostream> _file;
@@ -6,6 +6,7 @@
 
 #include <vulkan/vulkan_core.h>
 
+#include <chrono>
 #include <glm/ext/vector_uint2.hpp>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -28,6 +29,7 @@ public:
     [[nodiscard]] virtual auto getId() const -> Id = 0;
     virtual auto processInput() -> void = 0;
     virtual auto waitForInput() -> void = 0;
+    virtual auto waitForInput(std::chrono::duration<double> timeout) -> void = 0;
 };
 
 }
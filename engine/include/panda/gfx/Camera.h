@@ -66,11 +66,15 @@ public:
     [[nodiscard]] auto getProjection() const noexcept -> const glm::mat4&;
     [[nodiscard]] auto getView() const noexcept -> const glm::mat4&;
     [[nodiscard]] auto getInverseView() const noexcept -> const glm::mat4&;
+    [[nodiscard]] auto getNear() const noexcept -> float;
+    [[nodiscard]] auto getFar() const noexcept -> float;
 
 private:
     glm::mat4 _projectionMatrix {1.F};
     glm::mat4 _viewMatrix {1.F};
     glm::mat4 _inverseViewMatrix {1.F};
+    float _near = 0.F;
+    float _far = 1.F;
 };
 
 }
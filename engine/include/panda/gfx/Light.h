@@ -5,10 +5,13 @@
 #include <string>
 #include <vector>
 
+#include "panda/internal/config.h"
+
 namespace panda::gfx
 {
 
-inline constexpr auto maxLights = size_t {5};
+inline constexpr auto maxLights = config::maxLights;
+inline constexpr auto maxClusteredLights = config::maxClusteredLights;
 
 struct Attenuation
 {
@@ -9,6 +9,7 @@
 #include <algorithm>
 #include <cstddef>
 #include <ranges>
+#include <span>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_handles.hpp>
@@ -140,6 +141,21 @@ public:
         return previousOffset;
     }
 
+    template <typename T>
+    requires(std::is_standard_layout_v<T>)
+    auto readAt(std::span<T> data, vk::DeviceSize offset) const -> void
+    {
+        expect(data.size_bytes() + offset <= size,
+               fmt::format("Data with size: {} can't be read from buffer with size: {} and offset: {}",
+                           data.size_bytes(),
+                           size,
+                           offset));
+
+        std::copy_n(reinterpret_cast<const T*>(reinterpret_cast<const char*>(_mappedMemory) + offset),
+                    data.size(),
+                    data.begin());
+    }
+
     auto flushWhole() const noexcept -> bool;
     auto flush(vk::DeviceSize dataSize, vk::DeviceSize offset = 0) const noexcept -> bool;
 
@@ -149,6 +165,7 @@ public:
 
     [[nodiscard]] auto getAlignment(vk::DeviceSize instanceSize) const noexcept -> vk::DeviceSize;
     [[nodiscard]] auto getCurrentOffset() const noexcept -> vk::DeviceSize;
+    [[nodiscard]] auto getMappedMemory() const noexcept -> void*;
     [[nodiscard]] auto getDescriptorInfo() const noexcept -> vk::DescriptorBufferInfo;
     [[nodiscard]] auto getDescriptorInfoAt(vk::DeviceSize dataSize, vk::DeviceSize offset) const noexcept
         -> vk::DescriptorBufferInfo;
@@ -6,6 +6,8 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <span>
@@ -15,35 +17,99 @@
 
 #include "panda/Common.h"
 #include "panda/Window.h"
+#include "panda/gfx/Camera.h"
 #include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
 #include "panda/gfx/vulkan/Descriptor.h"
 #include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/DynamicResolution.h"
+#include "panda/gfx/vulkan/FrameCapture.h"
+#include "panda/gfx/vulkan/RedrawTracker.h"
+#include "panda/gfx/vulkan/RenderGraph.h"
 #include "panda/gfx/vulkan/Renderer.h"
 #include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/SecondaryCommandRecorder.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
+#include "panda/gfx/vulkan/TextureStreamer.h"
+#include "panda/gfx/vulkan/UniformRingAllocator.h"
 #include "panda/gfx/vulkan/object/Mesh.h"
 #include "panda/gfx/vulkan/object/Texture.h"
+#include "panda/gfx/vulkan/systems/DeferredLightingSystem.h"
+#include "panda/gfx/vulkan/systems/LightCullingSystem.h"
 #include "panda/gfx/vulkan/systems/LightSystem.h"
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
 #include "panda/gfx/vulkan/systems/RenderSystem.h"
+#include "panda/gfx/vulkan/systems/SoftwareOcclusionSystem.h"
+#include "panda/gfx/vulkan/systems/StaticBatchSystem.h"
+#include "panda/gfx/vulkan/systems/UpscaleSystem.h"
 #include "panda/internal/config.h"
+#include "panda/utils/FrameLimiter.h"
+#include "panda/utils/JobSystem.h"
+#include "panda/utils/Signals.h"
 #include "systems/InstancedRenderSystem.h"
 
 namespace panda::gfx::vulkan
 {
 
+struct FrameInfo;
+
+struct ContextConfig
+{
+    std::optional<size_t> instancedObjectsCount = std::nullopt;
+    bool useSingleRendering = true;
+    bool useClusteredLighting = false;
+    ShadingMode shadingMode = ShadingMode::Forward;
+    bool useDepthPrepass = false;
+    bool useOcclusionCulling = false;
+    bool useSoftwareOcclusion = false;
+    bool useParallelRecording = false;
+    bool useStaticCommandBuffers = false;
+    bool useStaticBatching = false;
+    bool useAutoInstancing = false;
+    std::optional<DynamicResolutionConfig> dynamicResolution = std::nullopt;
+    bool useOnDemandRendering = false;
+    std::optional<float> maxFrameRate = std::nullopt;
+    size_t framesInFlight = 2;
+    vk::PresentModeKHR presentMode = vk::PresentModeKHR::eMailbox;
+    std::optional<uint32_t> swapChainImageCount = std::nullopt;
+    bool useLateLatching = false;
+    std::optional<FrameCaptureConfig> frameCapture = std::nullopt;
+};
+
 class Context
 {
 public:
-    explicit Context(const Window& window,
-                     const std::optional<size_t>& instancedObjectsCount = std::nullopt,
-                     bool useSingleRendering = true);
+    using CameraLatch = std::function<void(Camera&)>;
+
+    explicit Context(const Window& window, const ContextConfig& config = {});
     PD_DELETE_ALL(Context);
     ~Context() noexcept;
 
-    static constexpr auto maxFramesInFlight = size_t {2};
+    static constexpr auto uniformFrameSize = vk::DeviceSize {1024 * 1024};
+    static constexpr auto lateLatchFrustumMargin = 0.1F;
 
     auto makeFrame(float deltaTime, Scene& scene) const -> void;
+    [[nodiscard]] auto isRedrawRequired(const Scene& scene) const -> bool;
+    auto requestRedraw() const -> void;
+    auto setCameraLatch(CameraLatch latch) -> void;
     [[nodiscard]] auto getDevice() const noexcept -> const Device&;
     [[nodiscard]] auto getRenderer() const noexcept -> const Renderer&;
+    [[nodiscard]] auto getFramesInFlight() const noexcept -> size_t;
+    [[nodiscard]] auto getMaxPunctualLights() const noexcept -> size_t;
+    [[nodiscard]] auto readFrame() const -> std::optional<FrameReadback>;
+    [[nodiscard]] auto getTextureStreamer() const noexcept -> const TextureStreamer&;
+    [[nodiscard]] auto getTextureStreamer() noexcept -> TextureStreamer&;
+    [[nodiscard]] auto isDepthPrepassEnabled() const noexcept -> bool;
+    [[nodiscard]] auto isSoftwareOcclusionEnabled() const noexcept -> bool;
+    [[nodiscard]] auto isStaticBatchingEnabled() const noexcept -> bool;
+    [[nodiscard]] auto getSoftwareOcclusionStatistics() const noexcept
+        -> std::optional<SoftwareOcclusionSystem::Statistics>;
+    [[nodiscard]] auto getInstancingStatistics() const noexcept -> std::optional<InstancedRenderSystem::Statistics>;
+    [[nodiscard]] auto getUniformHighWaterMark() const noexcept -> vk::DeviceSize;
+    [[nodiscard]] auto getRenderGraphStatistics() const noexcept -> const RenderGraph::Statistics&;
+    [[nodiscard]] auto getDynamicResolutionStatistics() const noexcept -> std::optional<DynamicResolution::Statistics>;
+    [[nodiscard]] auto getFrameCaptureStatistics() const noexcept -> std::optional<FrameCapture::Statistics>;
+    [[nodiscard]] auto getJobSystem() noexcept -> utils::JobSystem&;
     auto registerTexture(std::unique_ptr<Texture> texture) -> void;
     auto registerMesh(std::unique_ptr<Mesh> mesh) -> void;
 
@@ -65,12 +131,24 @@ private:
     [[nodiscard]] static auto areRequiredExtensionsAvailable(std::span<const char* const> requiredExtensions) -> bool;
 
     [[nodiscard]] auto areValidationLayersSupported() const -> bool;
+    [[nodiscard]] auto getRequiredDeviceExtensions() const noexcept -> std::span<const char* const>;
 
     auto enableValidationLayers(vk::InstanceCreateInfo& createInfo) -> bool;
     auto initializeImGui() -> void;
+    auto updateSystems(const FrameInfo& frameInfo, const Scene& scene) const -> void;
+    auto renderScene(const FrameInfo& frameInfo, Scene& scene) const -> void;
+    auto renderGeometry(const FrameInfo& frameInfo) const -> void;
+    auto renderOverlay(const FrameInfo& frameInfo, Scene& scene) const -> void;
+    static auto renderGui(const FrameInfo& frameInfo, Scene& scene) -> void;
+    auto latchCamera(uint32_t frameIndex,
+                     Scene& scene,
+                     const UniformRingAllocator::Allocation& vertUbo,
+                     const UniformRingAllocator::Allocation& fragUbo) const -> void;
+    auto renderInSecondaryCommandBuffers(const FrameInfo& frameInfo, Scene& scene) const -> void;
 
     static constexpr auto requiredDeviceExtensions =
         std::array {vk::KHRSwapchainExtensionName, vk::KHRPushDescriptorExtensionName};
+    static constexpr auto headlessDeviceExtensions = std::array {vk::KHRPushDescriptorExtensionName};
     inline static const vk::DebugUtilsMessengerCreateInfoEXT debugMessengerCreateInfo =
         createDebugMessengerCreateInfo();
 
@@ -78,17 +156,36 @@ private:
     std::vector<const char*> _requiredValidationLayers;
     std::unique_ptr<vk::Instance, InstanceDeleter> _instance;
     std::unique_ptr<Device> _device;
+    std::unique_ptr<DeletionQueue> _deletionQueue;
+    std::unique_ptr<utils::JobSystem> _jobSystem;
+    std::unique_ptr<TextureStreamer> _textureStreamer;
     std::unique_ptr<Renderer> _renderer;
+    std::unique_ptr<SecondaryCommandRecorder> _commandRecorder;
+    std::unique_ptr<LightCullingSystem> _lightCullingSystem;
+    std::unique_ptr<OcclusionCullingSystem> _occlusionCullingSystem;
+    std::unique_ptr<SoftwareOcclusionSystem> _softwareOcclusionSystem;
+    std::unique_ptr<StaticBatchSystem> _staticBatchSystem;
     std::unique_ptr<RenderSystem> _renderSystem;
     std::unique_ptr<InstancedRenderSystem> _instancedRenderSystem;
+    std::unique_ptr<DeferredLightingSystem> _deferredLightingSystem;
     std::unique_ptr<LightSystem> _pointLightSystem;
+    std::unique_ptr<DynamicResolution> _dynamicResolution;
+    std::unique_ptr<UpscaleSystem> _upscaleSystem;
+    std::unique_ptr<FrameCapture> _frameCapture;
+    std::unique_ptr<RedrawTracker> _redrawTracker;
+    std::unique_ptr<utils::FrameLimiter> _frameLimiter;
+    utils::signals::FrameBufferResized::ReceiverT _frameBufferResizedReceiver;
     vk::DebugUtilsMessengerEXT _debugMessenger;
     std::vector<std::unique_ptr<Texture>> _textures;
     std::vector<std::unique_ptr<Mesh>> _meshes;
-    std::vector<std::unique_ptr<Buffer>> _uboFragBuffers;
-    std::vector<std::unique_ptr<Buffer>> _uboVertBuffers;
+    std::unique_ptr<UniformRingAllocator> _uniformAllocator;
+    std::unique_ptr<RenderGraph> _renderGraph;
     std::unique_ptr<DescriptorPool> _guiPool;
+    CameraLatch _cameraLatch;
 
+    size_t _framesInFlight;
+    bool _useDepthPrepass;
+    bool _useLateLatching;
     const Window& _window;
 };
 
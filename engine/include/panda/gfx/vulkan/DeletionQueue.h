@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "panda/Common.h"
+
+namespace panda::gfx::vulkan
+{
+
+class DeletionQueue
+{
+public:
+    explicit DeletionQueue(size_t framesInFlight);
+    PD_DELETE_ALL(DeletionQueue);
+    ~DeletionQueue() noexcept;
+
+    auto push(std::function<void()> deleter) -> void;
+    auto beginFrame(size_t frameIndex) -> void;
+    auto flushAll() -> void;
+
+private:
+    std::vector<std::vector<std::function<void()>>> _deleters;
+    size_t _frameIndex = 0;
+};
+
+}
@@ -106,7 +106,9 @@ public:
     [[nodiscard]] auto writeBuffer(uint32_t binding, const vk::DescriptorBufferInfo& bufferInfo) -> DescriptorWriter&;
     [[nodiscard]] auto writeImage(uint32_t binding, const vk::DescriptorImageInfo& imageInfo) -> DescriptorWriter&;
 
-    auto push(vk::CommandBuffer commandBuffer, vk::PipelineLayout layout) -> void;
+    auto push(vk::CommandBuffer commandBuffer,
+              vk::PipelineLayout layout,
+              vk::PipelineBindPoint bindPoint = vk::PipelineBindPoint::eGraphics) -> void;
 
 private:
     const DescriptorSetLayout& _setLayout;
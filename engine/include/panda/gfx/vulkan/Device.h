@@ -5,6 +5,7 @@
 // clang-format on
 
 #include <cstdint>
+#include <filesystem>
 #include <optional>
 #include <span>
 #include <unordered_set>
@@ -55,11 +56,13 @@ public:
 
     const vk::PhysicalDevice physicalDevice;
     const QueueFamilies queueFamilies;
+    const bool supportsDrawIndirectFirstInstance;
 
     const vk::Device logicalDevice;
     const vk::Queue graphicsQueue;
     const vk::Queue presentationQueue;
     const vk::CommandPool commandPool;
+    const vk::PipelineCache pipelineCache;
 
 private:
     static auto pickPhysicalDevice(const vk::Instance& instance,
@@ -70,12 +73,20 @@ private:
                                  std::span<const char* const> requiredExtensions) -> bool;
     static auto findQueueFamilies(vk::PhysicalDevice device, vk::SurfaceKHR surface) -> std::optional<QueueFamilies>;
     static auto querySwapChainSupport(vk::PhysicalDevice device, vk::SurfaceKHR surface) -> SwapChainSupportDetails;
+    static auto areTimelineSemaphoresSupported(vk::PhysicalDevice device) -> bool;
+    static auto isDrawIndirectFirstInstanceSupported(vk::PhysicalDevice device) -> bool;
     static auto checkDeviceExtensionSupport(vk::PhysicalDevice device, std::span<const char* const> requiredExtensions)
         -> bool;
     static auto createLogicalDevice(vk::PhysicalDevice device,
                                     const QueueFamilies& queueFamilies,
+                                    bool enableDrawIndirectFirstInstance,
                                     std::span<const char* const> requiredExtensions,
                                     std::span<const char* const> requiredValidationLayers = {}) -> vk::Device;
+    static auto createPipelineCache(vk::PhysicalDevice device,
+                                    vk::Device logicalDevice,
+                                    const std::filesystem::path& path) -> vk::PipelineCache;
+    static auto isPipelineCacheCompatible(vk::PhysicalDevice device, std::span<const uint8_t> data) -> bool;
+    auto savePipelineCache(const std::filesystem::path& path) const -> void;
 
     const vk::SurfaceKHR& _surface;
 };
@@ -0,0 +1,69 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "panda/Common.h"
+
+namespace panda::gfx::vulkan
+{
+
+class Device;
+
+struct DynamicResolutionConfig
+{
+    float minScale = 0.5F;
+    float maxScale = 1.F;
+    float targetFrameTime = 1000.F / 60.F;
+    float sharpness = 0.2F;
+};
+
+class DynamicResolution
+{
+public:
+    struct Statistics
+    {
+        float scale;
+        float gpuFrameTime;
+    };
+
+    static constexpr auto scaleStep = 0.05F;
+    static constexpr auto frameTimeSmoothing = 0.1F;
+
+    DynamicResolution(const Device& device, size_t framesInFlight, const DynamicResolutionConfig& config);
+    PD_DELETE_ALL(DynamicResolution);
+    ~DynamicResolution() noexcept;
+
+    auto beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex) -> void;
+    // Timestamps bracket only the scene work, so acquire and present waits don't count into the frame time
+    auto beginTiming(vk::CommandBuffer commandBuffer, uint32_t frameIndex) const -> void;
+    auto endTiming(vk::CommandBuffer commandBuffer, uint32_t frameIndex) -> void;
+
+    [[nodiscard]] auto getScale() const noexcept -> float;
+    [[nodiscard]] auto getConfig() const noexcept -> const DynamicResolutionConfig&;
+    [[nodiscard]] auto getStatistics() const noexcept -> Statistics;
+
+private:
+    [[nodiscard]] auto readFrameTime(uint32_t frameIndex) -> bool;
+    auto updateScale() -> void;
+
+    const Device& _device;
+    DynamicResolutionConfig _config;
+    vk::QueryPool _queryPool;
+    float _timestampPeriod;
+    uint64_t _timestampMask;
+    bool _isSupported;
+    std::vector<bool> _hasPendingQueries;
+    float _scale;
+    float _gpuFrameTime = 0.F;
+    float _averageFrameTime = 0.F;
+};
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "panda/Common.h"
+#include "panda/gfx/vulkan/Buffer.h"
+
+namespace panda::gfx::vulkan
+{
+
+class Device;
+class Renderer;
+
+enum class CaptureFormat : uint8_t
+{
+    Png,
+    Raw,
+    Encoder
+};
+
+struct FrameCaptureConfig
+{
+    CaptureFormat format = CaptureFormat::Png;
+    std::filesystem::path outputDirectory = "capture";
+    // Command receiving tightly packed RGBA frames on stdin, {width} and {height} are replaced with the frame size
+    std::string encoderCommand = "ffmpeg -y -f rawvideo -pix_fmt rgba -s {width}x{height} -r 60 -i - capture.mp4";
+    size_t ringSize = 4;
+};
+
+class FrameCapture
+{
+public:
+    struct Statistics
+    {
+        size_t capturedFrames;
+        size_t droppedFrames;
+    };
+
+    FrameCapture(const Device& device, const FrameCaptureConfig& config);
+    PD_DELETE_ALL(FrameCapture);
+    ~FrameCapture() noexcept;
+
+    [[nodiscard]] static auto isFormatSupported(vk::Format format) noexcept -> bool;
+
+    auto capture(vk::CommandBuffer commandBuffer, const Renderer& renderer) -> void;
+    [[nodiscard]] auto getStatistics() const noexcept -> Statistics;
+
+private:
+    struct Slot
+    {
+        std::unique_ptr<Buffer> buffer;
+        vk::Extent2D extent;
+        vk::Format format;
+        vk::Semaphore timeline;
+        uint64_t timelineValue;
+        size_t frameNumber;
+    };
+
+    struct Frame
+    {
+        std::vector<uint8_t> pixels;
+        vk::Extent2D extent;
+        size_t frameNumber;
+    };
+
+    using EncoderPipe = std::unique_ptr<FILE, int (*)(FILE*)>;
+
+    [[nodiscard]] static auto chooseMemoryProperties(const Device& device) -> vk::MemoryPropertyFlags;
+    static auto writePng(const std::filesystem::path& path, const Frame& frame) -> bool;
+    static auto writeRaw(const std::filesystem::path& path, const Frame& frame) -> bool;
+
+    [[nodiscard]] auto acquireSlot() -> std::optional<size_t>;
+    auto reserveBuffer(Slot& slot, vk::DeviceSize size) const -> void;
+    auto work(const std::stop_token& stopToken) -> void;
+    [[nodiscard]] auto waitForSlot(const Slot& slot, const std::stop_token& stopToken) const -> bool;
+    [[nodiscard]] auto readSlot(size_t slotIndex) -> Frame;
+    auto writeFrame(const Frame& frame) -> void;
+    auto writeToEncoder(const Frame& frame) -> bool;
+
+    static constexpr auto waitTimeout = uint64_t {100'000'000};
+
+    const Device& _device;
+    FrameCaptureConfig _config;
+    vk::MemoryPropertyFlags _memoryProperties;
+    std::vector<Slot> _slots;
+    std::vector<bool> _busySlots;
+    std::queue<size_t> _pendingSlots;
+    std::mutex _mutex;
+    std::condition_variable_any _condition;
+    EncoderPipe _encoder;
+    vk::Extent2D _encoderExtent;
+    size_t _nextSlot = 0;
+    size_t _frameNumber = 0;
+    std::atomic<size_t> _capturedFrames = 0;
+    std::atomic<size_t> _droppedFrames = 0;
+    std::jthread _worker;
+};
+
+}
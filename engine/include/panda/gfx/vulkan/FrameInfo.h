@@ -11,10 +11,11 @@
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
-#include "Buffer.h"
+#include "panda/gfx/Light.h"
 #include "panda/gfx/vulkan/Alignment.h"
 #include "panda/gfx/vulkan/Scene.h"
 #include "panda/gfx/vulkan/UboLight.h"
+#include "panda/gfx/vulkan/UniformRingAllocator.h"
 
 namespace panda::gfx::vulkan
 {
@@ -22,8 +23,9 @@ namespace panda::gfx::vulkan
 struct FrameInfo
 {
     const Scene& scene;
-    const Buffer& fragUbo;
-    const Buffer& vertUbo;
+    UniformRingAllocator& uniformAllocator;
+    vk::DescriptorBufferInfo fragUbo;
+    vk::DescriptorBufferInfo vertUbo;
     vk::CommandBuffer commandBuffer;
 
     uint32_t frameIndex;
@@ -39,7 +41,7 @@ struct VertUbo
 struct FragUbo
 {
     template <typename T>
-    using LightArray = std::array<T, 5>;
+    using LightArray = std::array<T, maxLights>;
     glm::mat4 inverseView {1.F};
 
     LightArray<UboPointLight> pointLights;
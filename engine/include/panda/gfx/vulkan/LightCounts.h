@@ -0,0 +1,56 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+
+#include "panda/gfx/Light.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/utils/Utils.h"
+
+namespace panda::gfx::vulkan
+{
+
+struct LightCounts
+{
+    static constexpr auto dynamicCount = std::numeric_limits<uint32_t>::max();
+
+    uint32_t directionalLights = dynamicCount;
+    uint32_t pointLights = dynamicCount;
+    uint32_t spotLights = dynamicCount;
+
+    [[nodiscard]] static auto fromLights(const Lights& lights) noexcept -> LightCounts
+    {
+        return {.directionalLights = static_cast<uint32_t>(std::min(lights.directionalLights.size(), maxLights)),
+                .pointLights = static_cast<uint32_t>(std::min(lights.pointLights.size(), maxLights)),
+                .spotLights = static_cast<uint32_t>(std::min(lights.spotLights.size(), maxLights))};
+    }
+
+    [[nodiscard]] auto getSpecializationConstants() const -> SpecializationConstants
+    {
+        auto result = SpecializationConstants {};
+        result.add(0, directionalLights).add(1, pointLights).add(2, spotLights);
+        return result;
+    }
+
+    constexpr auto operator==(const LightCounts&) const noexcept -> bool = default;
+};
+
+}
+
+template <>
+struct std::hash<panda::gfx::vulkan::LightCounts>
+{
+    auto operator()(const panda::gfx::vulkan::LightCounts& lightCounts) const noexcept -> size_t
+    {
+        auto seed = size_t {};
+        panda::utils::hashCombine(seed, lightCounts.directionalLights, lightCounts.pointLights, lightCounts.spotLights);
+        return seed;
+    }
+};
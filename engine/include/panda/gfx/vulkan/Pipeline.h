@@ -5,6 +5,7 @@
 // clang-format on
 
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -17,6 +18,27 @@
 namespace panda::gfx::vulkan
 {
 
+class SpecializationConstants
+{
+public:
+    template <typename T>
+    auto add(uint32_t constantId, const T& value) -> SpecializationConstants&
+    {
+        const auto offset = static_cast<uint32_t>(_data.size());
+        _data.resize(_data.size() + sizeof(T));
+        std::memcpy(_data.data() + offset, &value, sizeof(T));
+        _entries.emplace_back(constantId, offset, sizeof(T));
+        return *this;
+    }
+
+    [[nodiscard]] auto isEmpty() const noexcept -> bool;
+    [[nodiscard]] auto getInfo() const noexcept -> vk::SpecializationInfo;
+
+private:
+    std::vector<vk::SpecializationMapEntry> _entries;
+    std::vector<uint8_t> _data;
+};
+
 struct PipelineConfig
 {
     std::filesystem::path vertexShaderPath;
@@ -33,6 +55,8 @@ struct PipelineConfig
     vk::PipelineLayout pipelineLayout;
     vk::RenderPass renderPass;
     uint32_t subpass = 0;
+    SpecializationConstants vertexSpecialization;
+    SpecializationConstants fragmentSpecialization;
 };
 
 class Pipeline
@@ -51,4 +75,28 @@ private:
     const Device& _device;
 };
 
+struct ComputePipelineConfig
+{
+    std::filesystem::path shaderPath;
+    vk::PipelineLayout pipelineLayout;
+    SpecializationConstants specialization;
+};
+
+class ComputePipeline
+{
+public:
+    ComputePipeline(const Device& device, const ComputePipelineConfig& config);
+    PD_DELETE_ALL(ComputePipeline);
+    ~ComputePipeline() noexcept;
+
+    [[nodiscard]] auto getHandle() const noexcept -> const vk::Pipeline&;
+
+private:
+    [[nodiscard]] static auto createPipeline(const Device& device, const ComputePipelineConfig& config)
+        -> vk::Pipeline;
+
+    vk::Pipeline _pipeline;
+    const Device& _device;
+};
+
 }
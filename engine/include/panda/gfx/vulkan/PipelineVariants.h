@@ -0,0 +1,48 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+
+#include "panda/Common.h"
+#include "panda/gfx/vulkan/LightCounts.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/utils/JobSystem.h"
+
+namespace panda::gfx::vulkan
+{
+
+// Specialized variants are compiled on the job system, the generic one with dynamic light counts is drawn meanwhile
+class PipelineVariants
+{
+public:
+    using Factory = std::function<std::unique_ptr<Pipeline>(const LightCounts&)>;
+
+    PipelineVariants(utils::JobSystem& jobSystem, Factory factory);
+    PD_DELETE_ALL(PipelineVariants);
+    ~PipelineVariants() noexcept;
+
+    [[nodiscard]] auto get(const LightCounts& lightCounts) -> const Pipeline&;
+    auto waitForPending() noexcept -> void;
+
+private:
+    struct PendingVariant
+    {
+        std::unique_ptr<Pipeline> pipeline;
+        std::future<void> compilation;
+    };
+
+    auto compile(const LightCounts& lightCounts) -> PendingVariant&;
+
+    utils::JobSystem& _jobSystem;
+    Factory _factory;
+    std::unordered_map<LightCounts, std::unique_ptr<Pipeline>> _pipelines;
+    std::unordered_map<LightCounts, PendingVariant> _pendingVariants;
+};
+
+}
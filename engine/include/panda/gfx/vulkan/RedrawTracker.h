@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "panda/Common.h"
+
+namespace panda::gfx::vulkan
+{
+
+class Scene;
+
+class RedrawTracker
+{
+public:
+    explicit RedrawTracker(size_t framesInFlight);
+    PD_DELETE_ALL(RedrawTracker);
+    ~RedrawTracker() noexcept = default;
+
+    auto requestRedraw() noexcept -> void;
+    auto frameRendered(const Scene& scene) -> void;
+    [[nodiscard]] auto isRedrawRequired(const Scene& scene) const -> bool;
+
+private:
+    [[nodiscard]] static auto getSignature(const Scene& scene) -> size_t;
+
+    std::optional<size_t> _signature;
+    uint32_t _settleFrameCount;
+    uint32_t _pendingFrameCount;
+};
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Common.h"
+
+namespace panda::gfx::vulkan
+{
+
+class RenderGraph
+{
+public:
+    using ResourceId = uint32_t;
+
+    struct Usage
+    {
+        vk::PipelineStageFlags stages;
+        vk::AccessFlags access;
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+    };
+
+    struct Statistics
+    {
+        size_t passCount;
+        size_t culledPassCount;
+        size_t barrierCount;
+    };
+
+    class Pass
+    {
+    public:
+        explicit Pass(std::string name);
+
+        auto read(ResourceId resource, const Usage& usage) -> Pass&;
+        auto write(ResourceId resource, const Usage& usage) -> Pass&;
+        auto writeAttachment(ResourceId resource, const Usage& usage) -> Pass&;
+        auto setSideEffects() -> Pass&;
+        auto setExecute(std::function<void(vk::CommandBuffer)> execute) -> Pass&;
+
+    private:
+        friend class RenderGraph;
+
+        struct Access
+        {
+            ResourceId resource;
+            Usage usage;
+            bool isWrite;
+            bool isAttachment;
+        };
+
+        auto addAccess(const Access& access) -> Pass&;
+
+        std::string _name;
+        std::vector<Access> _accesses;
+        std::function<void(vk::CommandBuffer)> _execute;
+        bool _hasSideEffects = false;
+    };
+
+    RenderGraph() = default;
+    PD_DELETE_ALL(RenderGraph);
+    ~RenderGraph() noexcept = default;
+
+    auto beginFrame() -> void;
+    [[nodiscard]] auto importImage(std::string name,
+                                   vk::Image image,
+                                   const vk::ImageSubresourceRange& range,
+                                   const Usage& initialUsage) -> ResourceId;
+    [[nodiscard]] auto importBuffer(std::string name, const Usage& initialUsage = {}) -> ResourceId;
+    auto addPass(std::string name) -> Pass&;
+    auto execute(vk::CommandBuffer commandBuffer) -> void;
+
+    [[nodiscard]] auto getStatistics() const noexcept -> const Statistics&;
+
+private:
+    struct Resource
+    {
+        std::string name;
+        vk::Image image;
+        vk::ImageSubresourceRange range;
+        Usage initialUsage;
+        bool isImage;
+    };
+
+    struct ResourceState
+    {
+        vk::PipelineStageFlags writeStages;
+        vk::AccessFlags writeAccess;
+        vk::PipelineStageFlags readStages;
+        vk::AccessFlags readAccess;
+        vk::ImageLayout layout;
+    };
+
+    struct Barrier
+    {
+        vk::PipelineStageFlags srcStages;
+        vk::PipelineStageFlags dstStages;
+        vk::MemoryBarrier memoryBarrier;
+        std::vector<vk::ImageMemoryBarrier> imageBarriers;
+    };
+
+    [[nodiscard]] auto cullPasses() const -> std::vector<const Pass*>;
+    [[nodiscard]] auto createInitialStates() const -> std::vector<ResourceState>;
+    [[nodiscard]] auto createBarrier(const Pass& pass, std::vector<ResourceState>& states) const -> Barrier;
+
+    std::vector<Resource> _resources;
+    std::deque<Pass> _passes;
+    Statistics _statistics {};
+};
+
+}
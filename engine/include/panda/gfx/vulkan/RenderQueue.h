@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace panda::gfx::vulkan
+{
+
+class RenderQueue
+{
+public:
+    enum class Pass : uint8_t
+    {
+        DepthPrepass,
+        Opaque
+    };
+
+    struct SortKey
+    {
+        Pass pass;
+        uint32_t pipeline;
+        uint32_t material;
+        uint32_t mesh;
+        float depth;
+    };
+
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t drawIndex;
+    };
+
+    [[nodiscard]] static auto makeKey(const SortKey& sortKey) noexcept -> uint64_t;
+
+    auto clear() noexcept -> void;
+    auto push(const SortKey& sortKey, uint32_t drawIndex) -> void;
+    auto sort() -> void;
+    [[nodiscard]] auto getEntries() const noexcept -> std::span<const Entry>;
+
+private:
+    std::vector<Entry> _entries;
+    std::vector<Entry> _sortBuffer;
+};
+
+}
@@ -4,13 +4,18 @@
 #include "panda/utils/Assert.h"
 // clang-format on
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
 
 #include "panda/Common.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
+#include "panda/gfx/vulkan/SwapChain.h"
 #include "panda/gfx/vulkan/object/Object.h"
 
 namespace panda
@@ -21,30 +26,63 @@ class Window;
 namespace panda::gfx::vulkan
 {
 
+class DeletionQueue;
 class Device;
-class SwapChain;
 
 class Renderer
 {
 public:
-    Renderer(const Window& window, const Device& device, const vk::SurfaceKHR& surface);
+    Renderer(const Window& window,
+             const Device& device,
+             DeletionQueue& deletionQueue,
+             const vk::SurfaceKHR& surface,
+             ShadingMode shadingMode = ShadingMode::Forward,
+             std::optional<float> maxRenderScale = std::nullopt,
+             const SwapChainConfig& swapChainConfig = {});
     PD_DELETE_ALL(Renderer);
     ~Renderer() noexcept;
 
     [[nodiscard]] auto beginFrame() -> vk::CommandBuffer;
     auto endFrame() -> void;
-    auto beginSwapChainRenderPass() const -> void;
+    auto beginSwapChainRenderPass(vk::SubpassContents contents = vk::SubpassContents::eInline) const -> void;
+    auto nextSubpass(vk::SubpassContents contents = vk::SubpassContents::eInline) const -> void;
     auto endSwapChainRenderPass() const -> void;
+    auto beginPresentRenderPass() const -> void;
+    auto endPresentRenderPass() const -> void;
+    auto setRenderScale(float scale) noexcept -> void;
 
     [[nodiscard]] auto getAspectRatio() const noexcept -> float;
+    [[nodiscard]] auto getExtent() const noexcept -> const vk::Extent2D&;
+    [[nodiscard]] auto getRenderExtent() const noexcept -> vk::Extent2D;
+    [[nodiscard]] auto getRenderTargetExtent() const noexcept -> const vk::Extent2D&;
+    [[nodiscard]] auto isRenderingOffscreen() const noexcept -> bool;
     [[nodiscard]] auto isFrameInProgress() const noexcept -> bool;
     [[nodiscard]] auto getCurrentCommandBuffer() const noexcept -> const vk::CommandBuffer&;
     [[nodiscard]] auto getSwapChainRenderPass() const noexcept -> const vk::RenderPass&;
+    [[nodiscard]] auto getPresentRenderPass() const noexcept -> const vk::RenderPass&;
+    [[nodiscard]] auto getCurrentFramebuffer() const noexcept -> vk::Framebuffer;
+    [[nodiscard]] auto getShadingMode() const noexcept -> ShadingMode;
+    [[nodiscard]] auto getGBuffer() const noexcept -> const GBuffer&;
+    [[nodiscard]] auto getDepthImage() const noexcept -> vk::Image;
+    [[nodiscard]] auto getDepthImageView() const noexcept -> vk::ImageView;
+    [[nodiscard]] auto getSceneColorImage() const noexcept -> vk::Image;
+    [[nodiscard]] auto getSceneColorView() const noexcept -> vk::ImageView;
 
     [[nodiscard]] auto getFrameIndex() const noexcept -> uint32_t;
+    [[nodiscard]] auto getFramesInFlight() const noexcept -> size_t;
+    [[nodiscard]] auto getImageCount() const noexcept -> size_t;
+    [[nodiscard]] auto isHeadless() const noexcept -> bool;
+    [[nodiscard]] auto isCaptureSupported() const -> bool;
+    [[nodiscard]] auto getCurrentImage() const noexcept -> vk::Image;
+    [[nodiscard]] auto getImageFormat() const noexcept -> vk::Format;
+    [[nodiscard]] auto getOutputLayout() const noexcept -> vk::ImageLayout;
+    [[nodiscard]] auto getFrameTimeline() const noexcept -> vk::Semaphore;
+    [[nodiscard]] auto getPendingTimelineValue() const noexcept -> uint64_t;
+    [[nodiscard]] auto readFrame() const -> std::optional<FrameReadback>;
 
 private:
     [[nodiscard]] auto createCommandBuffers() -> std::vector<vk::CommandBuffer>;
+    auto setViewportAndScissor(vk::Extent2D extent) const -> void;
 
     const Device& _device;
     std::unique_ptr<SwapChain> _swapChain;
@@ -53,6 +91,7 @@ private:
 
     uint32_t _currentImageIndex = 0;
     uint32_t _currentFrameIndex = 0;
+    float _renderScale = 1.F;
     bool _isFrameStarted = false;
 };
 
@@ -31,10 +31,15 @@ public:
 
     [[nodiscard]] auto getInstancedSurfaceMap() const noexcept
         -> const std::unordered_map<Surface, std::vector<const Object*>>&;
+    [[nodiscard]] auto getSharedSurfaceMap() const noexcept
+        -> const std::unordered_map<Surface, std::vector<const Object*>>&;
 
     [[nodiscard]] auto getLights() const noexcept -> const Lights&;
     [[nodiscard]] auto getCamera() const noexcept -> const Camera&;
     [[nodiscard]] auto getCamera() noexcept -> Camera&;
+    [[nodiscard]] auto getMaxPunctualLights() const noexcept -> size_t;
+    // Point and spot lights above maxLights are only shaded with clustered lighting
+    auto setMaxPunctualLights(size_t count) noexcept -> void;
 
     auto addObject(std::string name, const std::vector<Surface>& surfaces) -> Object&;
     auto removeObjectByName(std::string_view name) -> bool;
@@ -62,7 +67,7 @@ public:
     {
         if constexpr (std::is_same_v<Light, PointLight>)
         {
-            if (_lights.pointLights.size() >= maxLights)
+            if (_lights.pointLights.size() >= _maxPunctualLights)
             {
                 return {};
             }
@@ -89,7 +94,7 @@ public:
         }
         else if constexpr (std::is_same_v<Light, SpotLight>)
         {
-            if (_lights.spotLights.size() >= maxLights)
+            if (_lights.spotLights.size() >= _maxPunctualLights)
             {
                 return {};
             }
@@ -113,12 +118,15 @@ public:
 private:
     auto getUniqueName(std::string name) -> std::string;
     auto removeName(std::string_view name) -> void;
+    auto removeSurfaceMappings(const Object& object) -> void;
 
     std::unordered_map<Surface, std::vector<const Object*>> _surfaces;
+    std::unordered_map<Surface, std::vector<const Object*>> _sharedSurfaces;
     std::vector<std::unique_ptr<Object>> _objects;
     std::unordered_set<std::string_view> _names;
     Lights _lights;
     Camera _camera;
+    size_t _maxPunctualLights = maxLights;
 };
 
 }
@@ -0,0 +1,61 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Common.h"
+#include "panda/utils/JobSystem.h"
+
+namespace panda::gfx::vulkan
+{
+
+class Device;
+
+class SecondaryCommandRecorder
+{
+public:
+    using RecordJob = std::function<void(vk::CommandBuffer commandBuffer, size_t begin, size_t end)>;
+
+    SecondaryCommandRecorder(const Device& device, utils::JobSystem& jobSystem, size_t framesInFlight);
+    PD_DELETE_ALL(SecondaryCommandRecorder);
+    ~SecondaryCommandRecorder() noexcept;
+
+    auto beginFrame(uint32_t frameIndex, vk::RenderPass renderPass, vk::Framebuffer framebuffer, vk::Extent2D extent)
+        -> void;
+    [[nodiscard]] auto record(size_t count, size_t minBatchSize, const RecordJob& job)
+        -> std::vector<vk::CommandBuffer>;
+    auto beginReusable(vk::CommandBuffer commandBuffer) const -> void;
+    [[nodiscard]] auto getExtent() const noexcept -> vk::Extent2D;
+
+private:
+    struct ThreadCommandPool
+    {
+        vk::CommandPool commandPool;
+        std::vector<vk::CommandBuffer> commandBuffers;
+        size_t usedCount;
+    };
+
+    auto acquire(ThreadCommandPool& threadCommandPool) const -> vk::CommandBuffer;
+    auto begin(vk::CommandBuffer commandBuffer,
+               vk::Framebuffer framebuffer,
+               vk::CommandBufferUsageFlags usage) const -> void;
+
+    const Device& _device;
+    utils::JobSystem& _jobSystem;
+    std::vector<std::vector<ThreadCommandPool>> _commandPools;
+    uint32_t _frameIndex = 0;
+    vk::RenderPass _renderPass;
+    vk::Framebuffer _framebuffer;
+    vk::Extent2D _extent;
+};
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace panda::gfx::vulkan
+{
+
+enum class ShadingMode : uint8_t
+{
+    Forward,
+    Deferred
+};
+
+[[nodiscard]] constexpr auto getLightingSubpass(ShadingMode shadingMode) noexcept -> uint32_t
+{
+    return shadingMode == ShadingMode::Deferred ? 1 : 0;
+}
+
+}
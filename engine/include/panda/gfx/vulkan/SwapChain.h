@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <span>
 #include <vector>
@@ -14,6 +15,8 @@
 #include <vulkan/vulkan_handles.hpp>
 
 #include "panda/Common.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
 #include "panda/utils/Signals.h"
 
 namespace panda
@@ -24,50 +27,175 @@ class Window;
 namespace panda::gfx::vulkan
 {
 
+class DeletionQueue;
 class Device;
 
+struct FrameBufferAttachment
+{
+    vk::Image image;
+    vk::DeviceMemory memory;
+    vk::ImageView view;
+};
+
+struct GBuffer
+{
+    FrameBufferAttachment albedo;
+    FrameBufferAttachment normal;
+};
+
+struct SwapChainConfig
+{
+    size_t framesInFlight = 2;
+    vk::PresentModeKHR presentMode = vk::PresentModeKHR::eMailbox;
+    std::optional<uint32_t> imageCount = std::nullopt;
+    bool allowCapture = false;
+};
+
+struct FrameReadback
+{
+    vk::Extent2D extent;
+    vk::Format format;
+    std::span<const std::byte> pixels;
+};
+
 class SwapChain
 {
 public:
-    SwapChain(const Device& device, const vk::SurfaceKHR& surface, const Window& window);
+    static constexpr auto albedoFormat = vk::Format::eR8G8B8A8Unorm;
+    static constexpr auto normalFormat = vk::Format::eR16G16B16A16Sfloat;
+
+    SwapChain(const Device& device,
+              DeletionQueue& deletionQueue,
+              const vk::SurfaceKHR& surface,
+              const Window& window,
+              ShadingMode shadingMode = ShadingMode::Forward,
+              std::optional<float> maxRenderScale = std::nullopt,
+              const SwapChainConfig& config = {});
     PD_DELETE_ALL(SwapChain);
     ~SwapChain() noexcept;
 
     [[nodiscard]] auto getRenderPass() const noexcept -> const vk::RenderPass&;
     [[nodiscard]] auto getFrameBuffer(size_t index) const noexcept -> const vk::Framebuffer&;
+    [[nodiscard]] auto getPresentRenderPass() const noexcept -> const vk::RenderPass&;
+    [[nodiscard]] auto getPresentFrameBuffer(size_t index) const noexcept -> const vk::Framebuffer&;
+    [[nodiscard]] auto getSceneColor(size_t index) const noexcept -> const FrameBufferAttachment&;
+    [[nodiscard]] auto isRenderingOffscreen() const noexcept -> bool;
+    [[nodiscard]] auto getGBuffer(size_t index) const noexcept -> const GBuffer&;
+    [[nodiscard]] auto getDepthImage(size_t index) const noexcept -> vk::Image;
+    [[nodiscard]] auto getDepthImageView(size_t index) const noexcept -> vk::ImageView;
+    [[nodiscard]] auto getShadingMode() const noexcept -> ShadingMode;
     [[nodiscard]] auto getExtent() const noexcept -> const vk::Extent2D&;
+    [[nodiscard]] auto getRenderTargetExtent() const noexcept -> const vk::Extent2D&;
     [[nodiscard]] auto getExtentAspectRatio() const noexcept -> float;
     [[nodiscard]] auto acquireNextImage() -> std::optional<uint32_t>;
     [[nodiscard]] auto imagesCount() const noexcept -> size_t;
+    [[nodiscard]] auto getFramesInFlight() const noexcept -> size_t;
+    [[nodiscard]] auto isHeadless() const noexcept -> bool;
+    [[nodiscard]] auto isCaptureSupported() const -> bool;
+    [[nodiscard]] auto getImage(size_t index) const noexcept -> vk::Image;
+    [[nodiscard]] auto getImageFormat() const noexcept -> vk::Format;
+    [[nodiscard]] auto getOutputLayout() const noexcept -> vk::ImageLayout;
+    [[nodiscard]] auto getFrameTimeline() const noexcept -> vk::Semaphore;
+    [[nodiscard]] auto getPendingTimelineValue() const noexcept -> uint64_t;
     auto submitCommandBuffers(const vk::CommandBuffer& commandBuffer, uint32_t imageIndex) -> void;
+    auto recordReadback(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const -> void;
+    [[nodiscard]] auto readFrame() const -> std::optional<FrameReadback>;
 
 private:
+    struct RetiredResources
+    {
+        vk::SwapchainKHR swapChain;
+        std::vector<FrameBufferAttachment> headlessImages;
+        std::vector<vk::ImageView> imageViews;
+        std::vector<vk::Image> depthImages;
+        std::vector<vk::DeviceMemory> depthImageMemories;
+        std::vector<vk::ImageView> depthImageViews;
+        std::vector<GBuffer> gBuffers;
+        std::vector<FrameBufferAttachment> sceneColors;
+        std::vector<vk::Framebuffer> frameBuffers;
+        std::vector<vk::Framebuffer> presentFrameBuffers;
+        std::vector<vk::Semaphore> renderFinishedSemaphores;
+    };
+
+    static constexpr auto headlessFormat =
+        vk::SurfaceFormatKHR {vk::Format::eR8G8B8A8Srgb, vk::ColorSpaceKHR::eSrgbNonlinear};
+
     [[nodiscard]] static auto createSwapChain(const vk::SurfaceKHR& surface,
                                               vk::Extent2D extent,
                                               const Device& device,
-                                              const vk::SurfaceFormatKHR& surfaceFormat) -> vk::SwapchainKHR;
+                                              const vk::SurfaceFormatKHR& surfaceFormat,
+                                              const SwapChainConfig& config,
+                                              vk::SwapchainKHR oldSwapChain = {}) -> vk::SwapchainKHR;
     [[nodiscard]] static auto chooseSwapSurfaceFormat(std::span<const vk::SurfaceFormatKHR> availableFormats) noexcept
         -> vk::SurfaceFormatKHR;
-    [[nodiscard]] static auto choosePresentationMode(
-        std::span<const vk::PresentModeKHR> availablePresentationModes) noexcept -> vk::PresentModeKHR;
+    [[nodiscard]] static auto choosePresentationMode(std::span<const vk::PresentModeKHR> availablePresentationModes,
+                                                     vk::PresentModeKHR preferredPresentationMode) noexcept
+        -> vk::PresentModeKHR;
+    [[nodiscard]] static auto chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities,
+                                               std::optional<uint32_t> preferredImageCount) noexcept -> uint32_t;
+    [[nodiscard]] static auto createTimelineSemaphore(const Device& device) -> vk::Semaphore;
+    [[nodiscard]] static auto isTransferSourceSupported(const Device& device) -> bool;
     [[nodiscard]] static auto chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities, const Window& window)
         -> vk::Extent2D;
+    [[nodiscard]] static auto getRenderTargetExtent(vk::Extent2D swapChainExtent, std::optional<float> maxRenderScale)
+        -> vk::Extent2D;
 
+    [[nodiscard]] static auto createHeadlessImages(const Device& device,
+                                                   vk::Extent2D extent,
+                                                   size_t imagesCount,
+                                                   const vk::SurfaceFormatKHR& imageFormat)
+        -> std::vector<FrameBufferAttachment>;
+    [[nodiscard]] static auto getImages(const std::vector<FrameBufferAttachment>& attachments)
+        -> std::vector<vk::Image>;
+    [[nodiscard]] static auto createReadbackBuffers(const Device& device, vk::Extent2D extent, size_t imagesCount)
+        -> std::vector<std::unique_ptr<Buffer>>;
     [[nodiscard]] static auto createImageViews(const std::vector<vk::Image>& swapChainImages,
                                                const vk::SurfaceFormatKHR& swapChainImageFormat,
                                                const Device& device) -> std::vector<vk::ImageView>;
     [[nodiscard]] static auto createRenderPass(const vk::SurfaceFormatKHR& imageFormat,
                                                const vk::SurfaceFormatKHR& depthFormat,
+                                               ShadingMode shadingMode,
+                                               vk::ImageLayout colorFinalLayout,
                                                const Device& device) -> vk::RenderPass;
+    [[nodiscard]] static auto createDeferredRenderPass(const vk::SurfaceFormatKHR& imageFormat,
+                                                       const vk::SurfaceFormatKHR& depthFormat,
+                                                       vk::ImageLayout colorFinalLayout,
+                                                       const Device& device) -> vk::RenderPass;
+    [[nodiscard]] static auto createPresentRenderPass(const vk::SurfaceFormatKHR& imageFormat,
+                                                      vk::ImageLayout colorFinalLayout,
+                                                      const Device& device) -> vk::RenderPass;
     [[nodiscard]] static auto createFrameBuffers(const std::vector<vk::ImageView>& swapChainImageViews,
                                                  const std::vector<vk::ImageView>& depthImageViews,
+                                                 const std::vector<GBuffer>& gBuffers,
                                                  const vk::RenderPass& renderPass,
                                                  vk::Extent2D swapChainExtent,
                                                  const Device& device) -> std::vector<vk::Framebuffer>;
+    [[nodiscard]] static auto createPresentFrameBuffers(const std::vector<vk::ImageView>& swapChainImageViews,
+                                                        const vk::RenderPass& renderPass,
+                                                        vk::Extent2D swapChainExtent,
+                                                        const Device& device) -> std::vector<vk::Framebuffer>;
+    [[nodiscard]] static auto createSceneColors(const Device& device,
+                                                vk::Extent2D renderTargetExtent,
+                                                size_t imagesCount,
+                                                const vk::SurfaceFormatKHR& imageFormat,
+                                                bool isRenderingOffscreen) -> std::vector<FrameBufferAttachment>;
+    [[nodiscard]] static auto getColorViews(const std::vector<vk::ImageView>& swapChainImageViews,
+                                            const std::vector<FrameBufferAttachment>& sceneColors)
+        -> std::vector<vk::ImageView>;
     [[nodiscard]] static auto createDepthImages(const Device& device,
                                                 vk::Extent2D swapChainExtent,
                                                 size_t imagesCount,
-                                                const vk::SurfaceFormatKHR& depthFormat) -> std::vector<vk::Image>;
+                                                const vk::SurfaceFormatKHR& depthFormat,
+                                                ShadingMode shadingMode) -> std::vector<vk::Image>;
+    [[nodiscard]] static auto createGBuffers(const Device& device,
+                                             vk::Extent2D swapChainExtent,
+                                             size_t imagesCount,
+                                             ShadingMode shadingMode) -> std::vector<GBuffer>;
+    [[nodiscard]] static auto createAttachment(const Device& device,
+                                               vk::Extent2D extent,
+                                               vk::Format format,
+                                               vk::ImageUsageFlags usage,
+                                               vk::ImageAspectFlags aspect) -> FrameBufferAttachment;
     [[nodiscard]] static auto createDepthImageViews(const Device& device,
                                                     const std::vector<vk::Image>& depthImages,
                                                     size_t imagesCount,
@@ -77,31 +205,51 @@ private:
                                                        const std::vector<vk::Image>& depthImages,
                                                        size_t imagesCount) -> std::vector<vk::DeviceMemory>;
     [[nodiscard]] static auto findDepthFormat(const Device& device) -> vk::Format;
+    static auto destroyResources(const Device& device, const RetiredResources& resources) -> void;
 
     auto createSyncObjects() -> void;
-    auto cleanup() -> void;
+    auto createRenderFinishedSemaphores() -> void;
+    auto waitForTimeline(uint64_t value) const -> void;
+    auto submitHeadless(const vk::CommandBuffer& commandBuffer, uint32_t imageIndex) -> void;
+    [[nodiscard]] auto retireResources() -> RetiredResources;
+    [[nodiscard]] auto canReuseDepthMemory(size_t memoryCount) const -> bool;
+    auto bindDepthMemory(std::vector<vk::DeviceMemory> depthImageMemories) -> void;
     auto recreate() -> void;
 
     const Device& _device;
+    DeletionQueue& _deletionQueue;
     const Window& _window;
     const vk::SurfaceKHR& _surface;
+    ShadingMode _shadingMode;
+    std::optional<float> _maxRenderScale;
+    SwapChainConfig _config;
 
     vk::Extent2D _swapChainExtent;
+    vk::Extent2D _renderTargetExtent;
     vk::SurfaceFormatKHR _swapChainImageFormat;
     vk::SurfaceFormatKHR _swapChainDepthFormat;
     vk::SwapchainKHR _swapChain;
+    std::vector<FrameBufferAttachment> _headlessImages;
     std::vector<vk::Image> _swapChainImages;
     std::vector<vk::ImageView> _swapChainImageViews;
     std::vector<vk::Image> _depthImages;
     std::vector<vk::DeviceMemory> _depthImageMemories;
+    vk::MemoryRequirements _depthMemoryRequirements;
     std::vector<vk::ImageView> _depthImageViews;
+    std::vector<GBuffer> _gBuffers;
+    std::vector<FrameBufferAttachment> _sceneColors;
+    std::vector<std::unique_ptr<Buffer>> _readbackBuffers;
 
     vk::RenderPass _renderPass;
+    vk::RenderPass _presentRenderPass;
     std::vector<vk::Framebuffer> _swapChainFrameBuffers;
+    std::vector<vk::Framebuffer> _presentFrameBuffers;
     std::vector<vk::Semaphore> _imageAvailableSemaphores;
     std::vector<vk::Semaphore> _renderFinishedSemaphores;
-    std::vector<vk::Fence> _inFlightFences;
-    std::vector<vk::Fence*> _imagesInFlight;
+    vk::Semaphore _frameTimeline;
+    std::vector<uint64_t> _frameTimelineValues;
+    std::vector<uint64_t> _imageTimelineValues;
+    uint64_t _timelineValue = 0;
 
     utils::signals::FrameBufferResized::ReceiverT _frameBufferResizeReceiver;
     uint32_t _currentFrame = 0;
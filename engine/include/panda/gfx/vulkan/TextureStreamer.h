@@ -0,0 +1,62 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <cstdint>
+#include <unordered_map>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Common.h"
+
+namespace panda::gfx::vulkan
+{
+
+class DeletionQueue;
+class Device;
+class Scene;
+class Texture;
+
+class TextureStreamer
+{
+public:
+    TextureStreamer(DeletionQueue& deletionQueue, vk::DeviceSize budget);
+    PD_DELETE_ALL(TextureStreamer);
+    ~TextureStreamer() noexcept = default;
+
+    [[nodiscard]] static auto getDefaultBudget(const Device& device) -> vk::DeviceSize;
+
+    auto addTexture(Texture& texture) -> void;
+    auto update(vk::CommandBuffer commandBuffer, const Scene& scene, vk::Extent2D extent) -> void;
+    auto setBudget(vk::DeviceSize budget) noexcept -> void;
+
+    [[nodiscard]] auto getBudget() const noexcept -> vk::DeviceSize;
+    [[nodiscard]] auto getResidentSize() const noexcept -> vk::DeviceSize;
+    [[nodiscard]] auto hasPendingUploads() const noexcept -> bool;
+
+private:
+    struct Entry
+    {
+        Texture* texture;
+        uint64_t lastUsedFrame;
+        uint32_t desiredMipLevel;
+    };
+
+    auto gatherFeedback(const Scene& scene, vk::Extent2D extent) -> void;
+    auto setBaseMipLevel(vk::CommandBuffer commandBuffer, Entry& entry, uint32_t baseMipLevel) -> void;
+    auto evict(vk::CommandBuffer commandBuffer, vk::DeviceSize requiredSize) -> bool;
+
+    static constexpr auto maxUploadsPerFrame = uint32_t {2};
+
+    std::unordered_map<const Texture*, Entry> _entries;
+    DeletionQueue& _deletionQueue;
+    vk::DeviceSize _budget;
+    vk::DeviceSize _residentSize = 0;
+    uint64_t _currentFrame = 0;
+    bool _hasPendingUploads = false;
+};
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Common.h"
+#include "panda/gfx/vulkan/Buffer.h"
+
+namespace panda::gfx::vulkan
+{
+
+class Device;
+
+class UniformRingAllocator
+{
+public:
+    struct Allocation
+    {
+        vk::DescriptorBufferInfo descriptorInfo;
+        void* data;
+    };
+
+    UniformRingAllocator(const Device& device, vk::DeviceSize frameSize, size_t framesInFlight);
+    PD_DELETE_ALL(UniformRingAllocator);
+    ~UniformRingAllocator() noexcept = default;
+
+    auto beginFrame(uint32_t frameIndex) -> void;
+    [[nodiscard]] auto allocate(vk::DeviceSize dataSize) -> Allocation;
+    [[nodiscard]] auto getHighWaterMark() const noexcept -> vk::DeviceSize;
+
+    template <typename T>
+    requires(std::is_standard_layout_v<T>)
+    [[nodiscard]] auto write(const T& data) -> vk::DescriptorBufferInfo
+    {
+        return allocateAndWrite(data).descriptorInfo;
+    }
+
+    template <typename T>
+    requires(std::is_standard_layout_v<T>)
+    [[nodiscard]] auto allocateAndWrite(const T& data) -> Allocation
+    {
+        const auto allocation = allocate(sizeof(T));
+        std::memcpy(allocation.data, &data, sizeof(T));
+        return allocation;
+    }
+
+private:
+    std::unique_ptr<Buffer> _buffer;
+    vk::DeviceSize _frameSize;
+    vk::DeviceSize _alignment;
+    vk::DeviceSize _frameOffset = 0;
+    std::atomic<vk::DeviceSize> _head = 0;
+    vk::DeviceSize _highWaterMark = 0;
+};
+
+}
@@ -37,6 +37,18 @@ struct Vertex
             vk::VertexInputAttributeDescription {2, 0, vk::Format::eR32G32Sfloat,    offsetof(Vertex, uv)      }
         };
     }
+
+    static constexpr auto getPositionBindingDescription(bool packed) -> vk::VertexInputBindingDescription
+    {
+        return vk::VertexInputBindingDescription {0,
+                                                  packed ? sizeof(glm::vec3) : sizeof(Vertex),
+                                                  vk::VertexInputRate::eVertex};
+    }
+
+    static constexpr auto getPositionAttributeDescription() -> vk::VertexInputAttributeDescription
+    {
+        return vk::VertexInputAttributeDescription {0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, position)};
+    }
 };
 
 }
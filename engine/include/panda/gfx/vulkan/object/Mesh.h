@@ -4,7 +4,10 @@
 #include "panda/utils/Assert.h"
 // clang-format on
 
+#include <cstdint>
 #include <filesystem>
+#include <glm/ext/vector_float3.hpp>
+#include <vector>
 
 #include "panda/gfx/vulkan/Buffer.h"
 #include "panda/gfx/vulkan/Device.h"
@@ -14,31 +17,108 @@ namespace panda::gfx::vulkan
 {
 
 class Context;
+class DeletionQueue;
+
+struct BoundingBox
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center;
+    float radius;
+};
+
+struct OccluderGeometry
+{
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+};
+
+struct MeshGeometry
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+};
 
 class Mesh
 {
 public:
+    using Id = uint32_t;
+
+    // Records the buffer uploads into a frame's command buffer instead of waiting for a single-time submission
+    struct Upload
+    {
+        vk::CommandBuffer commandBuffer;
+        DeletionQueue& deletionQueue;
+    };
+
+    Mesh(std::string name,
+         const Device& device,
+         std::span<const Vertex> vertices,
+         std::span<const uint32_t> indices = {},
+         bool createPositionStream = false,
+         bool keepOccluderGeometry = false,
+         bool keepGeometry = false);
     Mesh(std::string name,
          const Device& device,
+         const Upload& upload,
          std::span<const Vertex> vertices,
-         std::span<const uint32_t> indices = {});
+         std::span<const uint32_t> indices = {},
+         bool createPositionStream = false);
 
     auto bind(const vk::CommandBuffer& commandBuffer) const -> void;
+    auto bindPositions(const vk::CommandBuffer& commandBuffer) const -> void;
     auto draw(const vk::CommandBuffer& commandBuffer) const -> void;
     auto drawInstanced(const vk::CommandBuffer& commandBuffer, uint32_t instanced, uint32_t base) const -> void;
+    auto drawIndirect(const vk::CommandBuffer& commandBuffer, vk::Buffer buffer, vk::DeviceSize offset) const -> void;
 
+    [[nodiscard]] auto getId() const noexcept -> Id;
     [[nodiscard]] auto getName() const noexcept -> const std::string&;
+    [[nodiscard]] auto getBoundingBox() const noexcept -> const BoundingBox&;
+    [[nodiscard]] auto getBoundingSphere() const noexcept -> const BoundingSphere&;
+    [[nodiscard]] auto hasPositionStream() const noexcept -> bool;
+    [[nodiscard]] auto getOccluderGeometry() const noexcept -> const OccluderGeometry&;
+    [[nodiscard]] auto getGeometry() const noexcept -> const MeshGeometry&;
+    [[nodiscard]] auto getIndirectCommand(uint32_t firstInstance) const noexcept -> vk::DrawIndexedIndirectCommand;
 
 private:
-    static auto createVertexBuffer(const Device& device, std::span<const Vertex> vertices) -> std::unique_ptr<Buffer>;
-    static auto createIndexBuffer(const Device& device, std::span<const uint32_t> indices) -> std::unique_ptr<Buffer>;
+    Mesh(std::string name,
+         const Device& device,
+         const Upload* upload,
+         std::span<const Vertex> vertices,
+         std::span<const uint32_t> indices,
+         bool createPositionStream,
+         bool keepOccluderGeometry,
+         bool keepGeometry);
+
+    static auto computeBoundingBox(std::span<const Vertex> vertices) noexcept -> BoundingBox;
+    static auto computeBoundingSphere(std::span<const Vertex> vertices, const BoundingBox& boundingBox) noexcept
+        -> BoundingSphere;
+    static auto createVertexBuffer(const Device& device, const Upload* upload, std::span<const Vertex> vertices)
+        -> std::unique_ptr<Buffer>;
+    static auto createPositionBuffer(const Device& device, const Upload* upload, std::span<const Vertex> vertices)
+        -> std::unique_ptr<Buffer>;
+    static auto createIndexBuffer(const Device& device, const Upload* upload, std::span<const uint32_t> indices)
+        -> std::unique_ptr<Buffer>;
+    static auto createOccluderGeometry(std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+        -> OccluderGeometry;
 
     const Device& _device;
     std::string _name;
     std::unique_ptr<Buffer> _vertexBuffer;
+    std::unique_ptr<Buffer> _positionBuffer;
     std::unique_ptr<Buffer> _indexBuffer;
     uint32_t _vertexCount;
     uint32_t _indexCount;
+    BoundingBox _boundingBox;
+    BoundingSphere _boundingSphere;
+    OccluderGeometry _occluderGeometry;
+    MeshGeometry _geometry;
+    inline static Id currentId = 0;
+    Id _id;
 };
 
 }
@@ -2,12 +2,17 @@
 
 #include <cstddef>
 #include <filesystem>
+#include <functional>
+#include <glm/ext/matrix_float3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/vector_float3.hpp>
+#include <glm/gtx/hash.hpp>
 #include <string>
 #include <vector>
 
 #include "Surface.h"
 #include "panda/Common.h"
+#include "panda/utils/Utils.h"
 
 namespace panda::gfx::vulkan
 {
@@ -17,6 +22,11 @@ struct Transform
     glm::vec3 translation {};
     glm::vec3 scale {1.F, 1.F, 1.F};
     glm::vec3 rotation {};
+
+    [[nodiscard]] auto getRotationMatrix() const -> glm::mat3;
+    [[nodiscard]] auto getModelMatrix() const -> glm::mat4;
+
+    constexpr auto operator==(const Transform&) const noexcept -> bool = default;
 };
 
 class Scene;
@@ -40,6 +50,8 @@ public:
     [[nodiscard]] auto getSurfaces() const noexcept -> std::vector<Surface>;
 
     Transform transform;
+    bool isOccluder = false;
+    bool isStatic = false;
 
 private:
     inline static Id currentId = 0;
@@ -50,3 +62,14 @@ private:
 };
 
 }
+
+template <>
+struct std::hash<panda::gfx::vulkan::Transform>
+{
+    auto operator()(const panda::gfx::vulkan::Transform& transform) const noexcept -> size_t
+    {
+        auto seed = size_t {};
+        panda::utils::hashCombine(seed, transform.translation, transform.scale, transform.rotation);
+        return seed;
+    }
+};
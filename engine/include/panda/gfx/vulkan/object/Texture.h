@@ -9,37 +9,65 @@
 #include <filesystem>
 #include <glm/ext/vector_float4.hpp>
 #include <memory>
+#include <optional>
 #include <span>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 #include <vulkan/vulkan_structs.hpp>
 
+#include "panda/gfx/vulkan/object/TextureData.h"
+
 namespace panda::gfx::vulkan
 {
 
 class Context;
+class DeletionQueue;
 
 class Texture
 {
 public:
+    using Id = uint32_t;
+
     [[nodiscard]] static auto getDefaultTexture(const Context& context, glm::vec4 color = {1.F, 1.F, 1.F, 1.F})
         -> std::unique_ptr<Texture>;
     [[nodiscard]] static auto fromFile(const Context& context, const std::filesystem::path& path)
         -> std::unique_ptr<Texture>;
     Texture(const Context& context, std::span<const uint8_t> data, size_t width, size_t height);
+    Texture(const Context& context, TextureData textureData, bool isStreamed = false);
     PD_DELETE_ALL(Texture);
     ~Texture();
 
+    [[nodiscard]] auto getId() const noexcept -> Id;
     [[nodiscard]] auto getDescriptorImageInfo() const noexcept -> vk::DescriptorImageInfo;
+    [[nodiscard]] auto isStreamed() const noexcept -> bool;
+    [[nodiscard]] auto getWidth() const noexcept -> uint32_t;
+    [[nodiscard]] auto getHeight() const noexcept -> uint32_t;
+    [[nodiscard]] auto getMipLevelCount() const noexcept -> uint32_t;
+    [[nodiscard]] auto getBaseMipLevel() const noexcept -> uint32_t;
+    [[nodiscard]] auto getTailMipLevel() const noexcept -> uint32_t;
+    [[nodiscard]] auto getResidentSize(uint32_t baseMipLevel) const noexcept -> vk::DeviceSize;
+
+    auto setBaseMipLevel(vk::CommandBuffer commandBuffer, uint32_t baseMipLevel, DeletionQueue& deletionQueue) -> void;
 
 private:
-    auto load(std::span<const uint8_t> data, size_t width, size_t height) -> void;
+    [[nodiscard]] static auto findTailMipLevel(const TextureData& textureData) noexcept -> uint32_t;
+
+    auto load(const TextureData& textureData, uint32_t baseMipLevel) -> void;
+    auto createImage(const TextureData& textureData, uint32_t baseMipLevel) -> void;
 
     const Context& _context;
+    std::optional<TextureData> _streamedData;
     vk::Image _image;
     vk::ImageView _imageView;
     vk::DeviceMemory _imageMemory;
     vk::Sampler _sampler;
+    uint32_t _width;
+    uint32_t _height;
+    uint32_t _mipLevelCount;
+    uint32_t _tailMipLevel;
+    uint32_t _baseMipLevel;
+    inline static Id currentId = 0;
+    Id _id;
 };
 
 }
@@ -0,0 +1,53 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+
+namespace panda::gfx::vulkan
+{
+
+struct TextureData
+{
+    struct MipLevel
+    {
+        size_t offset;
+        size_t size;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    [[nodiscard]] static auto fromFile(const std::filesystem::path& path) -> std::optional<TextureData>;
+    [[nodiscard]] static auto fromImage(const std::filesystem::path& path) -> std::optional<TextureData>;
+    [[nodiscard]] static auto fromKtx2(const std::filesystem::path& path) -> std::optional<TextureData>;
+    [[nodiscard]] static auto fromDds(const std::filesystem::path& path) -> std::optional<TextureData>;
+    [[nodiscard]] static auto fromRgba(std::span<const uint8_t> pixels,
+                                       uint32_t width,
+                                       uint32_t height,
+                                       vk::Format format = vk::Format::eR8G8B8A8Srgb) -> TextureData;
+
+    [[nodiscard]] static auto isBlockCompressed(vk::Format format) noexcept -> bool;
+    [[nodiscard]] static auto getBlockSize(vk::Format format) noexcept -> size_t;
+
+    [[nodiscard]] auto isCompressed() const noexcept -> bool;
+    [[nodiscard]] auto decompress() const -> std::optional<TextureData>;
+    [[nodiscard]] auto getLevel(size_t level) const noexcept -> std::span<const uint8_t>;
+    auto generateMipmaps() -> void;
+
+    vk::Format format = vk::Format::eUndefined;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> data;
+    std::vector<MipLevel> mipLevels;
+};
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <memory>
+#include <unordered_map>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "panda/Common.h"
+#include "panda/gfx/vulkan/LightCounts.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+
+namespace panda::gfx::vulkan
+{
+class DescriptorSetLayout;
+class Device;
+class LightCullingSystem;
+struct FrameInfo;
+struct GBuffer;
+
+class DeferredLightingSystem
+{
+public:
+    DeferredLightingSystem(const Device& device,
+                           vk::RenderPass renderPass,
+                           const LightCullingSystem* lightCullingSystem = nullptr);
+    PD_DELETE_ALL(DeferredLightingSystem);
+    ~DeferredLightingSystem() noexcept;
+
+    auto render(const FrameInfo& frameInfo, const GBuffer& gBuffer, vk::ImageView depthView) -> void;
+
+private:
+    static auto createDescriptorLayout(const Device& device, bool useClusteredLighting)
+        -> std::unique_ptr<DescriptorSetLayout>;
+    static auto createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout;
+    [[nodiscard]] auto createPipeline(const LightCounts& lightCounts) const -> std::unique_ptr<Pipeline>;
+    auto getPipeline(LightCounts lightCounts) -> const Pipeline&;
+    auto pushDescriptors(const FrameInfo& frameInfo, const GBuffer& gBuffer, vk::ImageView depthView) const -> void;
+
+    const Device& _device;
+    std::unique_ptr<DescriptorSetLayout> _descriptorLayout;
+    vk::PipelineLayout _pipelineLayout;
+    vk::RenderPass _renderPass;
+    const LightCullingSystem* _lightCullingSystem;
+    std::unordered_map<LightCounts, std::unique_ptr<Pipeline>> _pipelines;
+};
+
+}
@@ -5,8 +5,11 @@
 // clang-format on
 
 #include <cstddef>
+#include <cstdint>
 #include <glm/ext/vector_float3.hpp>
+#include <filesystem>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
@@ -14,27 +17,69 @@
 #include "panda/Common.h"
 #include "panda/gfx/vulkan/Alignment.h"
 #include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/LightCounts.h"
 #include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/PipelineVariants.h"
+#include "panda/gfx/vulkan/RenderQueue.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
+#include "panda/gfx/vulkan/object/Surface.h"
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
 
 namespace panda::gfx::vulkan
 {
+class DeletionQueue;
 class DescriptorSetLayout;
 class Device;
+class LightCullingSystem;
+class Object;
+class Scene;
+class Texture;
 struct FrameInfo;
 
 class InstancedRenderSystem
 {
 public:
-    InstancedRenderSystem(const Device& device, vk::RenderPass renderPass, size_t maxInstanceCount);
+    struct Statistics
+    {
+        size_t instanceCount;
+        size_t highWaterMark;
+        size_t capacity;
+    };
+
+    InstancedRenderSystem(const Device& device,
+                          DeletionQueue& deletionQueue,
+                          utils::JobSystem& jobSystem,
+                          vk::RenderPass renderPass,
+                          size_t framesInFlight,
+                          size_t initialInstanceCount,
+                          ShadingMode shadingMode = ShadingMode::Forward,
+                          const LightCullingSystem* lightCullingSystem = nullptr,
+                          bool useDepthPrepass = false,
+                          OcclusionCullingSystem* occlusionCullingSystem = nullptr,
+                          bool useAutoInstancing = false);
     PD_DELETE_ALL(InstancedRenderSystem);
     ~InstancedRenderSystem() noexcept;
 
+    auto update(const FrameInfo& frameInfo) -> void;
+    auto renderDepthPrepass(const FrameInfo& frameInfo) -> void;
     auto render(const FrameInfo& frameInfo) -> void;
+    [[nodiscard]] auto isAutoInstanced(const Surface& surface) const noexcept -> bool;
+    [[nodiscard]] auto getStatistics() const noexcept -> const Statistics&;
 
 private:
+    static auto createDescriptorLayout(const Device& device, bool useClusteredLighting)
+        -> std::unique_ptr<DescriptorSetLayout>;
     static auto createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout;
-    static auto createPipeline(const Device& device, vk::RenderPass renderPass, vk::PipelineLayout pipelineLayout)
-        -> std::unique_ptr<Pipeline>;
+    [[nodiscard]] auto createPipeline(const LightCounts& lightCounts) const -> std::unique_ptr<Pipeline>;
+    [[nodiscard]] auto createDepthPipeline(bool packedPositions) const -> std::unique_ptr<Pipeline>;
+    [[nodiscard]] auto getFragmentShaderPath() const -> std::filesystem::path;
+    auto getPipeline(LightCounts lightCounts) -> const Pipeline&;
+    auto collectAutoInstances(const Scene& scene) -> void;
+    auto createBuffers(uint32_t frameIndex, size_t capacity) -> void;
+    auto reserveInstances(uint32_t frameIndex, size_t instanceCount) -> void;
+    auto pushDescriptors(const FrameInfo& frameInfo, const Texture& texture) const -> void;
+    auto drawGroup(const FrameInfo& frameInfo, size_t groupIndex) const -> void;
+    [[nodiscard]] auto getInstanceBuffer(uint32_t frameIndex) const -> const Buffer&;
 
     struct InstanceData
     {
@@ -45,12 +90,40 @@ private:
         PD_MAKE_ALIGNED(translation, scale, rotation)
     };
 
+    struct Group
+    {
+        Surface surface;
+        size_t baseIndex;
+        size_t instanceCount;
+        float depth;
+    };
+
     const Device& _device;
+    DeletionQueue& _deletionQueue;
     std::unique_ptr<DescriptorSetLayout> _descriptorLayout;
     vk::PipelineLayout _pipelineLayout;
-    std::unique_ptr<Pipeline> _pipeline;
+    vk::RenderPass _renderPass;
+    ShadingMode _shadingMode;
+    const LightCullingSystem* _lightCullingSystem;
+    bool _useDepthPrepass;
+    OcclusionCullingSystem* _occlusionCullingSystem;
+    bool _useAutoInstancing;
+    bool _isCulled = false;
+    PipelineVariants _pipelines;
+    std::unique_ptr<Pipeline> _packedDepthPipeline;
+    std::unique_ptr<Pipeline> _interleavedDepthPipeline;
     std::vector<std::unique_ptr<Buffer>> _instanceBuffers;
+    std::vector<std::unique_ptr<Buffer>> _culledInstanceBuffers;
+    std::vector<std::unique_ptr<Buffer>> _boundsBuffers;
+    std::vector<std::unique_ptr<Buffer>> _drawCommandBuffers;
+    std::vector<size_t> _capacities;
+    Statistics _statistics {};
+    std::unordered_map<Surface, std::vector<const Object*>> _autoInstances;
     std::vector<InstanceData> _instances;
+    std::vector<Group> _groups;
+    RenderQueue _renderQueue;
+    std::vector<OcclusionCullingSystem::InstanceBounds> _bounds;
+    std::vector<vk::DrawIndexedIndirectCommand> _drawCommands;
 };
 
 }
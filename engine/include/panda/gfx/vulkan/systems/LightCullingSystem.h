@@ -0,0 +1,86 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_uint4.hpp>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Common.h"
+#include "panda/gfx/Camera.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/UboLight.h"
+
+namespace panda::gfx::vulkan
+{
+class DescriptorSetLayout;
+class Device;
+struct FrameInfo;
+
+class LightCullingSystem
+{
+public:
+    struct Buffers
+    {
+        const Buffer& clusterUbo;
+        const Buffer& pointLights;
+        const Buffer& spotLights;
+        const Buffer& lightGrid;
+        const Buffer& lightIndices;
+    };
+
+    static constexpr auto clusterCountX = uint32_t {16};
+    static constexpr auto clusterCountY = uint32_t {9};
+    static constexpr auto clusterCountZ = uint32_t {24};
+    static constexpr auto clusterCount = clusterCountX * clusterCountY * clusterCountZ;
+    static constexpr auto maxLightsPerCluster = uint32_t {128};
+
+    LightCullingSystem(const Device& device, size_t framesInFlight);
+    PD_DELETE_ALL(LightCullingSystem);
+    ~LightCullingSystem() noexcept;
+
+    auto cull(const FrameInfo& frameInfo, vk::Extent2D extent) -> void;
+    auto latchCamera(uint32_t frameIndex, const Camera& camera) -> void;
+    [[nodiscard]] auto getBuffers(uint32_t frameIndex) const -> Buffers;
+
+private:
+    struct ClusterUbo
+    {
+        glm::mat4 view;
+        glm::mat4 inverseProjection;
+        glm::uvec4 gridSize;
+        glm::vec2 screenSize;
+        float near;
+        float far;
+        uint32_t pointLightCount;
+        uint32_t spotLightCount;
+    };
+
+    static constexpr auto workGroupSize = uint32_t {64};
+
+    static auto createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout;
+
+    const Device& _device;
+    std::unique_ptr<DescriptorSetLayout> _descriptorLayout;
+    vk::PipelineLayout _pipelineLayout;
+    std::unique_ptr<ComputePipeline> _pipeline;
+    std::vector<std::unique_ptr<Buffer>> _clusterUboBuffers;
+    std::vector<std::unique_ptr<Buffer>> _pointLightBuffers;
+    std::vector<std::unique_ptr<Buffer>> _spotLightBuffers;
+    std::vector<std::unique_ptr<Buffer>> _lightGridBuffers;
+    std::vector<std::unique_ptr<Buffer>> _lightIndexBuffers;
+    std::vector<UboPointLight> _pointLights;
+    std::vector<UboSpotLight> _spotLights;
+};
+
+}
@@ -14,6 +14,7 @@
 #include "panda/gfx/vulkan/Device.h"
 #include "panda/gfx/vulkan/FrameInfo.h"
 #include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
 
 namespace panda::gfx::vulkan
 {
@@ -21,7 +22,7 @@ namespace panda::gfx::vulkan
 class LightSystem
 {
 public:
-    LightSystem(const Device& device, vk::RenderPass renderPass);
+    LightSystem(const Device& device, vk::RenderPass renderPass, ShadingMode shadingMode = ShadingMode::Forward);
     PD_DELETE_ALL(LightSystem);
     ~LightSystem() noexcept;
 
@@ -30,8 +31,10 @@ public:
 
 private:
     static auto createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout;
-    static auto createPipeline(const Device& device, vk::RenderPass renderPass, vk::PipelineLayout pipelineLayout)
-        -> std::unique_ptr<Pipeline>;
+    static auto createPipeline(const Device& device,
+                               vk::RenderPass renderPass,
+                               vk::PipelineLayout pipelineLayout,
+                               ShadingMode shadingMode) -> std::unique_ptr<Pipeline>;
 
     const Device& _device;
     std::unique_ptr<DescriptorSetLayout> _descriptorLayout;
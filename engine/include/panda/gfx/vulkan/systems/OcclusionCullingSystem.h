@@ -0,0 +1,149 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float2.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <limits>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Common.h"
+#include "panda/gfx/Camera.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/utils/Utils.h"
+
+namespace panda::gfx::vulkan
+{
+class DeletionQueue;
+class DescriptorSetLayout;
+class Device;
+class Mesh;
+struct FrameInfo;
+struct Transform;
+
+class OcclusionCullingSystem
+{
+public:
+    struct alignas(16) InstanceBounds
+    {
+        glm::vec4 sphere;
+        uint32_t drawCommand;
+        uint32_t firstInstance;
+    };
+
+    // Identifies a culled surface across frames, batched surfaces use batchObject and their mesh id
+    struct DrawKey
+    {
+        size_t object;
+        size_t surface;
+
+        auto operator==(const DrawKey&) const noexcept -> bool = default;
+    };
+
+    struct InstanceBuffers
+    {
+        const Buffer& instances;
+        const Buffer& bounds;
+        const Buffer& culledInstances;
+        const Buffer& drawCommands;
+    };
+
+    static constexpr auto maxObjectCount = uint32_t {4096};
+    static constexpr auto batchObject = std::numeric_limits<size_t>::max();
+
+    OcclusionCullingSystem(const Device& device, DeletionQueue& deletionQueue, size_t framesInFlight);
+    PD_DELETE_ALL(OcclusionCullingSystem);
+    ~OcclusionCullingSystem() noexcept;
+
+    [[nodiscard]] static auto getBoundingSphere(const Transform& transform, const Mesh& mesh) -> glm::vec4;
+
+    auto update(const FrameInfo& frameInfo) -> void;
+    auto cullObjects(const FrameInfo& frameInfo, std::span<const glm::vec4> spheres, std::span<const DrawKey> keys)
+        -> void;
+    [[nodiscard]] auto cullInstances(const FrameInfo& frameInfo,
+                                     const InstanceBuffers& buffers,
+                                     uint32_t instanceCount) const -> bool;
+    auto resizePyramid(vk::Extent2D depthExtent) -> void;
+    auto buildPyramid(const FrameInfo& frameInfo, vk::ImageView depthView, vk::Extent2D renderExtent) -> void;
+    auto latchCamera(const Camera& camera) -> void;
+    [[nodiscard]] auto isPyramidReady() const noexcept -> bool;
+    [[nodiscard]] auto getPyramidImage() const noexcept -> vk::Image;
+    [[nodiscard]] auto getPyramidRange() const noexcept -> vk::ImageSubresourceRange;
+    [[nodiscard]] auto isVisible(const DrawKey& key) const noexcept -> bool;
+
+private:
+    struct CullingUbo
+    {
+        glm::mat4 viewProjection;
+        glm::vec2 pyramidSize;
+        uint32_t mipCount;
+    };
+
+    struct Pyramid
+    {
+        vk::Image image;
+        vk::DeviceMemory memory;
+        vk::ImageView view;
+        std::vector<vk::ImageView> mipViews;
+        vk::Extent2D depthExtent;
+        vk::Extent2D extent;
+        uint32_t mipCount;
+    };
+
+    static constexpr auto workGroupSize = uint32_t {64};
+    static constexpr auto pyramidWorkGroupSize = uint32_t {8};
+    static constexpr auto pyramidFormat = vk::Format::eR32Sfloat;
+
+    static auto createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout, uint32_t pushConstantSize)
+        -> vk::PipelineLayout;
+    static auto createSampler(const Device& device) -> vk::Sampler;
+    static auto createPyramid(const Device& device, vk::Extent2D depthExtent) -> Pyramid;
+    static auto destroyPyramid(const Device& device, const Pyramid& pyramid) -> void;
+
+    [[nodiscard]] auto getPyramidDescriptorInfo() const noexcept -> vk::DescriptorImageInfo;
+
+    const Device& _device;
+    DeletionQueue& _deletionQueue;
+    std::unique_ptr<DescriptorSetLayout> _pyramidDescriptorLayout;
+    vk::PipelineLayout _pyramidPipelineLayout;
+    std::unique_ptr<ComputePipeline> _pyramidPipeline;
+    std::unique_ptr<DescriptorSetLayout> _cullingDescriptorLayout;
+    vk::PipelineLayout _cullingPipelineLayout;
+    std::unique_ptr<ComputePipeline> _objectCullingPipeline;
+    std::unique_ptr<ComputePipeline> _instanceCullingPipeline;
+    vk::Sampler _sampler;
+    Pyramid _pyramid {};
+    glm::mat4 _pyramidViewProjection {1.F};
+    bool _isPyramidReady = false;
+    std::vector<std::unique_ptr<Buffer>> _cullingUboBuffers;
+    std::vector<std::unique_ptr<Buffer>> _sphereBuffers;
+    std::vector<std::unique_ptr<Buffer>> _visibilityBuffers;
+    std::vector<std::vector<DrawKey>> _submittedKeys;
+    std::vector<uint32_t> _readback;
+    std::unordered_map<DrawKey, bool> _visibility;
+};
+
+}
+
+template <>
+struct std::hash<panda::gfx::vulkan::OcclusionCullingSystem::DrawKey>
+{
+    auto operator()(const panda::gfx::vulkan::OcclusionCullingSystem::DrawKey& key) const noexcept -> size_t
+    {
+        auto seed = size_t {};
+        panda::utils::hashCombine(seed, key.object, key.surface);
+        return seed;
+    }
+};
@@ -4,37 +4,140 @@
 #include "panda/utils/Assert.h"
 // clang-format on
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <memory>
+#include <optional>
+#include <span>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
 #include "panda/Common.h"
+#include "panda/gfx/vulkan/Alignment.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/LightCounts.h"
 #include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/PipelineVariants.h"
+#include "panda/gfx/vulkan/RenderQueue.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
+#include "panda/gfx/vulkan/object/Surface.h"
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
 
 namespace panda::gfx::vulkan
 {
+class DeletionQueue;
 class DescriptorSetLayout;
 class Device;
+class InstancedRenderSystem;
+class LightCullingSystem;
+class SecondaryCommandRecorder;
+class SoftwareOcclusionSystem;
+class StaticBatchSystem;
+class Object;
+class Texture;
 struct FrameInfo;
+struct Transform;
 
 class RenderSystem
 {
 public:
-    RenderSystem(const Device& device, vk::RenderPass renderPass);
+    RenderSystem(const Device& device,
+                 DeletionQueue& deletionQueue,
+                 utils::JobSystem& jobSystem,
+                 vk::RenderPass renderPass,
+                 size_t framesInFlight,
+                 ShadingMode shadingMode = ShadingMode::Forward,
+                 const LightCullingSystem* lightCullingSystem = nullptr,
+                 bool useDepthPrepass = false,
+                 OcclusionCullingSystem* occlusionCullingSystem = nullptr,
+                 const SoftwareOcclusionSystem* softwareOcclusionSystem = nullptr,
+                 bool useStaticCommandBuffers = false,
+                 const StaticBatchSystem* staticBatchSystem = nullptr,
+                 const InstancedRenderSystem* instancedRenderSystem = nullptr);
     PD_DELETE_ALL(RenderSystem);
     ~RenderSystem() noexcept;
 
-    auto render(const FrameInfo& frameInfo) const -> void;
+    auto update(const FrameInfo& frameInfo) -> void;
+    auto renderDepthPrepass(const FrameInfo& frameInfo) -> void;
+    auto render(const FrameInfo& frameInfo) -> void;
+    [[nodiscard]] auto renderParallel(const FrameInfo& frameInfo, SecondaryCommandRecorder& commandRecorder)
+        -> std::vector<vk::CommandBuffer>;
+    [[nodiscard]] auto renderStatic(const FrameInfo& frameInfo, const SecondaryCommandRecorder& commandRecorder)
+        -> std::optional<vk::CommandBuffer>;
 
 private:
+    static auto createDescriptorLayout(const Device& device, bool useClusteredLighting)
+        -> std::unique_ptr<DescriptorSetLayout>;
     static auto createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout;
-    static auto createPipeline(const Device& device, vk::RenderPass renderPass, vk::PipelineLayout pipelineLayout)
-        -> std::unique_ptr<Pipeline>;
+    [[nodiscard]] auto createPipeline(const LightCounts& lightCounts) const -> std::unique_ptr<Pipeline>;
+    [[nodiscard]] auto createDepthPipeline(bool packedPositions) const -> std::unique_ptr<Pipeline>;
+    [[nodiscard]] auto getFragmentShaderPath() const -> std::filesystem::path;
+    auto getPipeline(LightCounts lightCounts) -> const Pipeline&;
+    auto sortDraws() -> void;
+    auto sortStaticDraws() -> void;
+    auto recordDraws(const FrameInfo& frameInfo, std::span<const RenderQueue::Entry> entries) const -> void;
+    [[nodiscard]] auto getStaticSignature(const FrameInfo& frameInfo, vk::Pipeline pipeline, vk::Extent2D extent) const
+        -> size_t;
+    auto writeObjects(const FrameInfo& frameInfo) -> void;
+    auto createObjectBuffer(uint32_t frameIndex, size_t capacity) -> void;
+    auto pushDescriptors(const FrameInfo& frameInfo, const Texture& texture) const -> void;
+    [[nodiscard]] auto isSurfaceVisible(size_t surfaceIndex, const OcclusionCullingSystem::DrawKey& key) const noexcept
+        -> bool;
+
+    struct ObjectData
+    {
+        alignas(16) glm::vec3 translation;
+        alignas(16) glm::vec3 scale;
+        alignas(16) glm::vec3 rotation;
+
+        PD_MAKE_ALIGNED(translation, scale, rotation)
+    };
+
+    struct Draw
+    {
+        const Transform* transform;
+        Surface surface;
+        float depth;
+        bool isStatic;
+    };
+
+    struct StaticCommandBuffer
+    {
+        vk::CommandBuffer commandBuffer;
+        std::optional<size_t> signature;
+    };
+
+    static constexpr auto initialObjectCount = size_t {256};
 
     const Device& _device;
+    DeletionQueue& _deletionQueue;
     std::unique_ptr<DescriptorSetLayout> _descriptorLayout;
     vk::PipelineLayout _pipelineLayout;
-    std::unique_ptr<Pipeline> _pipeline;
+    vk::RenderPass _renderPass;
+    ShadingMode _shadingMode;
+    const LightCullingSystem* _lightCullingSystem;
+    bool _useDepthPrepass;
+    OcclusionCullingSystem* _occlusionCullingSystem;
+    const SoftwareOcclusionSystem* _softwareOcclusionSystem;
+    const StaticBatchSystem* _staticBatchSystem;
+    const InstancedRenderSystem* _instancedRenderSystem;
+    PipelineVariants _pipelines;
+    std::unique_ptr<Pipeline> _packedDepthPipeline;
+    std::unique_ptr<Pipeline> _interleavedDepthPipeline;
+    std::vector<glm::vec4> _spheres;
+    std::vector<OcclusionCullingSystem::DrawKey> _sphereKeys;
+    std::vector<Draw> _draws;
+    std::vector<ObjectData> _objects;
+    std::vector<std::unique_ptr<Buffer>> _objectBuffers;
+    std::vector<size_t> _objectCapacities;
+    RenderQueue _renderQueue;
+    vk::CommandPool _staticCommandPool;
+    std::vector<StaticCommandBuffer> _staticCommandBuffers;
+    RenderQueue _staticRenderQueue;
 };
 
 }
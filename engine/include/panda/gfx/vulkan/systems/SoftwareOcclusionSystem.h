@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <vector>
+
+#include "panda/Common.h"
+#include "panda/utils/JobSystem.h"
+
+namespace panda::gfx::vulkan
+{
+class Scene;
+
+class SoftwareOcclusionSystem
+{
+public:
+    struct Statistics
+    {
+        size_t occluderCount;
+        size_t occluderTriangleCount;
+        size_t occludeeCount;
+        size_t culledCount;
+    };
+
+    static constexpr auto width = uint32_t {256};
+    static constexpr auto height = uint32_t {128};
+
+    explicit SoftwareOcclusionSystem(utils::JobSystem& jobSystem, float frustumMargin = 0.F);
+    PD_DELETE_ALL(SoftwareOcclusionSystem);
+    ~SoftwareOcclusionSystem() noexcept;
+
+    auto beginCulling(const Scene& scene) -> void;
+    auto finishCulling() -> void;
+    [[nodiscard]] auto isVisible(size_t surfaceIndex) const noexcept -> bool;
+    [[nodiscard]] auto getStatistics() const noexcept -> const Statistics&;
+
+private:
+    struct Triangle
+    {
+        glm::vec3 v0;
+        glm::vec3 v1;
+        glm::vec3 v2;
+    };
+
+    struct Occludee
+    {
+        glm::vec4 sphere;
+        size_t surfaceIndex;
+    };
+
+    auto cull(const Scene& scene, const glm::mat4& viewProjection) -> void;
+    auto collect(const Scene& scene, const glm::mat4& viewProjection) -> void;
+    auto addOccluderTriangles(const std::vector<glm::vec3>& positions,
+                              const std::vector<uint32_t>& indices,
+                              const glm::mat4& modelViewProjection) -> void;
+    auto rasterizeRows(uint32_t beginRow, uint32_t endRow) -> void;
+    auto rasterizeTriangle(const Triangle& triangle, uint32_t beginRow, uint32_t endRow) -> void;
+    [[nodiscard]] auto testOccludee(const glm::vec4& sphere, const glm::mat4& viewProjection) const -> bool;
+
+    utils::JobSystem& _jobSystem;
+    float _frustumMargin;
+    std::future<void> _cullingJob;
+    std::vector<float> _depth;
+    std::vector<Triangle> _triangles;
+    std::vector<Occludee> _occludees;
+    std::vector<uint8_t> _visibility;
+    Statistics _statistics {};
+};
+
+}
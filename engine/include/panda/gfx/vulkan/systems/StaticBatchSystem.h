@@ -0,0 +1,72 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "panda/Common.h"
+#include "panda/gfx/vulkan/object/Mesh.h"
+#include "panda/gfx/vulkan/object/Object.h"
+#include "panda/gfx/vulkan/object/Surface.h"
+
+namespace panda::gfx::vulkan
+{
+class DeletionQueue;
+class Device;
+class Scene;
+class Texture;
+
+class StaticBatchSystem
+{
+public:
+    static constexpr auto cellSize = 32.F;
+
+    StaticBatchSystem(const Device& device, DeletionQueue& deletionQueue, bool createPositionStream = false);
+    PD_DELETE_ALL(StaticBatchSystem);
+    ~StaticBatchSystem() noexcept;
+
+    [[nodiscard]] static auto isBatchable(const Surface& surface) noexcept -> bool;
+
+    auto update(vk::CommandBuffer commandBuffer, const Scene& scene) -> void;
+    [[nodiscard]] auto getSurfaces() const noexcept -> const std::vector<Surface>&;
+
+private:
+    struct BatchKey
+    {
+        const Texture* texture;
+        std::array<int32_t, 3> cell;
+
+        constexpr auto operator<=>(const BatchKey&) const noexcept = default;
+    };
+
+    struct BatchedObject
+    {
+        Transform transform;
+        std::vector<Surface> surfaces;
+        std::vector<BatchKey> keys;
+    };
+
+    [[nodiscard]] static auto getBatchKeys(const Transform& transform, const std::vector<Surface>& surfaces)
+        -> std::vector<BatchKey>;
+    [[nodiscard]] static auto getCell(const Transform& transform) -> std::array<int32_t, 3>;
+    static auto appendGeometry(const MeshGeometry& geometry, const Transform& transform, MeshGeometry& batch) -> void;
+    auto rebuildBatch(const Mesh::Upload& upload, const BatchKey& key) -> void;
+
+    const Device& _device;
+    DeletionQueue& _deletionQueue;
+    bool _createPositionStream;
+    std::unordered_map<Object::Id, BatchedObject> _objects;
+    std::map<BatchKey, std::unique_ptr<Mesh>> _batches;
+    std::vector<Surface> _surfaces;
+};
+
+}
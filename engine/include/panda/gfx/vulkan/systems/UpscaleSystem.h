@@ -0,0 +1,48 @@
+#pragma once
+
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include <memory>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Common.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+
+namespace panda::gfx::vulkan
+{
+class DescriptorSetLayout;
+class Device;
+struct FrameInfo;
+
+class UpscaleSystem
+{
+public:
+    UpscaleSystem(const Device& device, vk::RenderPass renderPass, float sharpness = 0.F);
+    PD_DELETE_ALL(UpscaleSystem);
+    ~UpscaleSystem() noexcept;
+
+    auto render(const FrameInfo& frameInfo,
+                vk::ImageView sceneColor,
+                vk::Extent2D renderExtent,
+                vk::Extent2D renderTargetExtent) const -> void;
+
+private:
+    static auto createDescriptorLayout(const Device& device) -> std::unique_ptr<DescriptorSetLayout>;
+    static auto createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout;
+    static auto createSampler(const Device& device) -> vk::Sampler;
+    [[nodiscard]] auto createPipeline() const -> std::unique_ptr<Pipeline>;
+
+    const Device& _device;
+    std::unique_ptr<DescriptorSetLayout> _descriptorLayout;
+    vk::PipelineLayout _pipelineLayout;
+    vk::RenderPass _renderPass;
+    vk::Sampler _sampler;
+    std::unique_ptr<Pipeline> _pipeline;
+    float _sharpness;
+};
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+
+#include "panda/Common.h"
+
+namespace panda::utils
+{
+
+class FrameLimiter
+{
+public:
+    explicit FrameLimiter(float maxFrameRate);
+    PD_DELETE_ALL(FrameLimiter);
+    ~FrameLimiter() noexcept = default;
+
+    auto wait() -> void;
+
+private:
+    static constexpr auto spinThreshold = std::chrono::milliseconds {2};
+
+    std::chrono::steady_clock::duration _frameDuration;
+    std::chrono::steady_clock::time_point _nextFrame;
+};
+
+}
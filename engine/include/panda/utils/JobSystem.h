@@ -0,0 +1,44 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "panda/Common.h"
+
+namespace panda::utils
+{
+
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+    using RangeJob = std::function<void(size_t begin, size_t end)>;
+
+    explicit JobSystem(size_t workerCount = getDefaultWorkerCount());
+    PD_DELETE_ALL(JobSystem);
+    ~JobSystem() noexcept = default;
+
+    [[nodiscard]] static auto getDefaultWorkerCount() noexcept -> size_t;
+
+    [[nodiscard]] auto submit(Job job) -> std::future<void>;
+    auto parallelFor(size_t count, size_t minBatchSize, const RangeJob& job) -> void;
+    [[nodiscard]] auto getWorkerCount() const noexcept -> size_t;
+
+private:
+    auto work(const std::stop_token& stopToken) -> void;
+    auto tryRunPendingJob() -> bool;
+
+    std::mutex _queueMutex;
+    std::condition_variable_any _queueCondition;
+    std::queue<std::packaged_task<void()>> _jobs;
+    std::vector<std::jthread> _workers;
+};
+
+}
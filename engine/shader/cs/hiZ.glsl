@@ -0,0 +1,61 @@
+#ifndef HI_Z_GLSL
+#define HI_Z_GLSL
+
+layout (set = 0, binding = 0) uniform sampler2D depthPyramid;
+
+layout (set = 0, binding = 1) uniform CullingUbo
+{
+    mat4 viewProjection;
+    vec2 pyramidSize;
+    uint mipCount;
+} culling;
+
+layout (push_constant) uniform Push {
+    uint count;
+} push;
+
+bool isSphereVisible(vec4 sphere)
+{
+    vec3 minNdc = vec3(1.0);
+    vec3 maxNdc = vec3(-1.0);
+    for (int i = 0; i < 8; i++)
+    {
+        vec3 corner = vec3((i & 1) != 0 ? 1.0 : -1.0, (i & 2) != 0 ? 1.0 : -1.0, (i & 4) != 0 ? 1.0 : -1.0);
+        vec4 clip = culling.viewProjection * vec4(sphere.xyz + corner * sphere.w, 1.0);
+        if (clip.w <= 0.0)
+        {
+            return true;
+        }
+
+        vec3 ndc = clip.xyz / clip.w;
+        minNdc = min(minNdc, ndc);
+        maxNdc = max(maxNdc, ndc);
+    }
+
+    if (any(lessThan(maxNdc.xy, vec2(-1.0))) || any(greaterThan(minNdc.xy, vec2(1.0))) || minNdc.z > 1.0)
+    {
+        return false;
+    }
+
+    vec2 minUv = clamp(minNdc.xy * 0.5 + 0.5, 0.0, 1.0);
+    vec2 maxUv = clamp(maxNdc.xy * 0.5 + 0.5, 0.0, 1.0);
+    vec2 extent = (maxUv - minUv) * culling.pyramidSize;
+    int level = min(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), int(culling.mipCount) - 1);
+
+    ivec2 levelSize = textureSize(depthPyramid, level);
+    ivec2 minTexel = clamp(ivec2(minUv * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 maxTexel = clamp(ivec2(maxUv * vec2(levelSize)), ivec2(0), levelSize - 1);
+
+    float occluderDepth = 0.0;
+    for (int y = minTexel.y; y <= maxTexel.y; y++)
+    {
+        for (int x = minTexel.x; x <= maxTexel.x; x++)
+        {
+            occluderDepth = max(occluderDepth, texelFetch(depthPyramid, ivec2(x, y), level).r);
+        }
+    }
+
+    return minNdc.z <= occluderDepth;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef CLUSTER_SHADING_GLSL
+#define CLUSTER_SHADING_GLSL
+
+#include "clusterUtils.glsl"
+
+layout (set = 0, binding = 7) readonly buffer LightGridBuffer
+{
+    uvec2 lightGrid[];
+};
+
+layout (set = 0, binding = 8) readonly buffer LightIndexBuffer
+{
+    uint lightIndices[];
+};
+
+layout (constant_id = 0) const uint directionalLightCount = DYNAMIC_LIGHT_COUNT;
+
+uint getDirectionalLightCount()
+{
+    return directionalLightCount == DYNAMIC_LIGHT_COUNT ? ubo.activeDirectionalLights : directionalLightCount;
+}
+
+uint getFragmentClusterIndex()
+{
+    float viewDepth = (cluster.view * vec4(fragWorldPosition, 1.0)).z;
+    uvec2 tile = uvec2(gl_FragCoord.xy / cluster.screenSize * vec2(cluster.gridSize.xy));
+    return getClusterIndex(uvec3(min(tile, cluster.gridSize.xy - 1), getDepthSlice(viewDepth)));
+}
+
+vec3 calculateClusteredLights(vec3 normal)
+{
+    vec3 totalLight = vec3(0.0);
+
+    for (uint i = 0; i < getDirectionalLightCount(); i++)
+    {
+        totalLight += calculateDirectionalLight(ubo.directionalLights[i], normal);
+    }
+
+    uint clusterIndex = getFragmentClusterIndex();
+    uint offset = clusterIndex * getMaxLightsPerCluster();
+    uvec2 lightCount = lightGrid[clusterIndex];
+
+    for (uint i = 0; i < lightCount.x; i++)
+    {
+        totalLight += calculatePointLight(clusterPointLights[lightIndices[offset + i]], normal);
+    }
+    for (uint i = 0; i < lightCount.y; i++)
+    {
+        totalLight += calculateSpotLight(clusterSpotLights[lightIndices[offset + lightCount.x + i]], normal);
+    }
+
+    return totalLight;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef CLUSTER_UTILS_GLSL
+#define CLUSTER_UTILS_GLSL
+
+#include "lightUtils.glsl"
+
+layout (set = 0, binding = 4) uniform ClusterUbo
+{
+    mat4 view;
+    mat4 inverseProjection;
+    uvec4 gridSize;
+    vec2 screenSize;
+    float near;
+    float far;
+    uint pointLightCount;
+    uint spotLightCount;
+} cluster;
+
+layout (set = 0, binding = 5) readonly buffer PointLightBuffer
+{
+    PointLight clusterPointLights[];
+};
+
+layout (set = 0, binding = 6) readonly buffer SpotLightBuffer
+{
+    SpotLight clusterSpotLights[];
+};
+
+uint getMaxLightsPerCluster()
+{
+    return cluster.gridSize.w;
+}
+
+uint getClusterIndex(uvec3 clusterId)
+{
+    return clusterId.x + cluster.gridSize.x * (clusterId.y + cluster.gridSize.y * clusterId.z);
+}
+
+uint getDepthSlice(float viewDepth)
+{
+    float slice = log(viewDepth / cluster.near) / log(cluster.far / cluster.near) * float(cluster.gridSize.z);
+    return uint(clamp(slice, 0.0, float(cluster.gridSize.z - 1)));
+}
+
+float getSliceDepth(uint slice)
+{
+    return cluster.near * pow(cluster.far / cluster.near, float(slice) / float(cluster.gridSize.z));
+}
+
+float getLightRange(PointLight light)
+{
+    float constantTerm = light.attenuation.constant;
+    float linearTerm = light.attenuation.linear;
+    float quadraticTerm = light.attenuation.exp;
+
+    if (quadraticTerm > 0.0)
+    {
+        float discriminant = max(linearTerm * linearTerm + 4.0 * quadraticTerm * constantTerm, 0.0);
+        return (sqrt(discriminant) - linearTerm) / (2.0 * quadraticTerm);
+    }
+    if (linearTerm > 0.0)
+    {
+        return max(constantTerm / linearTerm, 0.0);
+    }
+    return constantTerm > 0.0 ? cluster.far : 0.0;
+}
+
+#endif
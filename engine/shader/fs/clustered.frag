@@ -0,0 +1,17 @@
+#version 450
+
+layout (location = 0) in vec3 fragWorldPosition;
+layout (location = 1) in vec3 fragNormalWorld;
+layout (location = 2) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+#include "lighting.glsl"
+#include "clusterShading.glsl"
+
+layout (binding = 2) uniform sampler2D texSampler;
+
+void main() {
+    vec3 totalLight = calculateClusteredLights(normalize(fragNormalWorld));
+    outColor = texture(texSampler, fragTexCoord) * vec4(totalLight, 1.0);
+}
@@ -0,0 +1,3 @@
+#version 450
+
+#include "deferred.glsl"
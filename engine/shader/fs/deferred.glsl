@@ -0,0 +1,46 @@
+#ifndef DEFERRED_GLSL
+#define DEFERRED_GLSL
+
+layout (location = 0) in vec2 fragNdc;
+
+layout (location = 0) out vec4 outColor;
+
+layout (input_attachment_index = 0, set = 0, binding = 9) uniform subpassInput albedoInput;
+layout (input_attachment_index = 1, set = 0, binding = 10) uniform subpassInput normalInput;
+layout (input_attachment_index = 2, set = 0, binding = 11) uniform subpassInput depthInput;
+
+layout (push_constant) uniform Push {
+    mat4 inverseViewProjection;
+} push;
+
+vec3 fragWorldPosition;
+
+#include "lighting.glsl"
+
+#ifdef CLUSTERED_LIGHTING
+#include "clusterShading.glsl"
+#else
+#include "lightCounts.glsl"
+#endif
+
+void main() {
+    float depth = subpassLoad(depthInput).r;
+    if (depth >= 1.0)
+    {
+        discard;
+    }
+
+    vec4 worldPosition = push.inverseViewProjection * vec4(fragNdc, depth, 1.0);
+    fragWorldPosition = worldPosition.xyz / worldPosition.w;
+    vec3 normal = normalize(subpassLoad(normalInput).xyz);
+
+#ifdef CLUSTERED_LIGHTING
+    vec3 totalLight = calculateClusteredLights(normal);
+#else
+    vec3 totalLight = calculateLights(normal);
+#endif
+
+    outColor = subpassLoad(albedoInput) * vec4(totalLight, 1.0);
+}
+
+#endif
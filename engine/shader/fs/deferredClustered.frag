@@ -0,0 +1,4 @@
+#version 450
+
+#define CLUSTERED_LIGHTING
+#include "deferred.glsl"
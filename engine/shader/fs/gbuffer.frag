@@ -0,0 +1,15 @@
+#version 450
+
+layout (location = 0) in vec3 fragWorldPosition;
+layout (location = 1) in vec3 fragNormalWorld;
+layout (location = 2) in vec2 fragTexCoord;
+
+layout (location = 0) out vec4 outAlbedo;
+layout (location = 1) out vec4 outNormal;
+
+layout (binding = 2) uniform sampler2D texSampler;
+
+void main() {
+    outAlbedo = texture(texSampler, fragTexCoord);
+    outNormal = vec4(normalize(fragNormalWorld), 0.0);
+}
@@ -0,0 +1,43 @@
+#ifndef LIGHT_COUNTS_GLSL
+#define LIGHT_COUNTS_GLSL
+
+layout (constant_id = 0) const uint directionalLightCount = DYNAMIC_LIGHT_COUNT;
+layout (constant_id = 1) const uint pointLightCount = DYNAMIC_LIGHT_COUNT;
+layout (constant_id = 2) const uint spotLightCount = DYNAMIC_LIGHT_COUNT;
+
+uint getDirectionalLightCount()
+{
+    return directionalLightCount == DYNAMIC_LIGHT_COUNT ? ubo.activeDirectionalLights : directionalLightCount;
+}
+
+uint getPointLightCount()
+{
+    return pointLightCount == DYNAMIC_LIGHT_COUNT ? ubo.activePointLights : pointLightCount;
+}
+
+uint getSpotLightCount()
+{
+    return spotLightCount == DYNAMIC_LIGHT_COUNT ? ubo.activeSpotLights : spotLightCount;
+}
+
+vec3 calculateLights(vec3 normal)
+{
+    vec3 totalLight = vec3(0.0);
+
+    for (uint i = 0; i < getDirectionalLightCount(); i++)
+    {
+        totalLight += calculateDirectionalLight(ubo.directionalLights[i], normal);
+    }
+    for (uint i = 0; i < getPointLightCount(); i++)
+    {
+        totalLight += calculatePointLight(ubo.pointLights[i], normal);
+    }
+    for (uint i = 0; i < getSpotLightCount(); i++)
+    {
+        totalLight += calculateSpotLight(ubo.spotLights[i], normal);
+    }
+
+    return totalLight;
+}
+
+#endif
@@ -1,3 +1,12 @@
+#ifndef LIGHT_UTILS_GLSL
+#define LIGHT_UTILS_GLSL
+
+#ifndef MAX_LIGHTS
+#define MAX_LIGHTS 5
+#endif
+
+#define DYNAMIC_LIGHT_COUNT 0xFFFFFFFFu
+
 struct Attenuation
 {
     float constant;
@@ -32,3 +41,5 @@ struct SpotLight
     vec3 direction;
     float cutOff;
 };
+
+#endif
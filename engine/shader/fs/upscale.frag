@@ -0,0 +1,35 @@
+#version 450
+
+layout (location = 0) in vec2 fragNdc;
+
+layout (location = 0) out vec4 outColor;
+
+layout (set = 0, binding = 0) uniform sampler2D sceneColor;
+
+layout (push_constant) uniform Push {
+    vec2 uvScale;
+    float sharpness;
+} push;
+
+vec3 sampleScene(vec2 uv, vec2 minUv, vec2 maxUv) {
+    return texture(sceneColor, clamp(uv, minUv, maxUv)).rgb;
+}
+
+void main() {
+    vec2 texelSize = 1.0 / vec2(textureSize(sceneColor, 0));
+    vec2 minUv = texelSize * 0.5;
+    vec2 maxUv = push.uvScale - texelSize * 0.5;
+    vec2 uv = (fragNdc * 0.5 + 0.5) * push.uvScale;
+
+    vec3 color = sampleScene(uv, minUv, maxUv);
+    if (push.sharpness > 0.0)
+    {
+        vec3 neighbours = sampleScene(uv + vec2(texelSize.x, 0.0), minUv, maxUv)
+                        + sampleScene(uv - vec2(texelSize.x, 0.0), minUv, maxUv)
+                        + sampleScene(uv + vec2(0.0, texelSize.y), minUv, maxUv)
+                        + sampleScene(uv - vec2(0.0, texelSize.y), minUv, maxUv);
+        color = max(color + (color - neighbours * 0.25) * push.sharpness, vec3(0.0));
+    }
+
+    outColor = vec4(color, 1.0);
+}
@@ -0,0 +1,8 @@
+#version 450
+
+layout (location = 0) out vec2 fragNdc;
+
+void main() {
+    fragNdc = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2) * 2.0 - 1.0;
+    gl_Position = vec4(fragNdc, 0.0, 1.0);
+}
@@ -26,6 +26,8 @@ layout (set = 0, binding = 3) readonly buffer InstanceBuffer {
     InstanceData instances[];
 };
 
+invariant gl_Position;
+
 void main() {
     InstanceData instance = instances[gl_InstanceIndex];
 
@@ -0,0 +1,71 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/HeadlessWindow.h"
+
+#include <vulkan/vulkan_core.h>
+
+#include <bit>
+#include <chrono>
+#include <glm/ext/vector_uint2.hpp>
+#include <vector>
+
+namespace panda
+{
+
+HeadlessWindow::HeadlessWindow(glm::uvec2 size)
+    : _size {size}
+{
+    expect(_size.x > 0 && _size.y > 0, "Headless window can't be empty");
+}
+
+auto HeadlessWindow::shouldClose() const -> bool
+{
+    return _shouldClose;
+}
+
+auto HeadlessWindow::isMinimized() const -> bool
+{
+    return false;
+}
+
+auto HeadlessWindow::getSize() const -> glm::uvec2
+{
+    return _size;
+}
+
+auto HeadlessWindow::getRequiredExtensions() const -> std::vector<const char*>
+{
+    return {};
+}
+
+auto HeadlessWindow::createSurface(VkInstance) const -> VkSurfaceKHR
+{
+    // A null surface tells the context to skip presentation entirely
+    return VK_NULL_HANDLE;
+}
+
+auto HeadlessWindow::getId() const -> Id
+{
+    return std::bit_cast<Id>(this);
+}
+
+auto HeadlessWindow::processInput() -> void
+{
+}
+
+auto HeadlessWindow::waitForInput() -> void
+{
+}
+
+auto HeadlessWindow::waitForInput(std::chrono::duration<double>) -> void
+{
+}
+
+auto HeadlessWindow::close() noexcept -> void
+{
+    _shouldClose = true;
+}
+
+}
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <source_location>
 #include <span>
 #include <string>
@@ -73,6 +74,7 @@ auto FileLogger::instance() -> FileLogger&
 
 auto FileLogger::log(Level level, std::string_view message, const std::source_location& location) -> void
 {
+    const auto lock = std::lock_guard {_mutex};
     if (!_isStarted)
     {
         return;
@@ -128,6 +130,7 @@ auto FileLogger::start() -> void
 
 auto FileLogger::stop() -> void
 {
+    const auto lock = std::lock_guard {_mutex};
     _isStarted = false;
     flush();
 }
@@ -17,6 +17,8 @@ auto Camera::setOrthographicProjection(const projection::Orthographic& projectio
     _projectionMatrix[3][0] = -(projection.right + projection.left) / (projection.right - projection.left);
     _projectionMatrix[3][1] = -(projection.bottom + projection.top) / (projection.bottom - projection.top);
     _projectionMatrix[3][2] = -projection.near / (projection.far - projection.near);
+    _near = projection.near;
+    _far = projection.far;
 }
 
 auto Camera::setPerspectiveProjection(const projection::Perspective& projection) -> void
@@ -28,6 +30,8 @@ auto Camera::setPerspectiveProjection(const projection::Perspective& projection)
     _projectionMatrix[2][2] = projection.far / (projection.far - projection.near);
     _projectionMatrix[2][3] = 1.F;
     _projectionMatrix[3][2] = -(projection.far * projection.near) / (projection.far - projection.near);
+    _near = projection.near;
+    _far = projection.far;
 }
 
 auto Camera::getProjection() const noexcept -> const glm::mat4&
@@ -132,4 +136,14 @@ auto Camera::getInverseView() const noexcept -> const glm::mat4&
     return _inverseViewMatrix;
 }
 
+auto Camera::getNear() const noexcept -> float
+{
+    return _near;
+}
+
+auto Camera::getFar() const noexcept -> float
+{
+    return _far;
+}
+
 }
@@ -135,6 +135,11 @@ auto Buffer::getCurrentOffset() const noexcept -> vk::DeviceSize
     return _currentOffset;
 }
 
+auto Buffer::getMappedMemory() const noexcept -> void*
+{
+    return _mappedMemory;
+}
+
 auto Buffer::getDescriptorInfo() const noexcept -> vk::DescriptorBufferInfo
 {
     return getDescriptorInfoAt(size, 0);
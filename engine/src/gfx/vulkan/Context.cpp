@@ -13,7 +13,9 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <span>
@@ -32,16 +34,32 @@
 #include "panda/Window.h"
 #include "panda/gfx/Camera.h"
 #include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
 #include "panda/gfx/vulkan/Descriptor.h"
 #include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/DynamicResolution.h"
+#include "panda/gfx/vulkan/FrameCapture.h"
 #include "panda/gfx/vulkan/FrameInfo.h"
+#include "panda/gfx/vulkan/RedrawTracker.h"
+#include "panda/gfx/vulkan/RenderGraph.h"
 #include "panda/gfx/vulkan/Renderer.h"
 #include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/SecondaryCommandRecorder.h"
+#include "panda/gfx/vulkan/TextureStreamer.h"
+#include "panda/gfx/vulkan/UniformRingAllocator.h"
 #include "panda/gfx/vulkan/object/Mesh.h"
 #include "panda/gfx/vulkan/object/Texture.h"
+#include "panda/gfx/vulkan/systems/DeferredLightingSystem.h"
 #include "panda/gfx/vulkan/systems/InstancedRenderSystem.h"
+#include "panda/gfx/vulkan/systems/LightCullingSystem.h"
 #include "panda/gfx/vulkan/systems/LightSystem.h"
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
 #include "panda/gfx/vulkan/systems/RenderSystem.h"
+#include "panda/gfx/vulkan/systems/SoftwareOcclusionSystem.h"
+#include "panda/gfx/vulkan/systems/StaticBatchSystem.h"
+#include "panda/gfx/vulkan/systems/UpscaleSystem.h"
+#include "panda/utils/FrameLimiter.h"
+#include "panda/utils/JobSystem.h"
 #include "panda/utils/Signal.h"
 #include "panda/utils/Signals.h"
 #include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
@@ -85,12 +103,20 @@ auto imGuiCallback(VkResult result) -> void
 
 }
 
-Context::Context(const Window& window, const std::optional<size_t>& instancedObjectsCount, bool useSingleRendering)
+Context::Context(const Window& window, const ContextConfig& config)
     : _instance {createInstance(window)},
+      _framesInFlight {std::max(config.framesInFlight, size_t {1})},
+      _useDepthPrepass {config.useDepthPrepass},
+      _useLateLatching {config.useLateLatching && config.shadingMode == ShadingMode::Forward},
       _window {window}
 {
     VULKAN_HPP_DEFAULT_DISPATCHER.init(*_instance);
 
+    if (config.useLateLatching && !_useLateLatching)
+    {
+        log::Warning("Late latching is only supported with forward shading, it will be disabled");
+    }
+
     if constexpr (shouldEnableValidationLayers())
     {
         _debugMessenger = expect(_instance->createDebugUtilsMessengerEXT(debugMessengerCreateInfo),
@@ -99,64 +125,172 @@ Context::Context(const Window& window, const std::optional<size_t>& instancedObj
         log::Info("Debug messenger is created");
     }
     _surface = _window.createSurface(*_instance);
-    log::Info("Created surface successfully");
+    if (_surface)
+    {
+        log::Info("Created surface successfully");
+    }
+    else
+    {
+        log::Info("Window has no surface, rendering headless");
+    }
 
     if constexpr (shouldEnableValidationLayers())
     {
-        _device = std::make_unique<Device>(*_instance, _surface, requiredDeviceExtensions, _requiredValidationLayers);
+        _device =
+            std::make_unique<Device>(*_instance, _surface, getRequiredDeviceExtensions(), _requiredValidationLayers);
     }
     else
     {
-        _device = std::make_unique<Device>(*_instance, _surface, requiredDeviceExtensions);
+        _device = std::make_unique<Device>(*_instance, _surface, getRequiredDeviceExtensions());
     }
     log::Info("Created device successfully");
     log::Info("Chosen GPU: {}", std::string_view {_device->physicalDevice.getProperties().deviceName});
 
     VULKAN_HPP_DEFAULT_DISPATCHER.init(_device->logicalDevice);
 
-    _renderer = std::make_unique<Renderer>(window, *_device, _surface);
+    _deletionQueue = std::make_unique<DeletionQueue>(_framesInFlight);
+    _jobSystem = std::make_unique<utils::JobSystem>();
+    _textureStreamer =
+        std::make_unique<TextureStreamer>(*_deletionQueue, TextureStreamer::getDefaultBudget(*_device));
+
+    _renderer = std::make_unique<Renderer>(window,
+                                           *_device,
+                                           *_deletionQueue,
+                                           _surface,
+                                           config.shadingMode,
+                                           config.dynamicResolution.has_value()
+                                               ? std::optional {config.dynamicResolution->maxScale}
+                                               : std::nullopt,
+                                           SwapChainConfig {.framesInFlight = _framesInFlight,
+                                                            .presentMode = config.presentMode,
+                                                            .imageCount = config.swapChainImageCount,
+                                                            .allowCapture = config.frameCapture.has_value()});
+
+    if (config.frameCapture.has_value())
+    {
+        if (_renderer->isCaptureSupported() && FrameCapture::isFormatSupported(_renderer->getImageFormat()))
+        {
+            _frameCapture = std::make_unique<FrameCapture>(*_device, *config.frameCapture);
+        }
+        else
+        {
+            log::Warning("Swapchain images can't be captured, frame capture will be disabled");
+        }
+    }
 
-    _uboFragBuffers.reserve(maxFramesInFlight);
-    _uboVertBuffers.reserve(maxFramesInFlight);
+    if (config.useParallelRecording || config.useStaticCommandBuffers)
+    {
+        _commandRecorder = std::make_unique<SecondaryCommandRecorder>(*_device, *_jobSystem, _framesInFlight);
+    }
+
+    _uniformAllocator = std::make_unique<UniformRingAllocator>(*_device, uniformFrameSize, _framesInFlight);
+    _renderGraph = std::make_unique<RenderGraph>();
 
-    for (auto i = uint32_t {}; i < maxFramesInFlight; i++)
+    if (config.useClusteredLighting)
     {
-        _uboFragBuffers.push_back(std::make_unique<Buffer>(
-            *_device,
-            sizeof(FragUbo),
-            1,
-            vk::BufferUsageFlagBits::eUniformBuffer,
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            _device->physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment));
-        _uboFragBuffers.back()->mapWhole();
+        _lightCullingSystem = std::make_unique<LightCullingSystem>(*_device, _framesInFlight);
+    }
 
-        _uboVertBuffers.push_back(std::make_unique<Buffer>(
-            *_device,
-            sizeof(VertUbo),
-            1,
-            vk::BufferUsageFlagBits::eUniformBuffer,
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            _device->physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment));
-        _uboVertBuffers.back()->mapWhole();
+    if (config.useOcclusionCulling)
+    {
+        _occlusionCullingSystem = std::make_unique<OcclusionCullingSystem>(*_device, *_deletionQueue, _framesInFlight);
+    }
+
+    if (config.useSoftwareOcclusion)
+    {
+        _softwareOcclusionSystem =
+            std::make_unique<SoftwareOcclusionSystem>(*_jobSystem, _useLateLatching ? lateLatchFrustumMargin : 0.F);
     }
 
-    if (useSingleRendering)
+    if (config.useStaticBatching)
     {
-        _renderSystem = std::make_unique<RenderSystem>(*_device, _renderer->getSwapChainRenderPass());
+        _staticBatchSystem = std::make_unique<StaticBatchSystem>(*_device, *_deletionQueue, config.useDepthPrepass);
     }
 
-    if (instancedObjectsCount.has_value())
+    const auto* forwardLightCullingSystem =
+        config.shadingMode == ShadingMode::Forward ? _lightCullingSystem.get() : nullptr;
+
+    if (config.instancedObjectsCount.has_value())
     {
+        // Culled instance groups are drawn indirectly with a nonzero firstInstance
+        auto* instanceCullingSystem =
+            _device->supportsDrawIndirectFirstInstance ? _occlusionCullingSystem.get() : nullptr;
+        if (_occlusionCullingSystem != nullptr && instanceCullingSystem == nullptr)
+        {
+            log::Warning("Device doesn't support drawIndirectFirstInstance, instances won't be occlusion culled");
+        }
+
         _instancedRenderSystem = std::make_unique<InstancedRenderSystem>(*_device,
+                                                                         *_deletionQueue,
+                                                                         *_jobSystem,
                                                                          _renderer->getSwapChainRenderPass(),
-                                                                         instancedObjectsCount.value());
+                                                                         _framesInFlight,
+                                                                         config.instancedObjectsCount.value(),
+                                                                         config.shadingMode,
+                                                                         forwardLightCullingSystem,
+                                                                         config.useDepthPrepass,
+                                                                         instanceCullingSystem,
+                                                                         config.useAutoInstancing);
+    }
+
+    if (config.useSingleRendering)
+    {
+        _renderSystem = std::make_unique<RenderSystem>(*_device,
+                                                       *_deletionQueue,
+                                                       *_jobSystem,
+                                                       _renderer->getSwapChainRenderPass(),
+                                                       _framesInFlight,
+                                                       config.shadingMode,
+                                                       forwardLightCullingSystem,
+                                                       config.useDepthPrepass,
+                                                       _occlusionCullingSystem.get(),
+                                                       _softwareOcclusionSystem.get(),
+                                                       config.useStaticCommandBuffers,
+                                                       _staticBatchSystem.get(),
+                                                       _instancedRenderSystem.get());
     }
 
-    _pointLightSystem = std::make_unique<LightSystem>(*_device, _renderer->getSwapChainRenderPass());
+    if (config.shadingMode == ShadingMode::Deferred)
+    {
+        _deferredLightingSystem = std::make_unique<DeferredLightingSystem>(*_device,
+                                                                           _renderer->getSwapChainRenderPass(),
+                                                                           _lightCullingSystem.get());
+    }
+
+    _pointLightSystem =
+        std::make_unique<LightSystem>(*_device, _renderer->getSwapChainRenderPass(), config.shadingMode);
+
+    if (config.dynamicResolution.has_value())
+    {
+        _dynamicResolution =
+            std::make_unique<DynamicResolution>(*_device, _framesInFlight, config.dynamicResolution.value());
+        _upscaleSystem = std::make_unique<UpscaleSystem>(
+            *_device, _renderer->getPresentRenderPass(), config.dynamicResolution->sharpness);
+    }
+
+    if (config.useOnDemandRendering)
+    {
+        _redrawTracker = std::make_unique<RedrawTracker>(_framesInFlight);
+        _frameBufferResizedReceiver = utils::signals::frameBufferResized.connect([this](auto data) {
+            if (data.id == _window.getId())
+            {
+                requestRedraw();
+            }
+        });
+    }
+
+    if (config.maxFrameRate.has_value())
+    {
+        _frameLimiter = std::make_unique<utils::FrameLimiter>(config.maxFrameRate.value());
+    }
 
     log::Info("Vulkan API has been successfully initialized");
 
-    initializeImGui();
+    // Headless windows don't create a GUI context, there is nothing to draw it to
+    if (!_renderer->isHeadless())
+    {
+        initializeImGui();
+    }
 }
 
 Context::~Context() noexcept
@@ -165,7 +299,10 @@ Context::~Context() noexcept
 
     shouldBe(_device->logicalDevice.waitIdle(), vk::Result::eSuccess, "Wait idle didn't succeed");
 
-    ImGui_ImplVulkan_Shutdown();
+    if (!_renderer->isHeadless())
+    {
+        ImGui_ImplVulkan_Shutdown();
+    }
 
     if constexpr (shouldEnableValidationLayers())
     {
@@ -302,16 +439,47 @@ auto Context::areValidationLayersSupported() const -> bool
     return true;
 }
 
+auto Context::getRequiredDeviceExtensions() const noexcept -> std::span<const char* const>
+{
+    if (_surface)
+    {
+        return requiredDeviceExtensions;
+    }
+    return headlessDeviceExtensions;
+}
+
 auto Context::makeFrame(float deltaTime, Scene& scene) const -> void
 {
+    if (_frameLimiter != nullptr)
+    {
+        _frameLimiter->wait();
+    }
+
     const auto commandBuffer = _renderer->beginFrame();
     if (!commandBuffer)
     {
         return;
     }
 
+    if (_softwareOcclusionSystem != nullptr)
+    {
+        _softwareOcclusionSystem->beginCulling(scene);
+    }
+
     const auto frameIndex = _renderer->getFrameIndex();
 
+    if (_dynamicResolution != nullptr)
+    {
+        _dynamicResolution->beginFrame(commandBuffer, frameIndex);
+        _renderer->setRenderScale(_dynamicResolution->getScale());
+    }
+
+    const auto renderExtent = _renderer->getRenderExtent();
+
+    _deletionQueue->beginFrame(frameIndex);
+    _uniformAllocator->beginFrame(frameIndex);
+    _textureStreamer->update(commandBuffer, scene, renderExtent);
+
     const auto vertUbo = VertUbo {
         .projection = scene.getCamera().getProjection(),
         .view = scene.getCamera().getView(),
@@ -328,43 +496,335 @@ auto Context::makeFrame(float deltaTime, Scene& scene) const -> void
     };
 
     LightSystem::update(scene.getLights(), fragUbo);
-    _uboVertBuffers[frameIndex]->writeAt(vertUbo, 0);
-    _uboFragBuffers[frameIndex]->writeAt(fragUbo, 0);
-    _renderer->beginSwapChainRenderPass();
+
+    const auto fragUboAllocation = _uniformAllocator->allocateAndWrite(fragUbo);
+    const auto vertUboAllocation = _uniformAllocator->allocateAndWrite(vertUbo);
+
+    const auto frameInfo = FrameInfo {.scene = scene,
+                                      .uniformAllocator = *_uniformAllocator,
+                                      .fragUbo = fragUboAllocation.descriptorInfo,
+                                      .vertUbo = vertUboAllocation.descriptorInfo,
+                                      .commandBuffer = commandBuffer,
+                                      .frameIndex = frameIndex,
+                                      .deltaTime = deltaTime};
+
+    _renderGraph->beginFrame();
+    const auto depth = _renderGraph->importImage("Depth",
+                                                 _renderer->getDepthImage(),
+                                                 {vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1},
+                                                 {});
+    const auto lightClusters = _renderGraph->importBuffer("LightClusters");
+    const auto culledDraws = _renderGraph->importBuffer("CulledDraws");
+
+    if (_dynamicResolution != nullptr)
+    {
+        _renderGraph->addPass("TimingBegin").setSideEffects().setExecute([this, frameIndex](vk::CommandBuffer buffer) {
+            _dynamicResolution->beginTiming(buffer, frameIndex);
+        });
+    }
+
+    if (_lightCullingSystem != nullptr)
+    {
+        _renderGraph->addPass("LightCulling")
+            .write(lightClusters, {vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite})
+            .setExecute([this, &frameInfo, renderExtent](vk::CommandBuffer) {
+                _lightCullingSystem->cull(frameInfo, renderExtent);
+            });
+    }
+
+    auto& updatePass =
+        _renderGraph->addPass("Update")
+            .write(culledDraws, {vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderWrite})
+            .setSideEffects()
+            .setExecute([this, &frameInfo, &scene](vk::CommandBuffer) {
+                updateSystems(frameInfo, scene);
+            });
+
+    auto& scenePass = _renderGraph->addPass("Scene");
+    scenePass
+        .read(lightClusters, {vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead})
+        .read(culledDraws,
+              {vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader,
+               vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead})
+        .writeAttachment(
+            depth,
+            {vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+             vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+             vk::ImageLayout::eDepthStencilReadOnlyOptimal})
+        .setSideEffects()
+        .setExecute([this, &frameInfo, &scene](vk::CommandBuffer) {
+            renderScene(frameInfo, scene);
+        });
+
+    if (_occlusionCullingSystem != nullptr)
+    {
+        _occlusionCullingSystem->resizePyramid(_renderer->getRenderTargetExtent());
+        const auto pyramid = _renderGraph->importImage(
+            "HiZ",
+            _occlusionCullingSystem->getPyramidImage(),
+            _occlusionCullingSystem->getPyramidRange(),
+            {vk::PipelineStageFlagBits::eComputeShader,
+             vk::AccessFlagBits::eShaderWrite,
+             _occlusionCullingSystem->isPyramidReady() ? vk::ImageLayout::eGeneral : vk::ImageLayout::eUndefined});
+
+        updatePass.read(pyramid,
+                        {vk::PipelineStageFlagBits::eComputeShader,
+                         vk::AccessFlagBits::eShaderRead,
+                         vk::ImageLayout::eGeneral});
+
+        _renderGraph->addPass("HiZ")
+            .read(depth,
+                  {vk::PipelineStageFlagBits::eComputeShader,
+                   vk::AccessFlagBits::eShaderRead,
+                   vk::ImageLayout::eDepthStencilReadOnlyOptimal})
+            .write(pyramid,
+                   {vk::PipelineStageFlagBits::eComputeShader,
+                    vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+                    vk::ImageLayout::eGeneral})
+            .setExecute([this, &frameInfo, renderExtent](vk::CommandBuffer) {
+                _occlusionCullingSystem->buildPyramid(frameInfo, _renderer->getDepthImageView(), renderExtent);
+            });
+    }
+
+    if (_dynamicResolution != nullptr)
+    {
+        _renderGraph->addPass("TimingEnd").setSideEffects().setExecute([this, frameIndex](vk::CommandBuffer buffer) {
+            _dynamicResolution->endTiming(buffer, frameIndex);
+        });
+    }
+
+    if (_renderer->isRenderingOffscreen())
+    {
+        const auto sceneColor = _renderGraph->importImage("SceneColor",
+                                                          _renderer->getSceneColorImage(),
+                                                          {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1},
+                                                          {});
+        scenePass.writeAttachment(sceneColor,
+                                  {vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                   vk::AccessFlagBits::eColorAttachmentWrite,
+                                   vk::ImageLayout::eShaderReadOnlyOptimal});
+
+        _renderGraph->addPass("Upscale")
+            .read(sceneColor,
+                  {vk::PipelineStageFlagBits::eFragmentShader,
+                   vk::AccessFlagBits::eShaderRead,
+                   vk::ImageLayout::eShaderReadOnlyOptimal})
+            .setSideEffects()
+            .setExecute([this, &frameInfo, &scene, renderExtent](vk::CommandBuffer) {
+                _renderer->beginPresentRenderPass();
+                _upscaleSystem->render(
+                    frameInfo, _renderer->getSceneColorView(), renderExtent, _renderer->getRenderTargetExtent());
+                renderGui(frameInfo, scene);
+                _renderer->endPresentRenderPass();
+            });
+    }
+
+    _renderGraph->execute(commandBuffer);
+
+    if (_frameCapture != nullptr)
+    {
+        _frameCapture->capture(commandBuffer, *_renderer);
+    }
+
+    if (_useLateLatching && _cameraLatch)
+    {
+        latchCamera(frameIndex, scene, vertUboAllocation, fragUboAllocation);
+    }
+    _renderer->endFrame();
+
+    if (_redrawTracker != nullptr)
+    {
+        _redrawTracker->frameRendered(scene);
+    }
+}
+
+auto Context::isRedrawRequired(const Scene& scene) const -> bool
+{
+    if (_redrawTracker == nullptr)
+    {
+        return true;
+    }
+    return _redrawTracker->isRedrawRequired(scene) || _textureStreamer->hasPendingUploads();
+}
+
+auto Context::requestRedraw() const -> void
+{
+    if (_redrawTracker != nullptr)
+    {
+        _redrawTracker->requestRedraw();
+    }
+}
+
+auto Context::setCameraLatch(CameraLatch latch) -> void
+{
+    _cameraLatch = std::move(latch);
+}
+
+auto Context::latchCamera(uint32_t frameIndex,
+                          Scene& scene,
+                          const UniformRingAllocator::Allocation& vertUbo,
+                          const UniformRingAllocator::Allocation& fragUbo) const -> void
+{
+    _cameraLatch(scene.getCamera());
+    const auto& camera = scene.getCamera();
+
+    // Uniforms are persistently mapped and coherent, so the recorded commands pick up the camera written here
+    const auto latchedVertUbo = VertUbo {
+        .projection = camera.getProjection(),
+        .view = camera.getView(),
+    };
+    std::memcpy(vertUbo.data, &latchedVertUbo, sizeof(latchedVertUbo));
+    std::memcpy(static_cast<char*>(fragUbo.data) + offsetof(FragUbo, inverseView),
+                &camera.getInverseView(),
+                sizeof(camera.getInverseView()));
+
+    if (_lightCullingSystem != nullptr)
+    {
+        _lightCullingSystem->latchCamera(frameIndex, camera);
+    }
+
+    if (_occlusionCullingSystem != nullptr)
+    {
+        _occlusionCullingSystem->latchCamera(camera);
+    }
+}
+
+auto Context::updateSystems(const FrameInfo& frameInfo, const Scene& scene) const -> void
+{
+    if (_occlusionCullingSystem != nullptr)
+    {
+        _occlusionCullingSystem->update(frameInfo);
+    }
+
+    if (_softwareOcclusionSystem != nullptr)
+    {
+        _softwareOcclusionSystem->finishCulling();
+    }
+
+    if (_staticBatchSystem != nullptr)
+    {
+        _staticBatchSystem->update(frameInfo.commandBuffer, scene);
+    }
 
     if (_instancedRenderSystem != nullptr)
     {
-        _instancedRenderSystem->render(FrameInfo {.scene = scene,
-                                                  .fragUbo = *_uboFragBuffers[frameIndex],
-                                                  .vertUbo = *_uboVertBuffers[frameIndex],
-                                                  .commandBuffer = commandBuffer,
-                                                  .frameIndex = frameIndex,
-                                                  .deltaTime = deltaTime});
+        _instancedRenderSystem->update(frameInfo);
     }
 
     if (_renderSystem != nullptr)
     {
-        _renderSystem->render(FrameInfo {.scene = scene,
-                                         .fragUbo = *_uboFragBuffers[frameIndex],
-                                         .vertUbo = *_uboVertBuffers[frameIndex],
-                                         .commandBuffer = commandBuffer,
-                                         .frameIndex = frameIndex,
-                                         .deltaTime = deltaTime});
+        _renderSystem->update(frameInfo);
     }
+}
 
-    _pointLightSystem->render(FrameInfo {.scene = scene,
-                                         .fragUbo = *_uboFragBuffers[frameIndex],
-                                         .vertUbo = *_uboVertBuffers[frameIndex],
-                                         .commandBuffer = commandBuffer,
-                                         .frameIndex = frameIndex,
-                                         .deltaTime = deltaTime});
+auto Context::renderScene(const FrameInfo& frameInfo, Scene& scene) const -> void
+{
+    if (_commandRecorder == nullptr)
+    {
+        _renderer->beginSwapChainRenderPass();
+        renderGeometry(frameInfo);
 
-    utils::signals::beginGuiRender.registerSender()(
-        utils::signals::BeginGuiRenderData {.commandBuffer = commandBuffer, .scene = std::ref(scene)});
+        if (_renderSystem != nullptr)
+        {
+            _renderSystem->render(frameInfo);
+        }
+    }
+    else
+    {
+        _renderer->beginSwapChainRenderPass(vk::SubpassContents::eSecondaryCommandBuffers);
+        renderInSecondaryCommandBuffers(frameInfo, scene);
+    }
+
+    if (_deferredLightingSystem != nullptr)
+    {
+        _renderer->nextSubpass();
+        _deferredLightingSystem->render(frameInfo, _renderer->getGBuffer(), _renderer->getDepthImageView());
+        renderOverlay(frameInfo, scene);
+    }
+    else if (_commandRecorder == nullptr)
+    {
+        renderOverlay(frameInfo, scene);
+    }
 
     _renderer->endSwapChainRenderPass();
+}
 
-    _renderer->endFrame();
+auto Context::renderGeometry(const FrameInfo& frameInfo) const -> void
+{
+    if (_useDepthPrepass)
+    {
+        if (_instancedRenderSystem != nullptr)
+        {
+            _instancedRenderSystem->renderDepthPrepass(frameInfo);
+        }
+
+        if (_renderSystem != nullptr)
+        {
+            _renderSystem->renderDepthPrepass(frameInfo);
+        }
+    }
+
+    if (_instancedRenderSystem != nullptr)
+    {
+        _instancedRenderSystem->render(frameInfo);
+    }
+}
+
+auto Context::renderOverlay(const FrameInfo& frameInfo, Scene& scene) const -> void
+{
+    _pointLightSystem->render(frameInfo);
+
+    if (!_renderer->isRenderingOffscreen())
+    {
+        renderGui(frameInfo, scene);
+    }
+}
+
+auto Context::renderGui(const FrameInfo& frameInfo, Scene& scene) -> void
+{
+    utils::signals::beginGuiRender.registerSender()(
+        utils::signals::BeginGuiRenderData {.commandBuffer = frameInfo.commandBuffer, .scene = std::ref(scene)});
+}
+
+auto Context::renderInSecondaryCommandBuffers(const FrameInfo& frameInfo, Scene& scene) const -> void
+{
+    _commandRecorder->beginFrame(frameInfo.frameIndex,
+                                 _renderer->getSwapChainRenderPass(),
+                                 _renderer->getCurrentFramebuffer(),
+                                 _renderer->getRenderExtent());
+
+    const auto recordOnCurrentThread = [this, &frameInfo](auto&& render) {
+        return _commandRecorder->record(1, 1, [&frameInfo, &render](vk::CommandBuffer commandBuffer, size_t, size_t) {
+            auto secondaryFrameInfo = frameInfo;
+            secondaryFrameInfo.commandBuffer = commandBuffer;
+            render(secondaryFrameInfo);
+        });
+    };
+
+    auto commandBuffers = recordOnCurrentThread([this](const FrameInfo& secondaryFrameInfo) {
+        renderGeometry(secondaryFrameInfo);
+    });
+
+    if (_renderSystem != nullptr)
+    {
+        std::ranges::copy(_renderSystem->renderParallel(frameInfo, *_commandRecorder),
+                          std::back_inserter(commandBuffers));
+
+        if (const auto staticCommandBuffer = _renderSystem->renderStatic(frameInfo, *_commandRecorder))
+        {
+            commandBuffers.push_back(*staticCommandBuffer);
+        }
+    }
+
+    if (_deferredLightingSystem == nullptr)
+    {
+        std::ranges::copy(recordOnCurrentThread([this, &scene](const FrameInfo& secondaryFrameInfo) {
+                              renderOverlay(secondaryFrameInfo, scene);
+                          }),
+                          std::back_inserter(commandBuffers));
+    }
+
+    frameInfo.commandBuffer.executeCommands(commandBuffers);
 }
 
 auto Context::getDevice() const noexcept -> const Device&
@@ -377,23 +837,120 @@ auto Context::getRenderer() const noexcept -> const Renderer&
     return *_renderer;
 }
 
+auto Context::getFramesInFlight() const noexcept -> size_t
+{
+    return _framesInFlight;
+}
+
+auto Context::getMaxPunctualLights() const noexcept -> size_t
+{
+    return _lightCullingSystem != nullptr ? maxClusteredLights : maxLights;
+}
+
+auto Context::readFrame() const -> std::optional<FrameReadback>
+{
+    return _renderer->readFrame();
+}
+
+auto Context::getTextureStreamer() const noexcept -> const TextureStreamer&
+{
+    return *_textureStreamer;
+}
+
+auto Context::getTextureStreamer() noexcept -> TextureStreamer&
+{
+    return *_textureStreamer;
+}
+
+auto Context::isDepthPrepassEnabled() const noexcept -> bool
+{
+    return _useDepthPrepass;
+}
+
+auto Context::isSoftwareOcclusionEnabled() const noexcept -> bool
+{
+    return _softwareOcclusionSystem != nullptr;
+}
+
+auto Context::isStaticBatchingEnabled() const noexcept -> bool
+{
+    return _staticBatchSystem != nullptr;
+}
+
+auto Context::getSoftwareOcclusionStatistics() const noexcept -> std::optional<SoftwareOcclusionSystem::Statistics>
+{
+    if (_softwareOcclusionSystem == nullptr)
+    {
+        return std::nullopt;
+    }
+    return _softwareOcclusionSystem->getStatistics();
+}
+
+auto Context::getInstancingStatistics() const noexcept -> std::optional<InstancedRenderSystem::Statistics>
+{
+    if (_instancedRenderSystem == nullptr)
+    {
+        return std::nullopt;
+    }
+    return _instancedRenderSystem->getStatistics();
+}
+
+auto Context::getUniformHighWaterMark() const noexcept -> vk::DeviceSize
+{
+    return _uniformAllocator->getHighWaterMark();
+}
+
+auto Context::getRenderGraphStatistics() const noexcept -> const RenderGraph::Statistics&
+{
+    return _renderGraph->getStatistics();
+}
+
+auto Context::getDynamicResolutionStatistics() const noexcept -> std::optional<DynamicResolution::Statistics>
+{
+    if (_dynamicResolution == nullptr)
+    {
+        return std::nullopt;
+    }
+    return _dynamicResolution->getStatistics();
+}
+
+auto Context::getFrameCaptureStatistics() const noexcept -> std::optional<FrameCapture::Statistics>
+{
+    if (_frameCapture == nullptr)
+    {
+        return std::nullopt;
+    }
+    return _frameCapture->getStatistics();
+}
+
+auto Context::getJobSystem() noexcept -> utils::JobSystem&
+{
+    return *_jobSystem;
+}
+
 auto Context::initializeImGui() -> void
 {
     _guiPool = DescriptorPool::Builder(*_device)
-                   .addPoolSize(vk::DescriptorType::eCombinedImageSampler, maxFramesInFlight)
-                   .build(maxFramesInFlight, vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet);
+                   .addPoolSize(vk::DescriptorType::eCombinedImageSampler, static_cast<uint32_t>(_framesInFlight))
+                   .build(static_cast<uint32_t>(_framesInFlight), vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet);
+    const auto minImageCount = static_cast<uint32_t>(std::max(_framesInFlight, size_t {2}));
+    const auto imageCount = static_cast<uint32_t>(std::max(_framesInFlight, _renderer->getImageCount()));
     auto initInfo = ImGui_ImplVulkan_InitInfo {.Instance = *_instance,
                                                .PhysicalDevice = _device->physicalDevice,
                                                .Device = _device->logicalDevice,
                                                .QueueFamily = _device->queueFamilies.graphicsFamily,
                                                .Queue = _device->graphicsQueue,
                                                .DescriptorPool = _guiPool->getHandle(),
-                                               .RenderPass = _renderer->getSwapChainRenderPass(),
-                                               .MinImageCount = maxFramesInFlight,
-                                               .ImageCount = maxFramesInFlight,
+                                               .RenderPass = _renderer->isRenderingOffscreen()
+                                                                 ? _renderer->getPresentRenderPass()
+                                                                 : _renderer->getSwapChainRenderPass(),
+                                               .MinImageCount = minImageCount,
+                                               .ImageCount = imageCount,
                                                .MSAASamples = VK_SAMPLE_COUNT_1_BIT,
-                                               .PipelineCache = {},
-                                               .Subpass = {},
+                                               .PipelineCache = _device->pipelineCache,
+                                               .Subpass = _renderer->isRenderingOffscreen()
+                                                              ? 0
+                                                              : getLightingSubpass(_renderer->getShadingMode()),
                                                .DescriptorPoolSize = {},
                                                .UseDynamicRendering = false,
                                                .PipelineRenderingCreateInfo = {},
@@ -411,6 +968,7 @@ auto Context::registerMesh(std::unique_ptr<Mesh> mesh) -> void
 
 auto Context::registerTexture(std::unique_ptr<Texture> texture) -> void
 {
+    _textureStreamer->addTexture(*texture);
     _textures.push_back(std::move(texture));
 }
 
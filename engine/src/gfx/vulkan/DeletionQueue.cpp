@@ -0,0 +1,53 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/DeletionQueue.h"
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace panda::gfx::vulkan
+{
+
+DeletionQueue::DeletionQueue(size_t framesInFlight)
+    : _deleters(framesInFlight)
+{
+}
+
+DeletionQueue::~DeletionQueue() noexcept
+{
+    flushAll();
+}
+
+auto DeletionQueue::push(std::function<void()> deleter) -> void
+{
+    _deleters[_frameIndex].push_back(std::move(deleter));
+}
+
+auto DeletionQueue::beginFrame(size_t frameIndex) -> void
+{
+    _frameIndex = frameIndex % _deleters.size();
+
+    for (const auto& deleter : _deleters[_frameIndex])
+    {
+        deleter();
+    }
+    _deleters[_frameIndex].clear();
+}
+
+auto DeletionQueue::flushAll() -> void
+{
+    for (auto& frameDeleters : _deleters)
+    {
+        for (const auto& deleter : frameDeleters)
+        {
+            deleter();
+        }
+        frameDeleters.clear();
+    }
+}
+
+}
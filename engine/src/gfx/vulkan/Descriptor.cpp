@@ -180,9 +180,11 @@ auto DescriptorWriter::writeImage(uint32_t binding, const vk::DescriptorImageInf
     return *this;
 }
 
-auto DescriptorWriter::push(vk::CommandBuffer commandBuffer, vk::PipelineLayout layout) -> void
+auto DescriptorWriter::push(vk::CommandBuffer commandBuffer,
+                            vk::PipelineLayout layout,
+                            vk::PipelineBindPoint bindPoint) -> void
 {
-    commandBuffer.pushDescriptorSetKHR(vk::PipelineBindPoint::eGraphics, layout, 0, _writes);
+    commandBuffer.pushDescriptorSetKHR(bindPoint, layout, 0, _writes);
 }
 
 }
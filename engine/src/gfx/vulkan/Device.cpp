@@ -1,15 +1,24 @@
 // clang-format off
+#include "panda/internal/config.h"
 #include "panda/utils/Assert.h"
 // clang-format on
 
 #include "panda/gfx/vulkan/Device.h"
 
+#include <fmt/format.h>
+
 #include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
 #include <iterator>
 #include <optional>
 #include <span>
 #include <string_view>
+#include <system_error>
 #include <unordered_set>
 #include <vector>
 #include <vulkan/vulkan.hpp>
@@ -29,13 +38,19 @@ Device::Device(const vk::Instance& instance,
                std::span<const char* const> requiredValidationLayers)
     : physicalDevice {pickPhysicalDevice(instance, surface, requiredExtensions)},
       queueFamilies {expect(findQueueFamilies(physicalDevice, surface), "Queue families need to exist")},
-      logicalDevice {createLogicalDevice(physicalDevice, queueFamilies, requiredExtensions, requiredValidationLayers)},
+      supportsDrawIndirectFirstInstance {isDrawIndirectFirstInstanceSupported(physicalDevice)},
+      logicalDevice {createLogicalDevice(physicalDevice,
+                                         queueFamilies,
+                                         supportsDrawIndirectFirstInstance,
+                                         requiredExtensions,
+                                         requiredValidationLayers)},
       graphicsQueue {logicalDevice.getQueue(queueFamilies.graphicsFamily, 0)},
       presentationQueue {logicalDevice.getQueue(queueFamilies.presentationFamily, 0)},
       commandPool {expect(logicalDevice.createCommandPool(
                               {vk::CommandPoolCreateFlagBits::eResetCommandBuffer, queueFamilies.graphicsFamily}),
                           vk::Result::eSuccess,
                           "Can't create command pool")},
+      pipelineCache {createPipelineCache(physicalDevice, logicalDevice, config::pipelineCachePath)},
       _surface {surface}
 {
 }
@@ -60,11 +75,27 @@ auto Device::isDeviceSuitable(vk::PhysicalDevice device,
                               std::span<const char* const> requiredExtensions) -> bool
 {
     const auto queueFamilies = findQueueFamilies(device, surface);
-    const auto swapChainSupport = querySwapChainSupport(device, surface);
 
-    return queueFamilies && checkDeviceExtensionSupport(device, requiredExtensions) &&
-           !swapChainSupport.formats.empty() && !swapChainSupport.presentationModes.empty() &&
-           device.getFeatures().samplerAnisotropy > 0;
+    // Headless devices never present, so they don't need any swapchain support
+    const auto isPresentationSupported = !surface || [device, surface] {
+        const auto swapChainSupport = querySwapChainSupport(device, surface);
+        return !swapChainSupport.formats.empty() && !swapChainSupport.presentationModes.empty();
+    }();
+
+    return queueFamilies && checkDeviceExtensionSupport(device, requiredExtensions) && isPresentationSupported &&
+           device.getFeatures().samplerAnisotropy > 0 && areTimelineSemaphoresSupported(device);
+}
+
+auto Device::areTimelineSemaphoresSupported(vk::PhysicalDevice device) -> bool
+{
+    const auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+    return features.get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore == vk::True;
+}
+
+auto Device::isDrawIndirectFirstInstanceSupported(vk::PhysicalDevice device) -> bool
+{
+    const auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2>();
+    return features.get<vk::PhysicalDeviceFeatures2>().features.drawIndirectFirstInstance == vk::True;
 }
 
 auto Device::findQueueFamilies(vk::PhysicalDevice device, vk::SurfaceKHR surface) -> std::optional<QueueFamilies>
@@ -83,7 +114,8 @@ auto Device::findQueueFamilies(vk::PhysicalDevice device, vk::SurfaceKHR surface
             queueFamilyIndices.graphicsFamily = i;
             isGraphicsSet = true;
         }
-        if (device.getSurfaceSupportKHR(i, surface).value != 0)
+        // Without a surface nothing is presented, the graphics queue only stands in for the presentation one
+        if (surface ? device.getSurfaceSupportKHR(i, surface).value != 0 : isGraphicsSet)
         {
             log::Info("Presentation queue index: {}", i);
             queueFamilyIndices.presentationFamily = i;
@@ -135,6 +167,7 @@ auto Device::checkDeviceExtensionSupport(vk::PhysicalDevice device, std::span<co
 
 auto Device::createLogicalDevice(vk::PhysicalDevice device,
                                  const QueueFamilies& queueFamilies,
+                                 bool enableDrawIndirectFirstInstance,
                                  std::span<const char* const> requiredExtensions,
                                  std::span<const char* const> requiredValidationLayers) -> vk::Device
 {
@@ -150,14 +183,19 @@ auto Device::createLogicalDevice(vk::PhysicalDevice device,
                                return vk::DeviceQueueCreateInfo {{}, queueFamily, 1, &queuePriority};
                            });
 
-    const auto physicalDeviceFeatures = vk::PhysicalDeviceFeatures {{}, {}, {}, {}, {}, {}, {}, {}, {}, {},
-                                                                    {}, {}, {}, {}, {}, {}, {}, {}, {}, vk::True};
+    auto physicalDeviceFeatures = vk::PhysicalDeviceFeatures {};
+    physicalDeviceFeatures.samplerAnisotropy = vk::True;
+    physicalDeviceFeatures.drawIndirectFirstInstance = enableDrawIndirectFirstInstance ? vk::True : vk::False;
+
+    auto vulkan12Features = vk::PhysicalDeviceVulkan12Features {};
+    vulkan12Features.timelineSemaphore = vk::True;
 
     auto createInfo = vk::DeviceCreateInfo({},
                                            queueCreateInfos,
                                            requiredValidationLayers,
                                            requiredExtensions,
-                                           &physicalDeviceFeatures);
+                                           &physicalDeviceFeatures,
+                                           &vulkan12Features);
 
     return expect(device.createDevice(createInfo), vk::Result::eSuccess, "Can't create physical device");
 }
@@ -170,10 +208,86 @@ auto Device::querySwapChainSupport() const -> SwapChainSupportDetails
 Device::~Device() noexcept
 {
     log::Info("Destroying device");
+    savePipelineCache(config::pipelineCachePath);
+    logicalDevice.destroy(pipelineCache);
     logicalDevice.destroy(commandPool);
     logicalDevice.destroy();
 }
 
+auto Device::createPipelineCache(vk::PhysicalDevice device,
+                                 vk::Device logicalDevice,
+                                 const std::filesystem::path& path) -> vk::PipelineCache
+{
+    auto data = std::vector<uint8_t> {};
+
+    if (auto fin = std::ifstream(path, std::ios::ate | std::ios::binary); fin.is_open())
+    {
+        data.resize(static_cast<size_t>(fin.tellg()));
+        fin.seekg(0);
+        fin.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        if (!isPipelineCacheCompatible(device, data))
+        {
+            log::Warning("Pipeline cache {} doesn't match current device, it will be rebuilt", path.string());
+            data.clear();
+        }
+        else
+        {
+            log::Info("Loaded pipeline cache {} ({} bytes)", path.string(), data.size());
+        }
+    }
+
+    const auto createInfo = vk::PipelineCacheCreateInfo {{}, data.size(), data.data()};
+    return expect(logicalDevice.createPipelineCache(createInfo),
+                  vk::Result::eSuccess,
+                  "Can't create pipeline cache");
+}
+
+auto Device::isPipelineCacheCompatible(vk::PhysicalDevice device, std::span<const uint8_t> data) -> bool
+{
+    auto header = vk::PipelineCacheHeaderVersionOne {};
+    if (data.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    const auto properties = device.getProperties();
+
+    return header.headerSize >= sizeof(header) && header.headerVersion == vk::PipelineCacheHeaderVersion::eOne &&
+           header.vendorID == properties.vendorID && header.deviceID == properties.deviceID &&
+           header.pipelineCacheUUID == properties.pipelineCacheUUID;
+}
+
+auto Device::savePipelineCache(const std::filesystem::path& path) const -> void
+{
+    const auto data = logicalDevice.getPipelineCacheData(pipelineCache);
+    if (!shouldBe(data.result, vk::Result::eSuccess, "Can't get pipeline cache data"))
+    {
+        return;
+    }
+
+    const auto temporaryPath = std::filesystem::path {path}.concat(".tmp");
+    {
+        auto fout = std::ofstream(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!fout.is_open())
+        {
+            log::Warning("Can't open {} to save pipeline cache", temporaryPath.string());
+            return;
+        }
+        fout.write(reinterpret_cast<const char*>(data.value.data()), static_cast<std::streamsize>(data.value.size()));
+    }
+
+    auto error = std::error_code {};
+    std::filesystem::rename(temporaryPath, path, error);
+    if (!shouldBe(!error, fmt::format("Can't save pipeline cache to {}: {}", path.string(), error.message())))
+    {
+        return;
+    }
+
+    log::Info("Saved pipeline cache {} ({} bytes)", path.string(), data.value.size());
+}
+
 auto Device::findSupportedFormat(std::span<const vk::Format> candidates,
                                  vk::ImageTiling tiling,
                                  vk::FormatFeatureFlags features) const noexcept -> std::optional<vk::Format>
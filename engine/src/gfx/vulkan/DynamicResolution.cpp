@@ -0,0 +1,170 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Logger.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+constexpr auto queriesPerFrame = uint32_t {2};
+constexpr auto nanosecondsPerMillisecond = 1'000'000.F;
+
+auto getTimestampValidBits(const Device& device) -> uint32_t
+{
+    return device.physicalDevice.getQueueFamilyProperties()[device.queueFamilies.graphicsFamily].timestampValidBits;
+}
+
+}
+
+DynamicResolution::DynamicResolution(const Device& device,
+                                     size_t framesInFlight,
+                                     const DynamicResolutionConfig& config)
+    : _device {device},
+      _config {config},
+      _timestampPeriod {device.physicalDevice.getProperties().limits.timestampPeriod},
+      _timestampMask {getTimestampValidBits(device) >= 64 ? ~uint64_t {}
+                                                          : (uint64_t {1} << getTimestampValidBits(device)) - 1},
+      _isSupported {device.physicalDevice.getProperties().limits.timestampComputeAndGraphics == vk::True &&
+                    getTimestampValidBits(device) > 0},
+      _hasPendingQueries(framesInFlight, false),
+      _scale {config.maxScale}
+{
+    expect(_config.minScale > 0.F && _config.minScale <= _config.maxScale,
+           "Dynamic resolution scale bounds are invalid");
+
+    if (!_isSupported)
+    {
+        log::Warning("GPU timestamps are not supported, dynamic resolution stays at scale {}", _scale);
+        return;
+    }
+
+    const auto queryPoolInfo = vk::QueryPoolCreateInfo {{},
+                                                        vk::QueryType::eTimestamp,
+                                                        static_cast<uint32_t>(framesInFlight) * queriesPerFrame};
+    _queryPool = expect(_device.logicalDevice.createQueryPool(queryPoolInfo),
+                        vk::Result::eSuccess,
+                        "Can't create timestamp query pool");
+}
+
+DynamicResolution::~DynamicResolution() noexcept
+{
+    _device.logicalDevice.destroy(_queryPool);
+}
+
+auto DynamicResolution::beginFrame(vk::CommandBuffer commandBuffer, uint32_t frameIndex) -> void
+{
+    if (!_isSupported)
+    {
+        return;
+    }
+
+    if (readFrameTime(frameIndex))
+    {
+        updateScale();
+    }
+
+    commandBuffer.resetQueryPool(_queryPool, frameIndex * queriesPerFrame, queriesPerFrame);
+    _hasPendingQueries[frameIndex] = false;
+}
+
+auto DynamicResolution::beginTiming(vk::CommandBuffer commandBuffer, uint32_t frameIndex) const -> void
+{
+    if (!_isSupported)
+    {
+        return;
+    }
+
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, _queryPool, frameIndex * queriesPerFrame);
+}
+
+auto DynamicResolution::endTiming(vk::CommandBuffer commandBuffer, uint32_t frameIndex) -> void
+{
+    if (!_isSupported)
+    {
+        return;
+    }
+
+    commandBuffer.writeTimestamp(
+        vk::PipelineStageFlagBits::eBottomOfPipe, _queryPool, frameIndex * queriesPerFrame + 1);
+    _hasPendingQueries[frameIndex] = true;
+}
+
+auto DynamicResolution::readFrameTime(uint32_t frameIndex) -> bool
+{
+    if (!_hasPendingQueries[frameIndex])
+    {
+        return false;
+    }
+
+    const auto [result, timestamps] = _device.logicalDevice.getQueryPoolResults<uint64_t>(
+        _queryPool,
+        frameIndex * queriesPerFrame,
+        queriesPerFrame,
+        queriesPerFrame * sizeof(uint64_t),
+        sizeof(uint64_t),
+        vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess)
+    {
+        return false;
+    }
+
+    const auto elapsedTicks = (timestamps[1] - timestamps[0]) & _timestampMask;
+    _gpuFrameTime = static_cast<float>(elapsedTicks) * _timestampPeriod / nanosecondsPerMillisecond;
+    _averageFrameTime = _averageFrameTime == 0.F
+                            ? _gpuFrameTime
+                            : _averageFrameTime + (_gpuFrameTime - _averageFrameTime) * frameTimeSmoothing;
+    return true;
+}
+
+auto DynamicResolution::updateScale() -> void
+{
+    if (_averageFrameTime <= 0.F)
+    {
+        return;
+    }
+
+    // Pixel cost grows with the square of the scale, so the ratio of frame times is corrected by its square root
+    const auto desiredScale = std::clamp(_scale * std::sqrt(_config.targetFrameTime / _averageFrameTime),
+                                         _config.minScale,
+                                         _config.maxScale);
+
+    if (std::abs(desiredScale - _scale) < scaleStep)
+    {
+        return;
+    }
+
+    _scale = std::clamp(std::round(desiredScale / scaleStep) * scaleStep, _config.minScale, _config.maxScale);
+}
+
+auto DynamicResolution::getScale() const noexcept -> float
+{
+    return _scale;
+}
+
+auto DynamicResolution::getConfig() const noexcept -> const DynamicResolutionConfig&
+{
+    return _config;
+}
+
+auto DynamicResolution::getStatistics() const noexcept -> Statistics
+{
+    return {.scale = _scale, .gpuFrameTime = _gpuFrameTime};
+}
+
+}
@@ -0,0 +1,522 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/FrameCapture.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#if !defined(_WIN32)
+#    include <pthread.h>
+#    include <signal.h>
+#endif
+
+#include "panda/Logger.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/Renderer.h"
+#include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+constexpr auto bytesPerPixel = size_t {4};
+constexpr auto maxStoredBlockSize = size_t {65535};
+constexpr auto adlerModulo = uint32_t {65521};
+
+constexpr auto crcTable = [] {
+    auto table = std::array<uint32_t, 256> {};
+    for (auto i = uint32_t {}; i < table.size(); i++)
+    {
+        auto value = i;
+        for (auto bit = 0; bit < 8; bit++)
+        {
+            value = (value & 1U) != 0 ? 0xEDB88320U ^ (value >> 1U) : value >> 1U;
+        }
+        table[i] = value;
+    }
+    return table;
+}();
+
+#if !defined(_WIN32)
+auto getBrokenPipeSignal() -> sigset_t
+{
+    auto signals = sigset_t {};
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    return signals;
+}
+#endif
+
+auto blockBrokenPipeSignal() -> void
+{
+#if !defined(_WIN32)
+    // Writing to a crashed encoder fails with EPIPE on the capture thread instead of killing the whole process,
+    // the signal disposition of the application stays untouched
+    const auto signals = getBrokenPipeSignal();
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+#endif
+}
+
+auto openPipe(const char* command) -> FILE*
+{
+#if defined(_WIN32)
+    return _popen(command, "wb");
+#else
+    // The encoder process shouldn't inherit the signal mask of the capture thread
+    const auto signals = getBrokenPipeSignal();
+    auto previousSignals = sigset_t {};
+    pthread_sigmask(SIG_UNBLOCK, &signals, &previousSignals);
+    auto* pipe = popen(command, "w");
+    pthread_sigmask(SIG_SETMASK, &previousSignals, nullptr);
+    return pipe;
+#endif
+}
+
+auto closePipe(FILE* pipe) -> int
+{
+#if defined(_WIN32)
+    return _pclose(pipe);
+#else
+    return pclose(pipe);
+#endif
+}
+
+auto isBgra(vk::Format format) noexcept -> bool
+{
+    return format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+}
+
+auto replaceAll(std::string text, std::string_view pattern, std::string_view replacement) -> std::string
+{
+    for (auto position = text.find(pattern); position != std::string::npos;
+         position = text.find(pattern, position + replacement.size()))
+    {
+        text.replace(position, pattern.size(), replacement);
+    }
+    return text;
+}
+
+auto appendBigEndian(std::vector<uint8_t>& data, uint32_t value) -> void
+{
+    for (auto shift = 24; shift >= 0; shift -= 8)
+    {
+        data.push_back(static_cast<uint8_t>(value >> static_cast<uint32_t>(shift)));
+    }
+}
+
+auto appendChunk(std::vector<uint8_t>& png, std::string_view type, std::span<const uint8_t> payload) -> void
+{
+    appendBigEndian(png, static_cast<uint32_t>(payload.size()));
+
+    const auto typeOffset = png.size();
+    png.insert(png.end(), type.begin(), type.end());
+    png.insert(png.end(), payload.begin(), payload.end());
+
+    auto crc = 0xFFFFFFFFU;
+    for (auto i = typeOffset; i < png.size(); i++)
+    {
+        crc = crcTable[(crc ^ png[i]) & 0xFFU] ^ (crc >> 8U);
+    }
+    appendBigEndian(png, crc ^ 0xFFFFFFFFU);
+}
+
+// Stored deflate blocks keep the writer dependency free, long recordings are expected to go through the encoder
+auto deflateStored(std::span<const uint8_t> data) -> std::vector<uint8_t>
+{
+    const auto blockCount = std::max((data.size() + maxStoredBlockSize - 1) / maxStoredBlockSize, size_t {1});
+
+    auto result = std::vector<uint8_t> {0x78, 0x01};
+    result.reserve(data.size() + (blockCount * 5) + 6);
+
+    auto adlerLow = uint32_t {1};
+    auto adlerHigh = uint32_t {};
+    for (const auto byte : data)
+    {
+        adlerLow = (adlerLow + byte) % adlerModulo;
+        adlerHigh = (adlerHigh + adlerLow) % adlerModulo;
+    }
+
+    for (auto block = size_t {}; block < blockCount; block++)
+    {
+        const auto offset = block * maxStoredBlockSize;
+        const auto size = static_cast<uint16_t>(std::min(maxStoredBlockSize, data.size() - offset));
+        const auto inverseSize = static_cast<uint16_t>(~size);
+
+        result.push_back(block + 1 == blockCount ? 1 : 0);
+        result.push_back(static_cast<uint8_t>(size & 0xFFU));
+        result.push_back(static_cast<uint8_t>(size >> 8U));
+        result.push_back(static_cast<uint8_t>(inverseSize & 0xFFU));
+        result.push_back(static_cast<uint8_t>(inverseSize >> 8U));
+        const auto blockBegin = data.begin() + static_cast<std::ptrdiff_t>(offset);
+        result.insert(result.end(), blockBegin, blockBegin + size);
+    }
+
+    appendBigEndian(result, (adlerHigh << 16U) | adlerLow);
+    return result;
+}
+
+auto writeFile(const std::filesystem::path& path, std::span<const uint8_t> data) -> bool
+{
+    auto fout = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!fout.is_open())
+    {
+        return false;
+    }
+
+    fout.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return fout.good();
+}
+
+}
+
+FrameCapture::FrameCapture(const Device& device, const FrameCaptureConfig& config)
+    : _device {device},
+      _config {config},
+      _memoryProperties {chooseMemoryProperties(_device)},
+      _slots(std::max(_config.ringSize, size_t {1})),
+      _busySlots(_slots.size(), false),
+      _encoder {nullptr, closePipe},
+      _worker {[this](const std::stop_token& stopToken) {
+          work(stopToken);
+      }}
+{
+    if (_config.format != CaptureFormat::Encoder)
+    {
+        auto error = std::error_code {};
+        std::filesystem::create_directories(_config.outputDirectory, error);
+        if (error)
+        {
+            log::Warning("Can't create capture directory {}: {}", _config.outputDirectory.string(), error.message());
+        }
+    }
+}
+
+FrameCapture::~FrameCapture() noexcept
+{
+    _worker.request_stop();
+    _worker.join();
+
+    log::Info("Frame capture finished, captured frames: {}, dropped frames: {}",
+              _capturedFrames.load(),
+              _droppedFrames.load());
+}
+
+auto FrameCapture::isFormatSupported(vk::Format format) noexcept -> bool
+{
+    return format == vk::Format::eR8G8B8A8Unorm || format == vk::Format::eR8G8B8A8Srgb ||
+           format == vk::Format::eB8G8R8A8Unorm || format == vk::Format::eB8G8R8A8Srgb;
+}
+
+auto FrameCapture::chooseMemoryProperties(const Device& device) -> vk::MemoryPropertyFlags
+{
+    // Reading uncached memory on the CPU is slow, every device has the coherent fallback though
+    const auto cachedProperties = vk::MemoryPropertyFlagBits::eHostVisible |
+                                  vk::MemoryPropertyFlagBits::eHostCoherent | vk::MemoryPropertyFlagBits::eHostCached;
+
+    if (device.findMemoryType(std::numeric_limits<uint32_t>::max(), cachedProperties).has_value())
+    {
+        return cachedProperties;
+    }
+
+    log::Warning("Host cached memory is unavailable, frame readback will be slower");
+    return vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+}
+
+auto FrameCapture::capture(vk::CommandBuffer commandBuffer, const Renderer& renderer) -> void
+{
+    const auto frameNumber = _frameNumber++;
+    const auto slotIndex = acquireSlot();
+    if (!slotIndex.has_value())
+    {
+        // The writer is behind, dropping the frame keeps the render loop from ever waiting for it
+        ++_droppedFrames;
+        return;
+    }
+
+    auto& slot = _slots[*slotIndex];
+    const auto image = renderer.getCurrentImage();
+    const auto layout = renderer.getOutputLayout();
+    slot.extent = renderer.getExtent();
+    slot.format = renderer.getImageFormat();
+    slot.timeline = renderer.getFrameTimeline();
+    slot.timelineValue = renderer.getPendingTimelineValue();
+    slot.frameNumber = frameNumber;
+    reserveBuffer(slot, vk::DeviceSize {slot.extent.width} * slot.extent.height * bytesPerPixel);
+
+    const auto range = vk::ImageSubresourceRange {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1};
+    const auto toTransfer = vk::ImageMemoryBarrier {vk::AccessFlagBits::eColorAttachmentWrite,
+                                                    vk::AccessFlagBits::eTransferRead,
+                                                    layout,
+                                                    vk::ImageLayout::eTransferSrcOptimal,
+                                                    vk::QueueFamilyIgnored,
+                                                    vk::QueueFamilyIgnored,
+                                                    image,
+                                                    range};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                  vk::PipelineStageFlagBits::eTransfer,
+                                  {},
+                                  {},
+                                  {},
+                                  toTransfer);
+
+    const auto region = vk::BufferImageCopy {
+        0,
+        0,
+        0,
+        {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+        {0, 0, 0},
+        {slot.extent.width, slot.extent.height, 1}
+    };
+    commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, slot.buffer->buffer, region);
+
+    const auto toOriginal = vk::ImageMemoryBarrier {vk::AccessFlagBits::eTransferRead,
+                                                    vk::AccessFlagBits::eNone,
+                                                    vk::ImageLayout::eTransferSrcOptimal,
+                                                    layout,
+                                                    vk::QueueFamilyIgnored,
+                                                    vk::QueueFamilyIgnored,
+                                                    image,
+                                                    range};
+    const auto toHost = vk::MemoryBarrier {vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead};
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+                                  vk::PipelineStageFlagBits::eAllCommands | vk::PipelineStageFlagBits::eHost,
+                                  {},
+                                  toHost,
+                                  {},
+                                  toOriginal);
+
+    {
+        const auto lock = std::lock_guard {_mutex};
+        _pendingSlots.push(*slotIndex);
+    }
+    _condition.notify_one();
+}
+
+auto FrameCapture::getStatistics() const noexcept -> Statistics
+{
+    return {.capturedFrames = _capturedFrames.load(), .droppedFrames = _droppedFrames.load()};
+}
+
+auto FrameCapture::acquireSlot() -> std::optional<size_t>
+{
+    const auto lock = std::lock_guard {_mutex};
+    if (_busySlots[_nextSlot])
+    {
+        return {};
+    }
+
+    _busySlots[_nextSlot] = true;
+    return std::exchange(_nextSlot, (_nextSlot + 1) % _slots.size());
+}
+
+auto FrameCapture::reserveBuffer(Slot& slot, vk::DeviceSize size) const -> void
+{
+    if (slot.buffer != nullptr && slot.buffer->size >= size)
+    {
+        return;
+    }
+
+    // A free slot is neither written by the GPU nor read by the writer anymore, so it can be replaced right away
+    slot.buffer = std::make_unique<Buffer>(_device, size, vk::BufferUsageFlagBits::eTransferDst, _memoryProperties);
+    slot.buffer->mapWhole();
+}
+
+auto FrameCapture::work(const std::stop_token& stopToken) -> void
+{
+    blockBrokenPipeSignal();
+
+    while (true)
+    {
+        auto slotIndex = size_t {};
+        {
+            auto lock = std::unique_lock {_mutex};
+
+            // Frames which are already queued when stopping are still written, they have been rendered anyway
+            _condition.wait(lock, stopToken, [this] {
+                return !_pendingSlots.empty();
+            });
+            if (_pendingSlots.empty())
+            {
+                return;
+            }
+
+            slotIndex = _pendingSlots.front();
+            _pendingSlots.pop();
+        }
+
+        if (!waitForSlot(_slots[slotIndex], stopToken))
+        {
+            return;
+        }
+
+        writeFrame(readSlot(slotIndex));
+    }
+}
+
+auto FrameCapture::waitForSlot(const Slot& slot, const std::stop_token& stopToken) const -> bool
+{
+    const auto waitInfo = vk::SemaphoreWaitInfo {{}, slot.timeline, slot.timelineValue};
+
+    while (true)
+    {
+        const auto result = _device.logicalDevice.waitSemaphores(waitInfo, waitTimeout);
+        if (result == vk::Result::eSuccess)
+        {
+            return true;
+        }
+        if (result != vk::Result::eTimeout || stopToken.stop_requested())
+        {
+            log::Warning("Frame {} was never finished, stopping capture: {}", slot.frameNumber, result);
+            return false;
+        }
+    }
+}
+
+auto FrameCapture::readSlot(size_t slotIndex) -> Frame
+{
+    const auto& slot = _slots[slotIndex];
+    const auto shouldSwizzle = isBgra(slot.format);
+
+    auto frame = Frame {.pixels = std::vector<uint8_t>(size_t {slot.extent.width} * slot.extent.height * bytesPerPixel),
+                        .extent = slot.extent,
+                        .frameNumber = slot.frameNumber};
+    std::memcpy(frame.pixels.data(), slot.buffer->getMappedMemory(), frame.pixels.size());
+
+    {
+        const auto lock = std::lock_guard {_mutex};
+        _busySlots[slotIndex] = false;
+    }
+
+    if (shouldSwizzle)
+    {
+        for (auto i = size_t {}; i < frame.pixels.size(); i += bytesPerPixel)
+        {
+            std::swap(frame.pixels[i], frame.pixels[i + 2]);
+        }
+    }
+
+    return frame;
+}
+
+auto FrameCapture::writeFrame(const Frame& frame) -> void
+{
+    auto isWritten = false;
+
+    switch (_config.format)
+    {
+    case CaptureFormat::Png:
+        isWritten = writePng(_config.outputDirectory / fmt::format("frame_{:06}.png", frame.frameNumber), frame);
+        break;
+    case CaptureFormat::Raw:
+        isWritten = writeRaw(_config.outputDirectory / fmt::format("frame_{:06}.rgba", frame.frameNumber), frame);
+        break;
+    case CaptureFormat::Encoder:
+        isWritten = writeToEncoder(frame);
+        break;
+    default:
+        [[unlikely]] break;
+    }
+
+    if (isWritten)
+    {
+        ++_capturedFrames;
+    }
+    else
+    {
+        log::Warning("Failed to write captured frame {}", frame.frameNumber);
+        ++_droppedFrames;
+    }
+}
+
+auto FrameCapture::writePng(const std::filesystem::path& path, const Frame& frame) -> bool
+{
+    const auto rowSize = size_t {frame.extent.width} * bytesPerPixel;
+
+    auto scanlines = std::vector<uint8_t> {};
+    scanlines.reserve((rowSize + 1) * frame.extent.height);
+    for (auto row = size_t {}; row < frame.extent.height; row++)
+    {
+        const auto rowBegin = frame.pixels.begin() + static_cast<std::ptrdiff_t>(row * rowSize);
+        scanlines.push_back(0);
+        scanlines.insert(scanlines.end(), rowBegin, rowBegin + static_cast<std::ptrdiff_t>(rowSize));
+    }
+
+    auto header = std::vector<uint8_t> {};
+    appendBigEndian(header, frame.extent.width);
+    appendBigEndian(header, frame.extent.height);
+    // 8 bits per channel RGBA, deflate, adaptive filtering and no interlacing
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    auto png = std::vector<uint8_t> {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    appendChunk(png, "IHDR", header);
+    appendChunk(png, "IDAT", deflateStored(scanlines));
+    appendChunk(png, "IEND", {});
+
+    return writeFile(path, png);
+}
+
+auto FrameCapture::writeRaw(const std::filesystem::path& path, const Frame& frame) -> bool
+{
+    return writeFile(path, frame.pixels);
+}
+
+auto FrameCapture::writeToEncoder(const Frame& frame) -> bool
+{
+    if (_encoder == nullptr)
+    {
+        const auto command =
+            replaceAll(replaceAll(_config.encoderCommand, "{width}", std::to_string(frame.extent.width)),
+                       "{height}",
+                       std::to_string(frame.extent.height));
+
+        _encoder = EncoderPipe {openPipe(command.c_str()), closePipe};
+        if (_encoder == nullptr)
+        {
+            log::Error("Can't start frame encoder: {}", command);
+            return false;
+        }
+
+        log::Info("Started frame encoder: {}", command);
+        _encoderExtent = frame.extent;
+    }
+
+    // A raw video stream can't change its size, frames rendered after a resize are skipped
+    if (frame.extent != _encoderExtent)
+    {
+        return false;
+    }
+
+    // Once the encoder exits writes fail with EPIPE and the frame is counted as dropped
+    return std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), _encoder.get()) == frame.pixels.size();
+}
+
+}
@@ -4,7 +4,10 @@
 
 #include "panda/gfx/vulkan/Pipeline.h"
 
+#include <fmt/format.h>
+
 #include <array>
+#include <optional>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
@@ -19,6 +22,16 @@
 namespace panda::gfx::vulkan
 {
 
+auto SpecializationConstants::isEmpty() const noexcept -> bool
+{
+    return _entries.empty();
+}
+
+auto SpecializationConstants::getInfo() const noexcept -> vk::SpecializationInfo
+{
+    return vk::SpecializationInfo {static_cast<uint32_t>(_entries.size()), _entries.data(), _data.size(), _data.data()};
+}
+
 Pipeline::Pipeline(const Device& device, const PipelineConfig& config)
     : _pipeline {createPipeline(device, config)},
       _device {device}
@@ -34,7 +47,12 @@ Pipeline::~Pipeline() noexcept
 auto Pipeline::createPipeline(const Device& device, const PipelineConfig& config) -> vk::Pipeline
 {
     const auto vertexShader = Shader::createFromFile(device.logicalDevice, config.vertexShaderPath);
-    const auto fragmentShader = Shader::createFromFile(device.logicalDevice, config.fragmentShaderPath);
+    const auto fragmentShader = config.fragmentShaderPath.empty()
+                                    ? std::optional<Shader> {}
+                                    : Shader::createFromFile(device.logicalDevice, config.fragmentShaderPath);
+
+    const auto vertexSpecializationInfo = config.vertexSpecialization.getInfo();
+    const auto fragmentSpecializationInfo = config.fragmentSpecialization.getInfo();
 
     auto shaderStages = std::vector<vk::PipelineShaderStageCreateInfo> {};
 
@@ -43,14 +61,16 @@ auto Pipeline::createPipeline(const Device& device, const PipelineConfig& config
         shaderStages.emplace_back(vk::PipelineShaderStageCreateFlags {},
                                   vk::ShaderStageFlagBits::eVertex,
                                   vertexShader->module,
-                                  Shader::getEntryPointName());
+                                  Shader::getEntryPointName(),
+                                  config.vertexSpecialization.isEmpty() ? nullptr : &vertexSpecializationInfo);
     }
     if (fragmentShader.has_value())
     {
         shaderStages.emplace_back(vk::PipelineShaderStageCreateFlags {},
                                   vk::ShaderStageFlagBits::eFragment,
                                   fragmentShader->module,
-                                  Shader::getEntryPointName());
+                                  Shader::getEntryPointName(),
+                                  config.fragmentSpecialization.isEmpty() ? nullptr : &fragmentSpecializationInfo);
     }
 
     const auto dynamicStates = std::array {vk::DynamicState::eViewport, vk::DynamicState::eScissor};
@@ -75,7 +95,7 @@ auto Pipeline::createPipeline(const Device& device, const PipelineConfig& config
                                                               config.renderPass,
                                                               config.subpass};
 
-    return expect(device.logicalDevice.createGraphicsPipeline(nullptr, pipelineInfo),
+    return expect(device.logicalDevice.createGraphicsPipeline(device.pipelineCache, pipelineInfo),
                   vk::Result::eSuccess,
                   "Cannot create pipeline");
 }
@@ -85,4 +105,42 @@ auto Pipeline::getHandle() const noexcept -> const vk::Pipeline&
     return _pipeline;
 }
 
+ComputePipeline::ComputePipeline(const Device& device, const ComputePipelineConfig& config)
+    : _pipeline {createPipeline(device, config)},
+      _device {device}
+{
+}
+
+ComputePipeline::~ComputePipeline() noexcept
+{
+    log::Info("Destroying compute pipeline");
+    _device.logicalDevice.destroy(_pipeline);
+}
+
+auto ComputePipeline::createPipeline(const Device& device, const ComputePipelineConfig& config) -> vk::Pipeline
+{
+    const auto shader = Shader::createFromFile(device.logicalDevice, config.shaderPath);
+    expect(shader.has_value(), fmt::format("Cannot load compute shader: {}", config.shaderPath.string()));
+
+    const auto specializationInfo = config.specialization.getInfo();
+
+    const auto shaderStage =
+        vk::PipelineShaderStageCreateInfo {{},
+                                           vk::ShaderStageFlagBits::eCompute,
+                                           shader->module,
+                                           Shader::getEntryPointName(),
+                                           config.specialization.isEmpty() ? nullptr : &specializationInfo};
+
+    const auto pipelineInfo = vk::ComputePipelineCreateInfo {{}, shaderStage, config.pipelineLayout};
+
+    return expect(device.logicalDevice.createComputePipeline(device.pipelineCache, pipelineInfo),
+                  vk::Result::eSuccess,
+                  "Cannot create compute pipeline");
+}
+
+auto ComputePipeline::getHandle() const noexcept -> const vk::Pipeline&
+{
+    return _pipeline;
+}
+
 }
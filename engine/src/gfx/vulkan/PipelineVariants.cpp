@@ -0,0 +1,75 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/PipelineVariants.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include "panda/Logger.h"
+#include "panda/gfx/vulkan/LightCounts.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/utils/JobSystem.h"
+
+namespace panda::gfx::vulkan
+{
+
+PipelineVariants::PipelineVariants(utils::JobSystem& jobSystem, Factory factory)
+    : _jobSystem {jobSystem},
+      _factory {std::move(factory)}
+{
+    _pipelines.emplace(LightCounts {}, _factory(LightCounts {}));
+}
+
+PipelineVariants::~PipelineVariants() noexcept
+{
+    waitForPending();
+}
+
+auto PipelineVariants::get(const LightCounts& lightCounts) -> const Pipeline&
+{
+    if (const auto it = _pipelines.find(lightCounts); it != _pipelines.end())
+    {
+        return *it->second;
+    }
+
+    auto& pendingVariant = compile(lightCounts);
+    if (pendingVariant.compilation.wait_for(std::chrono::seconds {}) != std::future_status::ready)
+    {
+        return *_pipelines.at(LightCounts {});
+    }
+
+    pendingVariant.compilation.get();
+    const auto& pipeline = *_pipelines.emplace(lightCounts, std::move(pendingVariant.pipeline)).first->second;
+    _pendingVariants.erase(lightCounts);
+    return pipeline;
+}
+
+auto PipelineVariants::waitForPending() noexcept -> void
+{
+    for (auto& [lightCounts, pendingVariant] : _pendingVariants)
+    {
+        pendingVariant.compilation.wait();
+    }
+}
+
+auto PipelineVariants::compile(const LightCounts& lightCounts) -> PendingVariant&
+{
+    const auto [it, isNew] = _pendingVariants.try_emplace(lightCounts);
+    if (isNew)
+    {
+        log::Info("Compiling pipeline for {} directional, {} point and {} spot lights",
+                  lightCounts.directionalLights,
+                  lightCounts.pointLights,
+                  lightCounts.spotLights);
+        it->second.compilation = _jobSystem.submit([this, lightCounts, &pipeline = it->second.pipeline] {
+            pipeline = _factory(lightCounts);
+        });
+    }
+    return it->second;
+}
+
+}
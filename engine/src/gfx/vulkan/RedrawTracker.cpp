@@ -0,0 +1,120 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/RedrawTracker.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <glm/gtx/hash.hpp>
+
+#include "panda/gfx/Camera.h"
+#include "panda/gfx/Light.h"
+#include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/object/Object.h"
+#include "panda/utils/Utils.h"
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+auto hashLight(size_t& seed, const BaseLight& light) -> void
+{
+    utils::hashCombine(seed, light.ambient, light.diffuse, light.specular, light.intensity);
+}
+
+auto hashLight(size_t& seed, const DirectionalLight& light) -> void
+{
+    hashLight(seed, static_cast<const BaseLight&>(light));
+    utils::hashCombine(seed, light.direction);
+}
+
+auto hashLight(size_t& seed, const PointLight& light) -> void
+{
+    hashLight(seed, static_cast<const BaseLight&>(light));
+    utils::hashCombine(seed,
+                       light.position,
+                       light.attenuation.constant,
+                       light.attenuation.linear,
+                       light.attenuation.exp);
+}
+
+auto hashLight(size_t& seed, const SpotLight& light) -> void
+{
+    hashLight(seed, static_cast<const PointLight&>(light));
+    utils::hashCombine(seed, light.direction, light.cutOff);
+}
+
+}
+
+// Hi-Z visibility, GPU timings and streaming feedback reach the CPU up to framesInFlight frames late, one more frame
+// after that lets them catch up
+RedrawTracker::RedrawTracker(size_t framesInFlight)
+    : _settleFrameCount {static_cast<uint32_t>(framesInFlight + 1)},
+      _pendingFrameCount {_settleFrameCount}
+{
+}
+
+auto RedrawTracker::requestRedraw() noexcept -> void
+{
+    _pendingFrameCount = std::max(_pendingFrameCount, _settleFrameCount);
+}
+
+auto RedrawTracker::frameRendered(const Scene& scene) -> void
+{
+    const auto signature = getSignature(scene);
+    if (signature != _signature)
+    {
+        requestRedraw();
+    }
+    _signature = signature;
+
+    if (_pendingFrameCount > 0)
+    {
+        _pendingFrameCount--;
+    }
+}
+
+auto RedrawTracker::isRedrawRequired(const Scene& scene) const -> bool
+{
+    return _pendingFrameCount > 0 || _signature != getSignature(scene);
+}
+
+auto RedrawTracker::getSignature(const Scene& scene) -> size_t
+{
+    auto seed = size_t {};
+    utils::hashCombine(seed,
+                       scene.getCamera().getView(),
+                       scene.getCamera().getProjection(),
+                       scene.getObjects().size(),
+                       scene.getInstancedSurfaceMap().size(),
+                       scene.getSharedSurfaceMap().size());
+
+    for (const auto& object : scene.getObjects())
+    {
+        utils::hashCombine(seed, object->getId(), object->transform, object->isOccluder, object->isStatic);
+    }
+
+    const auto& lights = scene.getLights();
+    utils::hashCombine(
+        seed, lights.directionalLights.size(), lights.pointLights.size(), lights.spotLights.size());
+    for (const auto& light : lights.directionalLights)
+    {
+        hashLight(seed, light);
+    }
+    for (const auto& light : lights.pointLights)
+    {
+        hashLight(seed, light);
+    }
+    for (const auto& light : lights.spotLights)
+    {
+        hashLight(seed, light);
+    }
+
+    return seed;
+}
+
+}
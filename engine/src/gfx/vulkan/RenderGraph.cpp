@@ -0,0 +1,277 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/RenderGraph.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Logger.h"
+
+namespace panda::gfx::vulkan
+{
+
+RenderGraph::Pass::Pass(std::string name)
+    : _name {std::move(name)}
+{
+}
+
+auto RenderGraph::Pass::read(ResourceId resource, const Usage& usage) -> Pass&
+{
+    return addAccess({.resource = resource, .usage = usage, .isWrite = false, .isAttachment = false});
+}
+
+auto RenderGraph::Pass::write(ResourceId resource, const Usage& usage) -> Pass&
+{
+    return addAccess({.resource = resource, .usage = usage, .isWrite = true, .isAttachment = false});
+}
+
+auto RenderGraph::Pass::writeAttachment(ResourceId resource, const Usage& usage) -> Pass&
+{
+    return addAccess({.resource = resource, .usage = usage, .isWrite = true, .isAttachment = true});
+}
+
+auto RenderGraph::Pass::setSideEffects() -> Pass&
+{
+    _hasSideEffects = true;
+    return *this;
+}
+
+auto RenderGraph::Pass::setExecute(std::function<void(vk::CommandBuffer)> execute) -> Pass&
+{
+    _execute = std::move(execute);
+    return *this;
+}
+
+auto RenderGraph::Pass::addAccess(const Access& access) -> Pass&
+{
+    const auto it = std::ranges::find(_accesses, access.resource, &Access::resource);
+    if (it == _accesses.end())
+    {
+        _accesses.push_back(access);
+        return *this;
+    }
+
+    expect(it->usage.layout == access.usage.layout,
+           fmt::format("Pass {} uses resource {} in two different layouts", _name, access.resource));
+    it->usage.stages |= access.usage.stages;
+    it->usage.access |= access.usage.access;
+    it->isWrite = it->isWrite || access.isWrite;
+    it->isAttachment = it->isAttachment || access.isAttachment;
+    return *this;
+}
+
+auto RenderGraph::beginFrame() -> void
+{
+    _resources.clear();
+    _passes.clear();
+}
+
+auto RenderGraph::importImage(std::string name,
+                              vk::Image image,
+                              const vk::ImageSubresourceRange& range,
+                              const Usage& initialUsage) -> ResourceId
+{
+    _resources.push_back({.name = std::move(name),
+                          .image = image,
+                          .range = range,
+                          .initialUsage = initialUsage,
+                          .isImage = true});
+    return static_cast<ResourceId>(_resources.size() - 1);
+}
+
+auto RenderGraph::importBuffer(std::string name, const Usage& initialUsage) -> ResourceId
+{
+    _resources.push_back({.name = std::move(name),
+                          .image = {},
+                          .range = {},
+                          .initialUsage = initialUsage,
+                          .isImage = false});
+    return static_cast<ResourceId>(_resources.size() - 1);
+}
+
+auto RenderGraph::addPass(std::string name) -> Pass&
+{
+    return _passes.emplace_back(std::move(name));
+}
+
+auto RenderGraph::execute(vk::CommandBuffer commandBuffer) -> void
+{
+    const auto passes = cullPasses();
+    _statistics = {.passCount = _passes.size(), .culledPassCount = _passes.size() - passes.size(), .barrierCount = 0};
+
+    auto states = createInitialStates();
+    for (const auto* pass : passes)
+    {
+        const auto barrier = createBarrier(*pass, states);
+        if (barrier.dstStages)
+        {
+            const auto memoryBarrierCount = barrier.memoryBarrier.srcAccessMask ? size_t {1} : size_t {};
+            commandBuffer.pipelineBarrier(barrier.srcStages,
+                                          barrier.dstStages,
+                                          {},
+                                          std::span {&barrier.memoryBarrier, memoryBarrierCount},
+                                          {},
+                                          barrier.imageBarriers);
+            _statistics.barrierCount++;
+        }
+
+        if (pass->_execute)
+        {
+            pass->_execute(commandBuffer);
+        }
+    }
+}
+
+auto RenderGraph::getStatistics() const noexcept -> const Statistics&
+{
+    return _statistics;
+}
+
+auto RenderGraph::cullPasses() const -> std::vector<const Pass*>
+{
+    // A resource read before its first write carries the previous frame's contents, so the frame's writes to it are
+    // consumed by the next frame
+    auto isNeeded = std::vector<bool>(_resources.size(), false);
+    auto isWritten = std::vector<bool>(_resources.size(), false);
+    for (const auto& pass : _passes)
+    {
+        for (const auto& access : pass._accesses)
+        {
+            isNeeded[access.resource] = isNeeded[access.resource] || (!access.isWrite && !isWritten[access.resource]);
+            isWritten[access.resource] = isWritten[access.resource] || access.isWrite;
+        }
+    }
+
+    auto isKept = std::vector<bool>(_passes.size(), false);
+    for (auto i = _passes.size(); i > 0; i--)
+    {
+        const auto& pass = _passes[i - 1];
+        isKept[i - 1] = pass._hasSideEffects || std::ranges::any_of(pass._accesses, [&isNeeded](const auto& access) {
+                            return access.isWrite && isNeeded[access.resource];
+                        });
+        if (!isKept[i - 1])
+        {
+            continue;
+        }
+
+        // Writes don't release a resource, they may only update part of it
+        for (const auto& access : pass._accesses)
+        {
+            isNeeded[access.resource] = true;
+        }
+    }
+
+    auto passes = std::vector<const Pass*> {};
+    for (auto i = size_t {}; i < _passes.size(); i++)
+    {
+        if (!isKept[i])
+        {
+            log::Debug("Culling render graph pass {}", _passes[i]._name);
+            continue;
+        }
+        passes.push_back(&_passes[i]);
+    }
+    return passes;
+}
+
+auto RenderGraph::createInitialStates() const -> std::vector<ResourceState>
+{
+    auto states = std::vector<ResourceState> {};
+    states.reserve(_resources.size());
+    std::ranges::transform(_resources, std::back_inserter(states), [](const auto& resource) {
+        return ResourceState {.writeStages = resource.initialUsage.stages,
+                              .writeAccess = resource.initialUsage.access,
+                              .readStages = {},
+                              .readAccess = {},
+                              .layout = resource.initialUsage.layout};
+    });
+    return states;
+}
+
+auto RenderGraph::createBarrier(const Pass& pass, std::vector<ResourceState>& states) const -> Barrier
+{
+    auto barrier = Barrier {};
+    for (const auto& access : pass._accesses)
+    {
+        const auto& resource = _resources[access.resource];
+        auto& state = states[access.resource];
+        const auto& usage = access.usage;
+
+        const auto needsTransition = resource.isImage && !access.isAttachment && usage.layout != state.layout;
+        const auto isReadSynchronized =
+            (state.readStages & usage.stages) == usage.stages && (state.readAccess & usage.access) == usage.access;
+
+        auto srcStages = vk::PipelineStageFlags {};
+        auto srcAccess = vk::AccessFlags {};
+        if (access.isWrite)
+        {
+            srcStages = state.writeStages | state.readStages;
+            srcAccess = state.writeAccess;
+        }
+        else if (needsTransition || !isReadSynchronized)
+        {
+            srcStages = state.writeStages;
+            srcAccess = state.writeAccess;
+        }
+
+        if (needsTransition)
+        {
+            barrier.imageBarriers.push_back(vk::ImageMemoryBarrier {srcAccess,
+                                                                    usage.access,
+                                                                    state.layout,
+                                                                    usage.layout,
+                                                                    vk::QueueFamilyIgnored,
+                                                                    vk::QueueFamilyIgnored,
+                                                                    resource.image,
+                                                                    resource.range});
+        }
+        else if (srcAccess)
+        {
+            barrier.memoryBarrier.srcAccessMask |= srcAccess;
+            barrier.memoryBarrier.dstAccessMask |= usage.access;
+        }
+
+        if (needsTransition || srcStages)
+        {
+            barrier.srcStages |= srcStages ? srcStages : vk::PipelineStageFlagBits::eTopOfPipe;
+            barrier.dstStages |= usage.stages;
+        }
+
+        if (access.isWrite || needsTransition)
+        {
+            state.writeStages = usage.stages;
+            state.writeAccess = access.isWrite ? usage.access : vk::AccessFlags {};
+            state.readStages = access.isWrite ? vk::PipelineStageFlags {} : usage.stages;
+            state.readAccess = access.isWrite ? vk::AccessFlags {} : usage.access;
+        }
+        else
+        {
+            state.readStages |= usage.stages;
+            state.readAccess |= usage.access;
+        }
+
+        if (resource.isImage && usage.layout != vk::ImageLayout::eUndefined)
+        {
+            state.layout = usage.layout;
+        }
+    }
+
+    return barrier;
+}
+
+}
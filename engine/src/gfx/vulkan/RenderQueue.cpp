@@ -0,0 +1,101 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+constexpr auto passBits = 4U;
+constexpr auto pipelineBits = 8U;
+constexpr auto materialBits = 16U;
+constexpr auto meshBits = 16U;
+constexpr auto depthBits = 20U;
+
+static_assert(passBits + pipelineBits + materialBits + meshBits + depthBits == 64);
+
+constexpr auto radixBits = 8U;
+constexpr auto radixSize = size_t {1} << radixBits;
+
+constexpr auto mask(uint64_t value, uint32_t bits) noexcept -> uint64_t
+{
+    return value & ((uint64_t {1} << bits) - 1);
+}
+
+auto quantizeDepth(float depth) noexcept -> uint64_t
+{
+    // Positive floats keep their order when compared as integers, the sign bit is always zero here
+    return std::bit_cast<uint32_t>(std::max(depth, 0.F)) >> (32U - depthBits - 1U);
+}
+
+}
+
+auto RenderQueue::makeKey(const SortKey& sortKey) noexcept -> uint64_t
+{
+    auto key = mask(static_cast<uint64_t>(sortKey.pass), passBits);
+    key = (key << pipelineBits) | mask(sortKey.pipeline, pipelineBits);
+    key = (key << materialBits) | mask(sortKey.material, materialBits);
+    key = (key << meshBits) | mask(sortKey.mesh, meshBits);
+    return (key << depthBits) | mask(quantizeDepth(sortKey.depth), depthBits);
+}
+
+auto RenderQueue::clear() noexcept -> void
+{
+    _entries.clear();
+}
+
+auto RenderQueue::push(const SortKey& sortKey, uint32_t drawIndex) -> void
+{
+    _entries.push_back({.key = makeKey(sortKey), .drawIndex = drawIndex});
+}
+
+auto RenderQueue::sort() -> void
+{
+    _sortBuffer.resize(_entries.size());
+
+    for (auto shift = 0U; shift < 64U; shift += radixBits)
+    {
+        auto offsets = std::array<size_t, radixSize> {};
+        for (const auto& entry : _entries)
+        {
+            offsets[mask(entry.key >> shift, radixBits)]++;
+        }
+
+        if (std::ranges::find(offsets, _entries.size()) != offsets.end())
+        {
+            continue;
+        }
+
+        auto offset = size_t {};
+        for (auto& count : offsets)
+        {
+            offset += std::exchange(count, offset);
+        }
+
+        for (const auto& entry : _entries)
+        {
+            _sortBuffer[offsets[mask(entry.key >> shift, radixBits)]++] = entry;
+        }
+
+        std::swap(_entries, _sortBuffer);
+    }
+}
+
+auto RenderQueue::getEntries() const noexcept -> std::span<const Entry>
+{
+    return _entries;
+}
+
+}
@@ -4,7 +4,10 @@
 
 #include "panda/gfx/vulkan/Renderer.h"
 
+#include <algorithm>
 #include <array>
+#include <cstddef>
+#include <cmath>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -14,7 +17,6 @@
 #include <vulkan/vulkan_handles.hpp>
 #include <vulkan/vulkan_structs.hpp>
 
-#include "panda/gfx/vulkan/Context.h"
 #include "panda/gfx/vulkan/Device.h"
 #include "panda/gfx/vulkan/SwapChain.h"
 #include "panda/gfx/vulkan/object/Object.h"
@@ -23,9 +25,16 @@
 namespace panda::gfx::vulkan
 {
 
-Renderer::Renderer(const Window& window, const Device& device, const vk::SurfaceKHR& surface)
+Renderer::Renderer(const Window& window,
+                   const Device& device,
+                   DeletionQueue& deletionQueue,
+                   const vk::SurfaceKHR& surface,
+                   ShadingMode shadingMode,
+                   std::optional<float> maxRenderScale,
+                   const SwapChainConfig& swapChainConfig)
     : _device {device},
-      _swapChain {std::make_unique<SwapChain>(device, surface, window)},
+      _swapChain {std::make_unique<SwapChain>(
+          device, deletionQueue, surface, window, shadingMode, maxRenderScale, swapChainConfig)},
       _commandBuffers {createCommandBuffers()}
 {
 }
@@ -55,14 +64,20 @@ auto Renderer::beginFrame() -> vk::CommandBuffer
 auto Renderer::endFrame() -> void
 {
     expect(_isFrameStarted, "Can't end frame which isn't began");
+
+    if (_swapChain->isHeadless())
+    {
+        _swapChain->recordReadback(getCurrentCommandBuffer(), _currentImageIndex);
+    }
+
     expect(getCurrentCommandBuffer().end(), vk::Result::eSuccess, "Can't end command buffer");
     _swapChain->submitCommandBuffers(getCurrentCommandBuffer(), _currentImageIndex);
 
     _isFrameStarted = false;
-    _currentFrameIndex = (_currentFrameIndex + 1) % Context::maxFramesInFlight;
+    _currentFrameIndex = static_cast<uint32_t>((_currentFrameIndex + 1) % _swapChain->getFramesInFlight());
 }
 
-auto Renderer::beginSwapChainRenderPass() const -> void
+auto Renderer::beginSwapChainRenderPass(vk::SubpassContents contents) const -> void
 {
     expect(_isFrameStarted, "Can't begin render pass when frame is not began");
     const auto clearColor = vk::ClearValue {
@@ -75,30 +90,71 @@ auto Renderer::beginSwapChainRenderPass() const -> void
     const auto renderPassBeginInfo = vk::RenderPassBeginInfo {
         _swapChain->getRenderPass(),
         _swapChain->getFrameBuffer(_currentImageIndex),
-        {{0, 0}, _swapChain->getExtent()},
+        {{0, 0}, getRenderExtent()},
         clearValues
     };
 
-    const auto commandBuffer = getCurrentCommandBuffer();
+    getCurrentCommandBuffer().beginRenderPass(renderPassBeginInfo, contents);
+
+    if (contents == vk::SubpassContents::eInline)
+    {
+        setViewportAndScissor(getRenderExtent());
+    }
+}
+
+auto Renderer::beginPresentRenderPass() const -> void
+{
+    expect(_isFrameStarted, "Can't begin present pass when frame is not began");
+    expect(isRenderingOffscreen(), "Present pass is only used when rendering offscreen");
+    const auto renderPassBeginInfo = vk::RenderPassBeginInfo {
+        _swapChain->getPresentRenderPass(),
+        _swapChain->getPresentFrameBuffer(_currentImageIndex),
+        {{0, 0}, _swapChain->getExtent()},
+        {}
+    };
+
+    getCurrentCommandBuffer().beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+    setViewportAndScissor(_swapChain->getExtent());
+}
 
-    commandBuffer.beginRenderPass(renderPassBeginInfo, vk::SubpassContents::eInline);
+auto Renderer::endPresentRenderPass() const -> void
+{
+    expect(_isFrameStarted, "Can't end present pass when frame is not began");
+    getCurrentCommandBuffer().endRenderPass();
+}
+
+auto Renderer::setRenderScale(float scale) noexcept -> void
+{
+    _renderScale = scale;
+}
+
+auto Renderer::setViewportAndScissor(vk::Extent2D extent) const -> void
+{
+    const auto commandBuffer = getCurrentCommandBuffer();
 
-    const auto viewport = vk::Viewport {0.F,
-                                        0.F,
-                                        static_cast<float>(_swapChain->getExtent().width),
-                                        static_cast<float>(_swapChain->getExtent().height),
-                                        0.F,
-                                        1.F};
+    const auto viewport = vk::Viewport {
+        0.F, 0.F, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.F, 1.F};
     commandBuffer.setViewport(0, viewport);
 
     const auto scissor = vk::Rect2D {
         {0, 0},
-        _swapChain->getExtent()
+        extent
     };
 
     commandBuffer.setScissor(0, scissor);
 }
 
+auto Renderer::nextSubpass(vk::SubpassContents contents) const -> void
+{
+    expect(_isFrameStarted, "Can't go to next subpass when frame is not began");
+    getCurrentCommandBuffer().nextSubpass(contents);
+
+    if (contents == vk::SubpassContents::eInline)
+    {
+        setViewportAndScissor(getRenderExtent());
+    }
+}
+
 auto Renderer::endSwapChainRenderPass() const -> void
 {
     expect(_isFrameStarted, "Can't end render pass when frame is not began");
@@ -121,11 +177,51 @@ auto Renderer::getSwapChainRenderPass() const noexcept -> const vk::RenderPass&
     return _swapChain->getRenderPass();
 }
 
+auto Renderer::getPresentRenderPass() const noexcept -> const vk::RenderPass&
+{
+    return _swapChain->getPresentRenderPass();
+}
+
+auto Renderer::getCurrentFramebuffer() const noexcept -> vk::Framebuffer
+{
+    return _swapChain->getFrameBuffer(_currentImageIndex);
+}
+
+auto Renderer::getShadingMode() const noexcept -> ShadingMode
+{
+    return _swapChain->getShadingMode();
+}
+
+auto Renderer::getGBuffer() const noexcept -> const GBuffer&
+{
+    return _swapChain->getGBuffer(_currentImageIndex);
+}
+
+auto Renderer::getDepthImage() const noexcept -> vk::Image
+{
+    return _swapChain->getDepthImage(_currentImageIndex);
+}
+
+auto Renderer::getDepthImageView() const noexcept -> vk::ImageView
+{
+    return _swapChain->getDepthImageView(_currentImageIndex);
+}
+
+auto Renderer::getSceneColorImage() const noexcept -> vk::Image
+{
+    return _swapChain->getSceneColor(_currentImageIndex).image;
+}
+
+auto Renderer::getSceneColorView() const noexcept -> vk::ImageView
+{
+    return _swapChain->getSceneColor(_currentImageIndex).view;
+}
+
 auto Renderer::createCommandBuffers() -> std::vector<vk::CommandBuffer>
 {
     const auto allocationInfo = vk::CommandBufferAllocateInfo {_device.commandPool,
                                                                vk::CommandBufferLevel::ePrimary,
-                                                               static_cast<uint32_t>(_swapChain->imagesCount())};
+                                                               static_cast<uint32_t>(_swapChain->getFramesInFlight())};
     return expect(_device.logicalDevice.allocateCommandBuffers(allocationInfo),
                   vk::Result::eSuccess,
                   "Can't allocate command buffer");
@@ -137,9 +233,90 @@ auto Renderer::getFrameIndex() const noexcept -> uint32_t
     return _currentFrameIndex;
 }
 
+auto Renderer::getFramesInFlight() const noexcept -> size_t
+{
+    return _swapChain->getFramesInFlight();
+}
+
+auto Renderer::getImageCount() const noexcept -> size_t
+{
+    return _swapChain->imagesCount();
+}
+
+auto Renderer::isHeadless() const noexcept -> bool
+{
+    return _swapChain->isHeadless();
+}
+
+auto Renderer::readFrame() const -> std::optional<FrameReadback>
+{
+    return _swapChain->readFrame();
+}
+
+auto Renderer::isCaptureSupported() const -> bool
+{
+    return _swapChain->isCaptureSupported();
+}
+
+auto Renderer::getCurrentImage() const noexcept -> vk::Image
+{
+    return _swapChain->getImage(_currentImageIndex);
+}
+
+auto Renderer::getImageFormat() const noexcept -> vk::Format
+{
+    return _swapChain->getImageFormat();
+}
+
+auto Renderer::getOutputLayout() const noexcept -> vk::ImageLayout
+{
+    return _swapChain->getOutputLayout();
+}
+
+auto Renderer::getFrameTimeline() const noexcept -> vk::Semaphore
+{
+    return _swapChain->getFrameTimeline();
+}
+
+auto Renderer::getPendingTimelineValue() const noexcept -> uint64_t
+{
+    return _swapChain->getPendingTimelineValue();
+}
+
 auto Renderer::getAspectRatio() const noexcept -> float
 {
     return _swapChain->getExtentAspectRatio();
 }
 
+auto Renderer::getExtent() const noexcept -> const vk::Extent2D&
+{
+    return _swapChain->getExtent();
+}
+
+auto Renderer::getRenderExtent() const noexcept -> vk::Extent2D
+{
+    if (!isRenderingOffscreen())
+    {
+        return _swapChain->getExtent();
+    }
+
+    const auto& extent = _swapChain->getExtent();
+    const auto& targetExtent = _swapChain->getRenderTargetExtent();
+    const auto scale = [this](uint32_t size, uint32_t maxSize) {
+        return std::clamp(
+            static_cast<uint32_t>(std::ceil(static_cast<float>(size) * _renderScale)), uint32_t {1}, maxSize);
+    };
+    return {scale(extent.width, targetExtent.width), scale(extent.height, targetExtent.height)};
+}
+
+auto Renderer::getRenderTargetExtent() const noexcept -> const vk::Extent2D&
+{
+    return _swapChain->getRenderTargetExtent();
+}
+
+auto Renderer::isRenderingOffscreen() const noexcept -> bool
+{
+    return _swapChain->isRenderingOffscreen();
+}
+
 }
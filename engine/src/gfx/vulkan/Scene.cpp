@@ -44,6 +44,11 @@ auto Scene::getInstancedSurfaceMap() const noexcept -> const std::unordered_map<
     return _surfaces;
 }
 
+auto Scene::getSharedSurfaceMap() const noexcept -> const std::unordered_map<Surface, std::vector<const Object*>>&
+{
+    return _sharedSurfaces;
+}
+
 auto Scene::addObject(std::string name, const std::vector<Surface>& surfaces) -> Object&
 {
     auto newObject = std::make_unique<Object>(getUniqueName(std::move(name)), *this);
@@ -63,11 +68,23 @@ auto Scene::addSurfaceMapping(const Object& object, const Surface& surface) -> v
 {
     if (!surface.isInstanced())
     {
+        _sharedSurfaces[surface].push_back(&object);
         return;
     }
     _surfaces[surface].push_back(&object);
 }
 
+auto Scene::removeSurfaceMappings(const Object& object) -> void
+{
+    for (auto* surfaces : {&_surfaces, &_sharedSurfaces})
+    {
+        std::erase_if(*surfaces, [&object](auto& mapping) {
+            std::erase(mapping.second, &object);
+            return mapping.second.empty();
+        });
+    }
+}
+
 auto Scene::getObjects() const noexcept -> const std::vector<std::unique_ptr<Object>>&
 {
     return _objects;
@@ -88,12 +105,23 @@ auto Scene::getCamera() noexcept -> Camera&
     return _camera;
 }
 
+auto Scene::getMaxPunctualLights() const noexcept -> size_t
+{
+    return _maxPunctualLights;
+}
+
+auto Scene::setMaxPunctualLights(size_t count) noexcept -> void
+{
+    _maxPunctualLights = std::min(count, maxClusteredLights);
+}
+
 auto Scene::removeObjectByName(std::string_view name) -> bool
 {
     const auto objectIt = std::ranges::find(_objects, name, &Object::getName);
     if (objectIt != std::ranges::end(_objects))
     {
         removeName(name);
+        removeSurfaceMappings(**objectIt);
         _objects.erase(objectIt);
         return true;
     }
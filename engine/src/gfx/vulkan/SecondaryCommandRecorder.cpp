@@ -0,0 +1,152 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/SecondaryCommandRecorder.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/utils/JobSystem.h"
+#include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
+
+namespace panda::gfx::vulkan
+{
+
+SecondaryCommandRecorder::SecondaryCommandRecorder(const Device& device,
+                                                   utils::JobSystem& jobSystem,
+                                                   size_t framesInFlight)
+    : _device {device},
+      _jobSystem {jobSystem},
+      _commandPools(framesInFlight)
+{
+    for (auto& frameCommandPools : _commandPools)
+    {
+        for (auto i = size_t {}; i < _jobSystem.getWorkerCount() + 1; i++)
+        {
+            const auto commandPoolInfo =
+                vk::CommandPoolCreateInfo {vk::CommandPoolCreateFlagBits::eTransient,
+                                           _device.queueFamilies.graphicsFamily};
+            frameCommandPools.push_back(
+                {.commandPool = expect(_device.logicalDevice.createCommandPool(commandPoolInfo),
+                                       vk::Result::eSuccess,
+                                       "Can't create secondary command pool"),
+                 .commandBuffers = {},
+                 .usedCount = 0});
+        }
+    }
+}
+
+SecondaryCommandRecorder::~SecondaryCommandRecorder() noexcept
+{
+    for (const auto& frameCommandPools : _commandPools)
+    {
+        for (const auto& threadCommandPool : frameCommandPools)
+        {
+            _device.logicalDevice.destroyCommandPool(threadCommandPool.commandPool);
+        }
+    }
+}
+
+auto SecondaryCommandRecorder::beginFrame(uint32_t frameIndex,
+                                          vk::RenderPass renderPass,
+                                          vk::Framebuffer framebuffer,
+                                          vk::Extent2D extent) -> void
+{
+    _frameIndex = frameIndex;
+    _renderPass = renderPass;
+    _framebuffer = framebuffer;
+    _extent = extent;
+
+    for (auto& threadCommandPool : _commandPools[_frameIndex])
+    {
+        expect(_device.logicalDevice.resetCommandPool(threadCommandPool.commandPool),
+               vk::Result::eSuccess,
+               "Can't reset secondary command pool");
+        threadCommandPool.usedCount = 0;
+    }
+}
+
+auto SecondaryCommandRecorder::record(size_t count, size_t minBatchSize, const RecordJob& job)
+    -> std::vector<vk::CommandBuffer>
+{
+    if (count == 0)
+    {
+        return {};
+    }
+
+    auto& frameCommandPools = _commandPools[_frameIndex];
+    const auto batchSize =
+        std::max((count + frameCommandPools.size() - 1) / frameCommandPools.size(), std::max(minBatchSize, size_t {1}));
+    const auto batchCount = (count + batchSize - 1) / batchSize;
+
+    auto commandBuffers = std::vector<vk::CommandBuffer> {};
+    commandBuffers.reserve(batchCount);
+    for (auto i = size_t {}; i < batchCount; i++)
+    {
+        commandBuffers.push_back(acquire(frameCommandPools[i]));
+    }
+
+    _jobSystem.parallelFor(batchCount, 1, [this, &commandBuffers, &job, batchSize, count](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++)
+        {
+            this->begin(commandBuffers[i],
+                        _framebuffer,
+                        vk::CommandBufferUsageFlagBits::eRenderPassContinue |
+                            vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+            job(commandBuffers[i], i * batchSize, std::min((i + 1) * batchSize, count));
+            expect(commandBuffers[i].end(), vk::Result::eSuccess, "Can't end secondary command buffer");
+        }
+    });
+
+    return commandBuffers;
+}
+
+auto SecondaryCommandRecorder::acquire(ThreadCommandPool& threadCommandPool) const -> vk::CommandBuffer
+{
+    if (threadCommandPool.usedCount == threadCommandPool.commandBuffers.size())
+    {
+        const auto allocationInfo =
+            vk::CommandBufferAllocateInfo {threadCommandPool.commandPool, vk::CommandBufferLevel::eSecondary, 1};
+        threadCommandPool.commandBuffers.push_back(
+            expect(_device.logicalDevice.allocateCommandBuffers(allocationInfo),
+                   vk::Result::eSuccess,
+                   "Can't allocate secondary command buffer")
+                .front());
+    }
+
+    return threadCommandPool.commandBuffers[threadCommandPool.usedCount++];
+}
+
+auto SecondaryCommandRecorder::beginReusable(vk::CommandBuffer commandBuffer) const -> void
+{
+    begin(commandBuffer, vk::Framebuffer {}, vk::CommandBufferUsageFlagBits::eRenderPassContinue);
+}
+
+auto SecondaryCommandRecorder::getExtent() const noexcept -> vk::Extent2D
+{
+    return _extent;
+}
+
+auto SecondaryCommandRecorder::begin(vk::CommandBuffer commandBuffer,
+                                     vk::Framebuffer framebuffer,
+                                     vk::CommandBufferUsageFlags usage) const -> void
+{
+    const auto inheritanceInfo = vk::CommandBufferInheritanceInfo {_renderPass, 0, framebuffer};
+    const auto beginInfo = vk::CommandBufferBeginInfo {usage, &inheritanceInfo};
+    expect(commandBuffer.begin(beginInfo), vk::Result::eSuccess, "Can't begin secondary command buffer");
+
+    commandBuffer.setViewport(
+        0,
+        vk::Viewport {0.F, 0.F, static_cast<float>(_extent.width), static_cast<float>(_extent.height), 0.F, 1.F});
+    commandBuffer.setScissor(0, vk::Rect2D {{0, 0}, _extent});
+}
+
+}
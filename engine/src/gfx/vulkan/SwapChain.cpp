@@ -6,19 +6,25 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <limits>
+#include <memory>
 #include <optional>
 #include <span>
+#include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_format_traits.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
 #include "panda/Logger.h"
 #include "panda/Window.h"
-#include "panda/gfx/vulkan/Context.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
 #include "panda/gfx/vulkan/Device.h"
 #include "panda/utils/Signals.h"
 #include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
@@ -26,23 +32,72 @@
 namespace panda::gfx::vulkan
 {
 
-SwapChain::SwapChain(const Device& device, const vk::SurfaceKHR& surface, const Window& window)
+SwapChain::SwapChain(const Device& device,
+                     DeletionQueue& deletionQueue,
+                     const vk::SurfaceKHR& surface,
+                     const Window& window,
+                     ShadingMode shadingMode,
+                     std::optional<float> maxRenderScale,
+                     const SwapChainConfig& config)
     : _device {device},
+      _deletionQueue {deletionQueue},
       _window {window},
       _surface {surface},
-      _swapChainExtent {chooseSwapExtent(_device.querySwapChainSupport().capabilities, _window)},
-      _swapChainImageFormat {chooseSwapSurfaceFormat(_device.querySwapChainSupport().formats)},
+      _shadingMode {shadingMode},
+      _maxRenderScale {maxRenderScale},
+      _config {config},
+      _swapChainExtent {isHeadless() ? vk::Extent2D {_window.getSize().x, _window.getSize().y}
+                                     : chooseSwapExtent(_device.querySwapChainSupport().capabilities, _window)},
+      _renderTargetExtent {getRenderTargetExtent(_swapChainExtent, _maxRenderScale)},
+      _swapChainImageFormat {isHeadless() ? headlessFormat
+                                          : chooseSwapSurfaceFormat(_device.querySwapChainSupport().formats)},
       _swapChainDepthFormat {findDepthFormat(_device)},
-      _swapChain {createSwapChain(_surface, _swapChainExtent, _device, _swapChainImageFormat)},
-      _swapChainImages {expect(
-          _device.logicalDevice.getSwapchainImagesKHR(_swapChain), vk::Result::eSuccess, "Can't get swapchain images")},
-      _swapChainImageViews {createImageViews(_swapChainImages, _swapChainImageFormat, _device)},
-      _depthImages {createDepthImages(_device, _swapChainExtent, _swapChainImages.size(), _swapChainDepthFormat)},
+      _swapChain {isHeadless() ? vk::SwapchainKHR {}
+                               : createSwapChain(_surface, _swapChainExtent, _device, _swapChainImageFormat, _config)},
+      _headlessImages {isHeadless() ? createHeadlessImages(_device,
+                                                           _swapChainExtent,
+                                                           std::max<size_t>(_config.imageCount.value_or(0),
+                                                                            _config.framesInFlight),
+                                                           _swapChainImageFormat)
+                                    : std::vector<FrameBufferAttachment> {}},
+      _swapChainImages {isHeadless() ? getImages(_headlessImages)
+                                     : expect(_device.logicalDevice.getSwapchainImagesKHR(_swapChain),
+                                              vk::Result::eSuccess,
+                                              "Can't get swapchain images")},
+      _swapChainImageViews {isHeadless() ? getColorViews({}, _headlessImages)
+                                         : createImageViews(_swapChainImages, _swapChainImageFormat, _device)},
+      _depthImages {createDepthImages(
+          _device, _renderTargetExtent, _swapChainImages.size(), _swapChainDepthFormat, _shadingMode)},
       _depthImageMemories {createDepthImageMemories(_device, _depthImages, _swapChainImages.size())},
+      _depthMemoryRequirements {_device.logicalDevice.getImageMemoryRequirements(_depthImages.front())},
       _depthImageViews {createDepthImageViews(_device, _depthImages, _swapChainImages.size(), _swapChainDepthFormat)},
-      _renderPass {createRenderPass(_swapChainImageFormat, _swapChainDepthFormat, _device)},
-      _swapChainFrameBuffers {
-          createFrameBuffers(_swapChainImageViews, _depthImageViews, _renderPass, _swapChainExtent, _device)},
+      _gBuffers {createGBuffers(_device, _renderTargetExtent, _swapChainImages.size(), _shadingMode)},
+      _sceneColors {createSceneColors(_device,
+                                      _renderTargetExtent,
+                                      _swapChainImages.size(),
+                                      _swapChainImageFormat,
+                                      _maxRenderScale.has_value())},
+      _readbackBuffers {isHeadless() ? createReadbackBuffers(_device, _swapChainExtent, _swapChainImages.size())
+                                     : std::vector<std::unique_ptr<Buffer>> {}},
+      _renderPass {createRenderPass(_swapChainImageFormat,
+                                    _swapChainDepthFormat,
+                                    _shadingMode,
+                                    _maxRenderScale.has_value() ? vk::ImageLayout::eShaderReadOnlyOptimal
+                                                                : getOutputLayout(),
+                                    _device)},
+      _presentRenderPass {_maxRenderScale.has_value()
+                              ? createPresentRenderPass(_swapChainImageFormat, getOutputLayout(), _device)
+                              : vk::RenderPass {}},
+      _swapChainFrameBuffers {createFrameBuffers(getColorViews(_swapChainImageViews, _sceneColors),
+                                                 _depthImageViews,
+                                                 _gBuffers,
+                                                 _renderPass,
+                                                 _renderTargetExtent,
+                                                 _device)},
+      _presentFrameBuffers {
+          createPresentFrameBuffers(_swapChainImageViews, _presentRenderPass, _swapChainExtent, _device)},
+      _frameTimeline {createTimelineSemaphore(_device)},
+      _frameTimelineValues(_config.framesInFlight, 0),
       _frameBufferResizeReceiver {utils::signals::frameBufferResized.connect([this](auto) noexcept {
           log::Debug("Received framebuffer resized notif");
           _frameBufferResized = true;
@@ -53,36 +108,58 @@ SwapChain::SwapChain(const Device& device, const vk::SurfaceKHR& surface, const
 
 SwapChain::~SwapChain() noexcept
 {
-    cleanup();
+    destroyResources(_device, retireResources());
 
     _device.logicalDevice.destroy(_renderPass);
-    for (const auto semaphore : _renderFinishedSemaphores)
-    {
-        _device.logicalDevice.destroy(semaphore);
-    }
+    _device.logicalDevice.destroy(_presentRenderPass);
     for (const auto semaphore : _imageAvailableSemaphores)
     {
         _device.logicalDevice.destroy(semaphore);
     }
-    for (const auto fence : _inFlightFences)
-    {
-        _device.logicalDevice.destroy(fence);
-    }
+    _device.logicalDevice.destroy(_frameTimeline);
 }
 
-auto SwapChain::choosePresentationMode(std::span<const vk::PresentModeKHR> availablePresentationModes) noexcept
-    -> vk::PresentModeKHR
+auto SwapChain::choosePresentationMode(std::span<const vk::PresentModeKHR> availablePresentationModes,
+                                       vk::PresentModeKHR preferredPresentationMode) noexcept -> vk::PresentModeKHR
 {
-    const auto it = std::ranges::find(availablePresentationModes, vk::PresentModeKHR::eMailbox);
+    const auto it = std::ranges::find(availablePresentationModes, preferredPresentationMode);
 
     if (it == availablePresentationModes.end())
     {
-        log::Warning("Choosing default mode: Fifo");
+        log::Warning("Presentation mode {} is not available, choosing default mode: Fifo",
+                     vk::to_string(preferredPresentationMode));
         return vk::PresentModeKHR::eFifo;
     }
     return *it;
 }
 
+auto SwapChain::chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities,
+                                 std::optional<uint32_t> preferredImageCount) noexcept -> uint32_t
+{
+    const auto imageCount = std::max(preferredImageCount.value_or(capabilities.minImageCount + 1),
+                                     capabilities.minImageCount);
+    if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+    {
+        return capabilities.maxImageCount;
+    }
+    return imageCount;
+}
+
+auto SwapChain::createTimelineSemaphore(const Device& device) -> vk::Semaphore
+{
+    const auto typeInfo = vk::SemaphoreTypeCreateInfo {vk::SemaphoreType::eTimeline, 0};
+    const auto semaphoreInfo = vk::SemaphoreCreateInfo {{}, &typeInfo};
+    return expect(device.logicalDevice.createSemaphore(semaphoreInfo),
+                  vk::Result::eSuccess,
+                  "Failed to create timeline semaphore");
+}
+
+auto SwapChain::isTransferSourceSupported(const Device& device) -> bool
+{
+    return static_cast<bool>(device.querySwapChainSupport().capabilities.supportedUsageFlags &
+                             vk::ImageUsageFlagBits::eTransferSrc);
+}
+
 auto SwapChain::chooseSwapSurfaceFormat(std::span<const vk::SurfaceFormatKHR> availableFormats) noexcept
     -> vk::SurfaceFormatKHR
 {
@@ -112,6 +189,67 @@ auto SwapChain::chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities,
             std::clamp<uint32_t>(size.y, capabilities.minImageExtent.height, capabilities.maxImageExtent.height)};
 }
 
+auto SwapChain::getRenderTargetExtent(vk::Extent2D swapChainExtent, std::optional<float> maxRenderScale)
+    -> vk::Extent2D
+{
+    if (!maxRenderScale.has_value())
+    {
+        return swapChainExtent;
+    }
+
+    return {std::max(static_cast<uint32_t>(std::ceil(static_cast<float>(swapChainExtent.width) * *maxRenderScale)), 1U),
+            std::max(static_cast<uint32_t>(std::ceil(static_cast<float>(swapChainExtent.height) * *maxRenderScale)),
+                     1U)};
+}
+
+auto SwapChain::createHeadlessImages(const Device& device,
+                                     vk::Extent2D extent,
+                                     size_t imagesCount,
+                                     const vk::SurfaceFormatKHR& imageFormat) -> std::vector<FrameBufferAttachment>
+{
+    auto images = std::vector<FrameBufferAttachment> {};
+    images.reserve(imagesCount);
+
+    for (auto i = size_t {}; i < imagesCount; i++)
+    {
+        images.push_back(createAttachment(device,
+                                          extent,
+                                          imageFormat.format,
+                                          vk::ImageUsageFlagBits::eColorAttachment |
+                                              vk::ImageUsageFlagBits::eTransferSrc,
+                                          vk::ImageAspectFlagBits::eColor));
+    }
+    return images;
+}
+
+auto SwapChain::getImages(const std::vector<FrameBufferAttachment>& attachments) -> std::vector<vk::Image>
+{
+    auto images = std::vector<vk::Image> {};
+    images.reserve(attachments.size());
+    std::ranges::transform(attachments, std::back_inserter(images), &FrameBufferAttachment::image);
+    return images;
+}
+
+auto SwapChain::createReadbackBuffers(const Device& device, vk::Extent2D extent, size_t imagesCount)
+    -> std::vector<std::unique_ptr<Buffer>>
+{
+    const auto frameSize = vk::DeviceSize {extent.width} * extent.height * vk::blockSize(headlessFormat.format);
+
+    auto buffers = std::vector<std::unique_ptr<Buffer>> {};
+    buffers.reserve(imagesCount);
+
+    for (auto i = size_t {}; i < imagesCount; i++)
+    {
+        auto& buffer = buffers.emplace_back(std::make_unique<Buffer>(device,
+                                                                     frameSize,
+                                                                     vk::BufferUsageFlagBits::eTransferDst,
+                                                                     vk::MemoryPropertyFlagBits::eHostVisible |
+                                                                         vk::MemoryPropertyFlagBits::eHostCoherent));
+        buffer->mapWhole();
+    }
+    return buffers;
+}
+
 auto SwapChain::createImageViews(const std::vector<vk::Image>& swapChainImages,
                                  const vk::SurfaceFormatKHR& swapChainImageFormat,
                                  const Device& device) -> std::vector<vk::ImageView>
@@ -138,17 +276,24 @@ auto SwapChain::createImageViews(const std::vector<vk::Image>& swapChainImages,
 
 auto SwapChain::createRenderPass(const vk::SurfaceFormatKHR& imageFormat,
                                  const vk::SurfaceFormatKHR& depthFormat,
+                                 ShadingMode shadingMode,
+                                 vk::ImageLayout colorFinalLayout,
                                  const Device& device) -> vk::RenderPass
 {
+    if (shadingMode == ShadingMode::Deferred)
+    {
+        return createDeferredRenderPass(imageFormat, depthFormat, colorFinalLayout, device);
+    }
+
     const auto depthAttachment = vk::AttachmentDescription {{},
                                                             depthFormat.format,
                                                             vk::SampleCountFlagBits::e1,
                                                             vk::AttachmentLoadOp::eClear,
-                                                            vk::AttachmentStoreOp::eDontCare,
+                                                            vk::AttachmentStoreOp::eStore,
                                                             vk::AttachmentLoadOp::eDontCare,
                                                             vk::AttachmentStoreOp::eDontCare,
                                                             vk::ImageLayout::eUndefined,
-                                                            vk::ImageLayout::eDepthStencilAttachmentOptimal};
+                                                            vk::ImageLayout::eDepthStencilReadOnlyOptimal};
 
     const auto depthAttachmentRef = vk::AttachmentReference {1, vk::ImageLayout::eDepthStencilAttachmentOptimal};
 
@@ -160,7 +305,7 @@ auto SwapChain::createRenderPass(const vk::SurfaceFormatKHR& imageFormat,
                                                             vk::AttachmentLoadOp::eDontCare,
                                                             vk::AttachmentStoreOp::eDontCare,
                                                             vk::ImageLayout::eUndefined,
-                                                            vk::ImageLayout::ePresentSrcKHR};
+                                                            colorFinalLayout};
 
     const auto colorAttachmentRef = vk::AttachmentReference {0, vk::ImageLayout::eColorAttachmentOptimal};
 
@@ -173,25 +318,196 @@ auto SwapChain::createRenderPass(const vk::SurfaceFormatKHR& imageFormat,
                                                  {},
                                                  &depthAttachmentRef};
 
-    const auto dependency = vk::SubpassDependency {
-        vk::SubpassExternal,
-        0,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests,
-        vk::AccessFlagBits::eNone,
-        vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite};
+    const auto dependencies = std::array {
+        vk::SubpassDependency {vk::SubpassExternal,
+                               0,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                                   vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                                   vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                               vk::AccessFlagBits::eNone,
+                               vk::AccessFlagBits::eColorAttachmentWrite |
+                                   vk::AccessFlagBits::eDepthStencilAttachmentWrite},
+        vk::SubpassDependency {0,
+                               vk::SubpassExternal,
+                               vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                                   vk::PipelineStageFlagBits::eLateFragmentTests,
+                               vk::PipelineStageFlagBits::eComputeShader,
+                               vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                               vk::AccessFlagBits::eShaderRead},
+        vk::SubpassDependency {0,
+                               vk::SubpassExternal,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                               vk::PipelineStageFlagBits::eTransfer,
+                               vk::AccessFlagBits::eColorAttachmentWrite,
+                               vk::AccessFlagBits::eTransferRead}
+    };
 
     const auto attachments = std::array {colorAttachment, depthAttachment};
 
-    const auto renderPassInfo = vk::RenderPassCreateInfo {{}, attachments, subpass, dependency};
+    const auto renderPassInfo = vk::RenderPassCreateInfo {{}, attachments, subpass, dependencies};
 
     return expect(device.logicalDevice.createRenderPass(renderPassInfo),
                   vk::Result::eSuccess,
                   "Can't create render pass");
 }
 
+auto SwapChain::createDeferredRenderPass(const vk::SurfaceFormatKHR& imageFormat,
+                                         const vk::SurfaceFormatKHR& depthFormat,
+                                         vk::ImageLayout colorFinalLayout,
+                                         const Device& device) -> vk::RenderPass
+{
+    const auto colorAttachment = vk::AttachmentDescription {{},
+                                                            imageFormat.format,
+                                                            vk::SampleCountFlagBits::e1,
+                                                            vk::AttachmentLoadOp::eClear,
+                                                            vk::AttachmentStoreOp::eStore,
+                                                            vk::AttachmentLoadOp::eDontCare,
+                                                            vk::AttachmentStoreOp::eDontCare,
+                                                            vk::ImageLayout::eUndefined,
+                                                            colorFinalLayout};
+
+    const auto depthAttachment = vk::AttachmentDescription {{},
+                                                            depthFormat.format,
+                                                            vk::SampleCountFlagBits::e1,
+                                                            vk::AttachmentLoadOp::eClear,
+                                                            vk::AttachmentStoreOp::eStore,
+                                                            vk::AttachmentLoadOp::eDontCare,
+                                                            vk::AttachmentStoreOp::eDontCare,
+                                                            vk::ImageLayout::eUndefined,
+                                                            vk::ImageLayout::eDepthStencilReadOnlyOptimal};
+
+    const auto albedoAttachment = vk::AttachmentDescription {{},
+                                                             albedoFormat,
+                                                             vk::SampleCountFlagBits::e1,
+                                                             vk::AttachmentLoadOp::eDontCare,
+                                                             vk::AttachmentStoreOp::eDontCare,
+                                                             vk::AttachmentLoadOp::eDontCare,
+                                                             vk::AttachmentStoreOp::eDontCare,
+                                                             vk::ImageLayout::eUndefined,
+                                                             vk::ImageLayout::eShaderReadOnlyOptimal};
+
+    const auto normalAttachment = vk::AttachmentDescription {{},
+                                                             normalFormat,
+                                                             vk::SampleCountFlagBits::e1,
+                                                             vk::AttachmentLoadOp::eDontCare,
+                                                             vk::AttachmentStoreOp::eDontCare,
+                                                             vk::AttachmentLoadOp::eDontCare,
+                                                             vk::AttachmentStoreOp::eDontCare,
+                                                             vk::ImageLayout::eUndefined,
+                                                             vk::ImageLayout::eShaderReadOnlyOptimal};
+
+    const auto geometryColorRefs =
+        std::array {vk::AttachmentReference {2, vk::ImageLayout::eColorAttachmentOptimal},
+                    vk::AttachmentReference {3, vk::ImageLayout::eColorAttachmentOptimal}};
+    const auto geometryDepthRef = vk::AttachmentReference {1, vk::ImageLayout::eDepthStencilAttachmentOptimal};
+
+    const auto lightingInputRefs =
+        std::array {vk::AttachmentReference {2, vk::ImageLayout::eShaderReadOnlyOptimal},
+                    vk::AttachmentReference {3, vk::ImageLayout::eShaderReadOnlyOptimal},
+                    vk::AttachmentReference {1, vk::ImageLayout::eDepthStencilReadOnlyOptimal}};
+    const auto lightingColorRef = vk::AttachmentReference {0, vk::ImageLayout::eColorAttachmentOptimal};
+    const auto lightingDepthRef = vk::AttachmentReference {1, vk::ImageLayout::eDepthStencilReadOnlyOptimal};
+
+    const auto subpasses = std::array {
+        vk::SubpassDescription {{}, vk::PipelineBindPoint::eGraphics, {}, geometryColorRefs, {}, &geometryDepthRef},
+        vk::SubpassDescription {{},
+                                vk::PipelineBindPoint::eGraphics,
+                                lightingInputRefs,
+                                lightingColorRef,
+                                {},
+                                &lightingDepthRef}
+    };
+
+    const auto dependencies = std::array {
+        vk::SubpassDependency {vk::SubpassExternal,
+                               0,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                                   vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                                   vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                               vk::AccessFlagBits::eNone,
+                               vk::AccessFlagBits::eColorAttachmentWrite |
+                                   vk::AccessFlagBits::eDepthStencilAttachmentWrite},
+        vk::SubpassDependency {0,
+                               1,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput |
+                                   vk::PipelineStageFlagBits::eLateFragmentTests,
+                               vk::PipelineStageFlagBits::eFragmentShader |
+                                   vk::PipelineStageFlagBits::eEarlyFragmentTests,
+                               vk::AccessFlagBits::eColorAttachmentWrite |
+                                   vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                               vk::AccessFlagBits::eInputAttachmentRead |
+                                   vk::AccessFlagBits::eDepthStencilAttachmentRead,
+                               vk::DependencyFlagBits::eByRegion},
+        vk::SubpassDependency {1,
+                               vk::SubpassExternal,
+                               vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                                   vk::PipelineStageFlagBits::eLateFragmentTests,
+                               vk::PipelineStageFlagBits::eComputeShader,
+                               vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                               vk::AccessFlagBits::eShaderRead},
+        vk::SubpassDependency {1,
+                               vk::SubpassExternal,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                               vk::PipelineStageFlagBits::eTransfer,
+                               vk::AccessFlagBits::eColorAttachmentWrite,
+                               vk::AccessFlagBits::eTransferRead}
+    };
+
+    const auto attachments = std::array {colorAttachment, depthAttachment, albedoAttachment, normalAttachment};
+
+    const auto renderPassInfo = vk::RenderPassCreateInfo {{}, attachments, subpasses, dependencies};
+
+    return expect(device.logicalDevice.createRenderPass(renderPassInfo),
+                  vk::Result::eSuccess,
+                  "Can't create deferred render pass");
+}
+
+auto SwapChain::createPresentRenderPass(const vk::SurfaceFormatKHR& imageFormat,
+                                        vk::ImageLayout colorFinalLayout,
+                                        const Device& device) -> vk::RenderPass
+{
+    const auto colorAttachment = vk::AttachmentDescription {{},
+                                                            imageFormat.format,
+                                                            vk::SampleCountFlagBits::e1,
+                                                            vk::AttachmentLoadOp::eDontCare,
+                                                            vk::AttachmentStoreOp::eStore,
+                                                            vk::AttachmentLoadOp::eDontCare,
+                                                            vk::AttachmentStoreOp::eDontCare,
+                                                            vk::ImageLayout::eUndefined,
+                                                            colorFinalLayout};
+
+    const auto colorAttachmentRef = vk::AttachmentReference {0, vk::ImageLayout::eColorAttachmentOptimal};
+
+    const auto subpass =
+        vk::SubpassDescription {{}, vk::PipelineBindPoint::eGraphics, {}, {}, 1, &colorAttachmentRef, {}, {}};
+
+    const auto dependencies = std::array {
+        vk::SubpassDependency {vk::SubpassExternal,
+                               0,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                               vk::AccessFlagBits::eNone,
+                               vk::AccessFlagBits::eColorAttachmentWrite},
+        vk::SubpassDependency {0,
+                               vk::SubpassExternal,
+                               vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                               vk::PipelineStageFlagBits::eTransfer,
+                               vk::AccessFlagBits::eColorAttachmentWrite,
+                               vk::AccessFlagBits::eTransferRead}
+    };
+
+    const auto renderPassInfo = vk::RenderPassCreateInfo {{}, colorAttachment, subpass, dependencies};
+
+    return expect(device.logicalDevice.createRenderPass(renderPassInfo),
+                  vk::Result::eSuccess,
+                  "Can't create present render pass");
+}
+
 auto SwapChain::createFrameBuffers(const std::vector<vk::ImageView>& swapChainImageViews,
                                    const std::vector<vk::ImageView>& depthImageViews,
+                                   const std::vector<GBuffer>& gBuffers,
                                    const vk::RenderPass& renderPass,
                                    vk::Extent2D swapChainExtent,
                                    const Device& device) -> std::vector<vk::Framebuffer>
@@ -203,7 +519,12 @@ auto SwapChain::createFrameBuffers(const std::vector<vk::ImageView>& swapChainIm
 
     for (auto i = size_t {}; i < swapChainImageViews.size(); i++)
     {
-        const auto attachments = std::array {swapChainImageViews[i], depthImageViews[i]};
+        auto attachments = std::vector {swapChainImageViews[i], depthImageViews[i]};
+        if (!gBuffers.empty())
+        {
+            attachments.push_back(gBuffers[i].albedo.view);
+            attachments.push_back(gBuffers[i].normal.view);
+        }
         const auto frameBufferInfo =
             vk::FramebufferCreateInfo {{}, renderPass, attachments, swapChainExtent.width, swapChainExtent.height, 1};
         result.push_back(expect(device.logicalDevice.createFramebuffer(frameBufferInfo),
@@ -213,37 +534,132 @@ auto SwapChain::createFrameBuffers(const std::vector<vk::ImageView>& swapChainIm
     return result;
 }
 
+auto SwapChain::createPresentFrameBuffers(const std::vector<vk::ImageView>& swapChainImageViews,
+                                          const vk::RenderPass& renderPass,
+                                          vk::Extent2D swapChainExtent,
+                                          const Device& device) -> std::vector<vk::Framebuffer>
+{
+    if (!renderPass)
+    {
+        return {};
+    }
+
+    auto result = std::vector<vk::Framebuffer> {};
+    result.reserve(swapChainImageViews.size());
+
+    for (const auto imageView : swapChainImageViews)
+    {
+        const auto frameBufferInfo =
+            vk::FramebufferCreateInfo {{}, renderPass, imageView, swapChainExtent.width, swapChainExtent.height, 1};
+        result.push_back(expect(device.logicalDevice.createFramebuffer(frameBufferInfo),
+                                vk::Result::eSuccess,
+                                "Can't create present framebuffer"));
+    }
+    return result;
+}
+
+auto SwapChain::createSceneColors(const Device& device,
+                                  vk::Extent2D renderTargetExtent,
+                                  size_t imagesCount,
+                                  const vk::SurfaceFormatKHR& imageFormat,
+                                  bool isRenderingOffscreen) -> std::vector<FrameBufferAttachment>
+{
+    if (!isRenderingOffscreen)
+    {
+        return {};
+    }
+
+    auto sceneColors = std::vector<FrameBufferAttachment> {};
+    sceneColors.reserve(imagesCount);
+
+    for (auto i = size_t {}; i < imagesCount; i++)
+    {
+        sceneColors.push_back(createAttachment(device,
+                                               renderTargetExtent,
+                                               imageFormat.format,
+                                               vk::ImageUsageFlagBits::eColorAttachment |
+                                                   vk::ImageUsageFlagBits::eSampled,
+                                               vk::ImageAspectFlagBits::eColor));
+    }
+    return sceneColors;
+}
+
+auto SwapChain::getColorViews(const std::vector<vk::ImageView>& swapChainImageViews,
+                              const std::vector<FrameBufferAttachment>& sceneColors) -> std::vector<vk::ImageView>
+{
+    if (sceneColors.empty())
+    {
+        return swapChainImageViews;
+    }
+
+    auto colorViews = std::vector<vk::ImageView> {};
+    colorViews.reserve(sceneColors.size());
+    std::ranges::transform(sceneColors, std::back_inserter(colorViews), &FrameBufferAttachment::view);
+    return colorViews;
+}
+
 auto SwapChain::createSyncObjects() -> void
 {
+    createRenderFinishedSemaphores();
+
+    if (isHeadless())
+    {
+        return;
+    }
+
     const auto semaphoreInfo = vk::SemaphoreCreateInfo {};
-    const auto fenceInfo = vk::FenceCreateInfo {vk::FenceCreateFlagBits::eSignaled};
 
-    _imageAvailableSemaphores.reserve(Context::maxFramesInFlight);
-    _renderFinishedSemaphores.reserve(Context::maxFramesInFlight);
-    _inFlightFences.reserve(Context::maxFramesInFlight);
-    _imagesInFlight.resize(imagesCount());
+    _imageAvailableSemaphores.reserve(_config.framesInFlight);
 
-    for (auto i = size_t {}; i < Context::maxFramesInFlight; i++)
+    for (auto i = size_t {}; i < _config.framesInFlight; i++)
     {
         _imageAvailableSemaphores.push_back(expect(_device.logicalDevice.createSemaphore(semaphoreInfo),
                                                    vk::Result::eSuccess,
                                                    "Failed to createSemaphore"));
+    }
+}
+
+auto SwapChain::createRenderFinishedSemaphores() -> void
+{
+    const auto semaphoreInfo = vk::SemaphoreCreateInfo {};
+
+    _renderFinishedSemaphores.reserve(imagesCount());
+
+    // The first use of every image waits for everything submitted so far, so attachments which alias memory of the
+    // previous chain aren't written while older frames still use it
+    _imageTimelineValues.assign(imagesCount(), _timelineValue);
+
+    if (isHeadless())
+    {
+        return;
+    }
+
+    // Presentation only accepts binary semaphores, and one per image is needed so a signal is never reused
+    // before the presentation engine has consumed it
+    for (auto i = size_t {}; i < imagesCount(); i++)
+    {
         _renderFinishedSemaphores.push_back(expect(_device.logicalDevice.createSemaphore(semaphoreInfo),
                                                    vk::Result::eSuccess,
                                                    "Failed to createSemaphore"));
-        _inFlightFences.push_back(
-            expect(_device.logicalDevice.createFence(fenceInfo), vk::Result::eSuccess, "Failed to create fence"));
     }
 }
 
+auto SwapChain::waitForTimeline(uint64_t value) const -> void
+{
+    const auto waitInfo = vk::SemaphoreWaitInfo {{}, _frameTimeline, value};
+    shouldBe(_device.logicalDevice.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max()),
+             vk::Result::eSuccess,
+             "Waiting for the frame timeline didn't succeed");
+}
+
 auto SwapChain::recreate() -> void
 {
     log::Info("Starting to recreate swapchain");
-    shouldBe(_device.logicalDevice.waitIdle(), vk::Result::eSuccess, "Wait idle didn't succeed");
 
-    cleanup();
+    auto retiredResources = retireResources();
     const auto swapChainSupport = _device.querySwapChainSupport();
     _swapChainExtent = chooseSwapExtent(swapChainSupport.capabilities, _window);
+    _renderTargetExtent = getRenderTargetExtent(_swapChainExtent, _maxRenderScale);
 
     const auto oldImageFormat = _swapChainImageFormat;
     _swapChainImageFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -253,57 +669,157 @@ auto SwapChain::recreate() -> void
     _swapChainDepthFormat = findDepthFormat(_device);
     shouldBe(oldDepthFormat != _swapChainDepthFormat, "Depth format has changed!");
 
-    _swapChain = createSwapChain(_surface, _swapChainExtent, _device, _swapChainImageFormat);
+    _swapChain = createSwapChain(
+        _surface, _swapChainExtent, _device, _swapChainImageFormat, _config, retiredResources.swapChain);
     _swapChainImages = expect(_device.logicalDevice.getSwapchainImagesKHR(_swapChain),
                               vk::Result::eSuccess,
                               "Can't get swapchain images");
     _swapChainImageViews = createImageViews(_swapChainImages, _swapChainImageFormat, _device);
-    _depthImages = createDepthImages(_device, _swapChainExtent, _swapChainImages.size(), _swapChainDepthFormat);
-    _depthImageMemories = createDepthImageMemories(_device, _depthImages, _swapChainImages.size());
+    _depthImages =
+        createDepthImages(_device, _renderTargetExtent, _swapChainImages.size(), _swapChainDepthFormat, _shadingMode);
+
+    if (canReuseDepthMemory(retiredResources.depthImageMemories.size()))
+    {
+        bindDepthMemory(std::exchange(retiredResources.depthImageMemories, {}));
+    }
+    else
+    {
+        _depthImageMemories = createDepthImageMemories(_device, _depthImages, _swapChainImages.size());
+        _depthMemoryRequirements = _device.logicalDevice.getImageMemoryRequirements(_depthImages.front());
+    }
+
     _depthImageViews = createDepthImageViews(_device, _depthImages, _swapChainImages.size(), _swapChainDepthFormat);
-    _swapChainFrameBuffers =
-        createFrameBuffers(_swapChainImageViews, _depthImageViews, _renderPass, _swapChainExtent, _device);
+    _gBuffers = createGBuffers(_device, _renderTargetExtent, _swapChainImages.size(), _shadingMode);
+    _sceneColors = createSceneColors(
+        _device, _renderTargetExtent, _swapChainImages.size(), _swapChainImageFormat, _maxRenderScale.has_value());
+    _swapChainFrameBuffers = createFrameBuffers(getColorViews(_swapChainImageViews, _sceneColors),
+                                                _depthImageViews,
+                                                _gBuffers,
+                                                _renderPass,
+                                                _renderTargetExtent,
+                                                _device);
+    _presentFrameBuffers =
+        createPresentFrameBuffers(_swapChainImageViews, _presentRenderPass, _swapChainExtent, _device);
+
+    createRenderFinishedSemaphores();
+
+    // The old chain is still used by frames in flight, so it's released once they retire instead of waiting here
+    _deletionQueue.push([&device = _device, resources = std::move(retiredResources)] {
+        destroyResources(device, resources);
+    });
 
     log::Info("Swapchain recreated");
 }
 
-auto SwapChain::cleanup() -> void
+auto SwapChain::retireResources() -> RetiredResources
 {
-    for (const auto framebuffer : _swapChainFrameBuffers)
+    return {.swapChain = std::exchange(_swapChain, {}),
+            .headlessImages = std::exchange(_headlessImages, {}),
+            .imageViews = std::exchange(_swapChainImageViews, {}),
+            .depthImages = std::exchange(_depthImages, {}),
+            .depthImageMemories = std::exchange(_depthImageMemories, {}),
+            .depthImageViews = std::exchange(_depthImageViews, {}),
+            .gBuffers = std::exchange(_gBuffers, {}),
+            .sceneColors = std::exchange(_sceneColors, {}),
+            .frameBuffers = std::exchange(_swapChainFrameBuffers, {}),
+            .presentFrameBuffers = std::exchange(_presentFrameBuffers, {}),
+            .renderFinishedSemaphores = std::exchange(_renderFinishedSemaphores, {})};
+}
+
+auto SwapChain::canReuseDepthMemory(size_t memoryCount) const -> bool
+{
+    if (memoryCount != _depthImages.size())
+    {
+        return false;
+    }
+
+    const auto memoryRequirements = _device.logicalDevice.getImageMemoryRequirements(_depthImages.front());
+    return memoryRequirements.size <= _depthMemoryRequirements.size &&
+           memoryRequirements.memoryTypeBits == _depthMemoryRequirements.memoryTypeBits;
+}
+
+auto SwapChain::bindDepthMemory(std::vector<vk::DeviceMemory> depthImageMemories) -> void
+{
+    _depthImageMemories = std::move(depthImageMemories);
+
+    for (auto i = size_t {}; i < _depthImages.size(); i++)
+    {
+        expect(_device.logicalDevice.bindImageMemory(_depthImages[i], _depthImageMemories[i], 0),
+               vk::Result::eSuccess,
+               "Failed to bind depth image memory");
+    }
+}
+
+auto SwapChain::destroyResources(const Device& device, const RetiredResources& resources) -> void
+{
+    for (const auto framebuffer : resources.frameBuffers)
+    {
+        device.logicalDevice.destroy(framebuffer);
+    }
+    for (const auto framebuffer : resources.presentFrameBuffers)
+    {
+        device.logicalDevice.destroy(framebuffer);
+    }
+    for (const auto imageView : resources.imageViews)
+    {
+        device.logicalDevice.destroy(imageView);
+    }
+    for (const auto imageView : resources.depthImageViews)
     {
-        _device.logicalDevice.destroy(framebuffer);
+        device.logicalDevice.destroy(imageView);
     }
-    for (const auto imageView : _swapChainImageViews)
+    for (const auto image : resources.depthImages)
     {
-        _device.logicalDevice.destroy(imageView);
+        device.logicalDevice.destroy(image);
     }
-    for (const auto image : _depthImages)
+    for (const auto imageMemory : resources.depthImageMemories)
     {
-        _device.logicalDevice.destroy(image);
+        device.logicalDevice.free(imageMemory);
     }
-    for (const auto imageView : _depthImageViews)
+    for (const auto& gBuffer : resources.gBuffers)
     {
-        _device.logicalDevice.destroy(imageView);
+        for (const auto& attachment : {gBuffer.albedo, gBuffer.normal})
+        {
+            device.logicalDevice.destroy(attachment.view);
+            device.logicalDevice.destroy(attachment.image);
+            device.logicalDevice.free(attachment.memory);
+        }
     }
-    for (const auto imageMemory : _depthImageMemories)
+    for (const auto& attachment : resources.sceneColors)
     {
-        _device.logicalDevice.free(imageMemory);
+        device.logicalDevice.destroy(attachment.view);
+        device.logicalDevice.destroy(attachment.image);
+        device.logicalDevice.free(attachment.memory);
     }
-    _device.logicalDevice.destroy(_swapChain);
+    for (const auto semaphore : resources.renderFinishedSemaphores)
+    {
+        device.logicalDevice.destroy(semaphore);
+    }
+    // Views of headless images are released together with the other swapchain image views
+    for (const auto& attachment : resources.headlessImages)
+    {
+        device.logicalDevice.destroy(attachment.image);
+        device.logicalDevice.free(attachment.memory);
+    }
+    device.logicalDevice.destroy(resources.swapChain);
 }
 
 auto SwapChain::createSwapChain(const vk::SurfaceKHR& surface,
                                 const vk::Extent2D extent,
                                 const Device& device,
-                                const vk::SurfaceFormatKHR& surfaceFormat) -> vk::SwapchainKHR
+                                const vk::SurfaceFormatKHR& surfaceFormat,
+                                const SwapChainConfig& config,
+                                vk::SwapchainKHR oldSwapChain) -> vk::SwapchainKHR
 {
     const auto swapChainSupport = device.querySwapChainSupport();
-    const auto presentationMode = choosePresentationMode(swapChainSupport.presentationModes);
+    const auto presentationMode = choosePresentationMode(swapChainSupport.presentationModes, config.presentMode);
+    const auto imageCount = chooseImageCount(swapChainSupport.capabilities, config.imageCount);
 
-    auto imageCount = swapChainSupport.capabilities.minImageCount + 1;
-    if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount)
+    auto imageUsage = vk::ImageUsageFlags {vk::ImageUsageFlagBits::eColorAttachment};
+    if (config.allowCapture)
     {
-        imageCount = swapChainSupport.capabilities.maxImageCount;
+        // Captured frames are copied straight out of the swapchain images
+        imageUsage |= swapChainSupport.capabilities.supportedUsageFlags & vk::ImageUsageFlagBits::eTransferSrc;
     }
 
     auto createInfo = vk::SwapchainCreateInfoKHR {{},
@@ -313,13 +829,14 @@ auto SwapChain::createSwapChain(const vk::SurfaceKHR& surface,
                                                   surfaceFormat.colorSpace,
                                                   extent,
                                                   1,
-                                                  vk::ImageUsageFlagBits::eColorAttachment,
+                                                  imageUsage,
                                                   {},
                                                   {},
                                                   swapChainSupport.capabilities.currentTransform,
                                                   vk::CompositeAlphaFlagBitsKHR::eOpaque,
                                                   presentationMode,
-                                                  vk::True};
+                                                  vk::True,
+                                                  oldSwapChain};
 
     if (device.queueFamilies.graphicsFamily != device.queueFamilies.presentationFamily)
     {
@@ -346,11 +863,56 @@ auto SwapChain::getFrameBuffer(size_t index) const noexcept -> const vk::Framebu
     return _swapChainFrameBuffers[index];
 }
 
+auto SwapChain::getPresentRenderPass() const noexcept -> const vk::RenderPass&
+{
+    return _presentRenderPass;
+}
+
+auto SwapChain::getPresentFrameBuffer(size_t index) const noexcept -> const vk::Framebuffer&
+{
+    return _presentFrameBuffers[index];
+}
+
+auto SwapChain::getSceneColor(size_t index) const noexcept -> const FrameBufferAttachment&
+{
+    return _sceneColors[index];
+}
+
+auto SwapChain::isRenderingOffscreen() const noexcept -> bool
+{
+    return _maxRenderScale.has_value();
+}
+
 auto SwapChain::getExtent() const noexcept -> const vk::Extent2D&
 {
     return _swapChainExtent;
 }
 
+auto SwapChain::getRenderTargetExtent() const noexcept -> const vk::Extent2D&
+{
+    return _renderTargetExtent;
+}
+
+auto SwapChain::getGBuffer(size_t index) const noexcept -> const GBuffer&
+{
+    return _gBuffers[index];
+}
+
+auto SwapChain::getDepthImage(size_t index) const noexcept -> vk::Image
+{
+    return _depthImages[index];
+}
+
+auto SwapChain::getDepthImageView(size_t index) const noexcept -> vk::ImageView
+{
+    return _depthImageViews[index];
+}
+
+auto SwapChain::getShadingMode() const noexcept -> ShadingMode
+{
+    return _shadingMode;
+}
+
 auto SwapChain::findDepthFormat(const Device& device) -> vk::Format
 {
     return expect(device.findSupportedFormat(
@@ -362,6 +924,13 @@ auto SwapChain::findDepthFormat(const Device& device) -> vk::Format
 
 auto SwapChain::acquireNextImage() -> std::optional<uint32_t>
 {
+    if (isHeadless())
+    {
+        // Offscreen images are used in turn and never resized, the previous use of the image is waited for on submit
+        waitForTimeline(_frameTimelineValues[_currentFrame]);
+        return static_cast<uint32_t>(_timelineValue % imagesCount());
+    }
+
     if (_frameBufferResized) [[unlikely]]
     {
         _frameBufferResized = false;
@@ -369,23 +938,19 @@ auto SwapChain::acquireNextImage() -> std::optional<uint32_t>
         return {};
     }
 
-    shouldBe(_device.logicalDevice.waitForFences(_inFlightFences[_currentFrame],
-                                                 vk::True,
-                                                 std::numeric_limits<uint64_t>::max()),
-             vk::Result::eSuccess,
-             "Waiting for the fences didn't succeed");
+    waitForTimeline(_frameTimelineValues[_currentFrame]);
 
     const auto imageIndex = _device.logicalDevice.acquireNextImageKHR(_swapChain,
                                                                       std::numeric_limits<uint64_t>::max(),
                                                                       _imageAvailableSemaphores[_currentFrame]);
 
-    if (imageIndex.result == vk::Result::eErrorOutOfDateKHR || imageIndex.result == vk::Result::eSuboptimalKHR)
-        [[unlikely]]
+    // A suboptimal image is still presentable and its semaphore gets signaled, the chain is recreated after present
+    if (imageIndex.result == vk::Result::eErrorOutOfDateKHR) [[unlikely]]
     {
         recreate();
         return {};
     }
-    else if (imageIndex.result != vk::Result::eSuccess) [[unlikely]]
+    else if (imageIndex.result != vk::Result::eSuccess && imageIndex.result != vk::Result::eSuboptimalKHR) [[unlikely]]
     {
         panic("Failed to acquire swap chain image");
     }
@@ -395,31 +960,36 @@ auto SwapChain::acquireNextImage() -> std::optional<uint32_t>
 
 auto SwapChain::submitCommandBuffers(const vk::CommandBuffer& commandBuffer, uint32_t imageIndex) -> void
 {
-    if (_imagesInFlight[imageIndex] != nullptr) [[likely]]
+    if (isHeadless())
     {
-        shouldBe(_device.logicalDevice.waitForFences(*_imagesInFlight[imageIndex],
-                                                     vk::True,
-                                                     std::numeric_limits<uint64_t>::max()),
-                 vk::Result::eSuccess,
-                 "Failed to wait for _imagesInFlight fence");
+        submitHeadless(commandBuffer, imageIndex);
+        return;
     }
-    _imagesInFlight[imageIndex] = &_inFlightFences[_currentFrame];
 
-    static constexpr auto waitStages =
-        std::array {vk::PipelineStageFlags {vk::PipelineStageFlagBits::eColorAttachmentOutput}};
-    const auto submitInfo = vk::SubmitInfo {_imageAvailableSemaphores[_currentFrame],
-                                            waitStages,
-                                            commandBuffer,
-                                            _renderFinishedSemaphores[_currentFrame]};
+    const auto signalValue = ++_timelineValue;
 
-    shouldBe(_device.logicalDevice.resetFences(_inFlightFences[_currentFrame]),
-             vk::Result::eSuccess,
-             "Failed to Reset inFlight fence");
-    shouldBe(_device.graphicsQueue.submit(submitInfo, _inFlightFences[_currentFrame]),
+    // Per-image attachments are still in use until the last frame that rendered to this image retires, the GPU
+    // waits for it on the timeline instead of blocking the CPU
+    static constexpr auto waitStages =
+        std::array {vk::PipelineStageFlags {vk::PipelineStageFlagBits::eColorAttachmentOutput},
+                    vk::PipelineStageFlags {vk::PipelineStageFlagBits::eAllCommands}};
+    const auto waitSemaphores = std::array {_imageAvailableSemaphores[_currentFrame], _frameTimeline};
+    const auto waitValues = std::array {uint64_t {}, _imageTimelineValues[imageIndex]};
+    const auto signalSemaphores = std::array {_renderFinishedSemaphores[imageIndex], _frameTimeline};
+    const auto signalValues = std::array {uint64_t {}, signalValue};
+
+    const auto timelineInfo = vk::TimelineSemaphoreSubmitInfo {waitValues, signalValues};
+    const auto submitInfo =
+        vk::SubmitInfo {waitSemaphores, waitStages, commandBuffer, signalSemaphores, &timelineInfo};
+
+    shouldBe(_device.graphicsQueue.submit(submitInfo),
              vk::Result::eSuccess,
              "Submitting the graphics queue didn't succeeded");
 
-    const auto presentInfo = vk::PresentInfoKHR {_renderFinishedSemaphores[_currentFrame], _swapChain, imageIndex};
+    _frameTimelineValues[_currentFrame] = signalValue;
+    _imageTimelineValues[imageIndex] = signalValue;
+
+    const auto presentInfo = vk::PresentInfoKHR {_renderFinishedSemaphores[imageIndex], _swapChain, imageIndex};
 
     const auto presentationResult = _device.presentationQueue.presentKHR(presentInfo);
 
@@ -433,7 +1003,117 @@ auto SwapChain::submitCommandBuffers(const vk::CommandBuffer& commandBuffer, uin
         log::Warning("Presenting the queue didn't succeeded: {}", presentationResult);
     }
 
-    _currentFrame = (_currentFrame + 1) % Context::maxFramesInFlight;
+    _currentFrame = static_cast<uint32_t>((_currentFrame + 1) % _config.framesInFlight);
+}
+
+auto SwapChain::submitHeadless(const vk::CommandBuffer& commandBuffer, uint32_t imageIndex) -> void
+{
+    const auto signalValue = ++_timelineValue;
+
+    // There is nothing to acquire or present, so the timeline alone orders the frames
+    const auto waitStage = vk::PipelineStageFlags {vk::PipelineStageFlagBits::eAllCommands};
+    const auto waitValue = _imageTimelineValues[imageIndex];
+    const auto timelineInfo = vk::TimelineSemaphoreSubmitInfo {waitValue, signalValue};
+    const auto submitInfo = vk::SubmitInfo {_frameTimeline, waitStage, commandBuffer, _frameTimeline, &timelineInfo};
+
+    shouldBe(_device.graphicsQueue.submit(submitInfo),
+             vk::Result::eSuccess,
+             "Submitting the graphics queue didn't succeeded");
+
+    _frameTimelineValues[_currentFrame] = signalValue;
+    _imageTimelineValues[imageIndex] = signalValue;
+    _currentFrame = static_cast<uint32_t>((_currentFrame + 1) % _config.framesInFlight);
+}
+
+auto SwapChain::recordReadback(vk::CommandBuffer commandBuffer, uint32_t imageIndex) const -> void
+{
+    const auto toTransfer = vk::ImageMemoryBarrier {
+        vk::AccessFlagBits::eColorAttachmentWrite,
+        vk::AccessFlagBits::eTransferRead,
+        vk::ImageLayout::eColorAttachmentOptimal,
+        vk::ImageLayout::eTransferSrcOptimal,
+        vk::QueueFamilyIgnored,
+        vk::QueueFamilyIgnored,
+        _swapChainImages[imageIndex],
+        {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
+    };
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                                  vk::PipelineStageFlagBits::eTransfer,
+                                  {},
+                                  {},
+                                  {},
+                                  toTransfer);
+
+    const auto region = vk::BufferImageCopy {
+        0,
+        0,
+        0,
+        {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
+        {0, 0, 0},
+        {_swapChainExtent.width, _swapChainExtent.height, 1}
+    };
+    commandBuffer.copyImageToBuffer(_swapChainImages[imageIndex],
+                                    vk::ImageLayout::eTransferSrcOptimal,
+                                    _readbackBuffers[imageIndex]->buffer,
+                                    region);
+
+    const auto toHost = vk::MemoryBarrier {vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead};
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, toHost, {}, {});
+}
+
+auto SwapChain::readFrame() const -> std::optional<FrameReadback>
+{
+    if (!isHeadless() || _timelineValue == 0)
+    {
+        return {};
+    }
+
+    waitForTimeline(_timelineValue);
+
+    // The pixels stay valid until the image is rendered to again, which is imagesCount() frames later
+    const auto& buffer = *_readbackBuffers[(_timelineValue - 1) % imagesCount()];
+    return FrameReadback {
+        .extent = _swapChainExtent,
+        .format = _swapChainImageFormat.format,
+        .pixels = {static_cast<const std::byte*>(buffer.getMappedMemory()), static_cast<size_t>(buffer.size)}
+    };
+}
+
+auto SwapChain::isHeadless() const noexcept -> bool
+{
+    return !_surface;
+}
+
+auto SwapChain::isCaptureSupported() const -> bool
+{
+    return isHeadless() || (_config.allowCapture && isTransferSourceSupported(_device));
+}
+
+auto SwapChain::getImage(size_t index) const noexcept -> vk::Image
+{
+    return _swapChainImages[index];
+}
+
+auto SwapChain::getImageFormat() const noexcept -> vk::Format
+{
+    return _swapChainImageFormat.format;
+}
+
+auto SwapChain::getFrameTimeline() const noexcept -> vk::Semaphore
+{
+    return _frameTimeline;
+}
+
+auto SwapChain::getPendingTimelineValue() const noexcept -> uint64_t
+{
+    return _timelineValue + 1;
+}
+
+auto SwapChain::getOutputLayout() const noexcept -> vk::ImageLayout
+{
+    // Headless images stay attachments until the readback transitions them for the copy
+    return isHeadless() ? vk::ImageLayout::eColorAttachmentOptimal : vk::ImageLayout::ePresentSrcKHR;
 }
 
 auto SwapChain::imagesCount() const noexcept -> size_t
@@ -441,14 +1121,25 @@ auto SwapChain::imagesCount() const noexcept -> size_t
     return _swapChainImages.size();
 }
 
+auto SwapChain::getFramesInFlight() const noexcept -> size_t
+{
+    return _config.framesInFlight;
+}
+
 auto SwapChain::createDepthImages(const Device& device,
                                   vk::Extent2D swapChainExtent,
                                   size_t imagesCount,
-                                  const vk::SurfaceFormatKHR& depthFormat) -> std::vector<vk::Image>
+                                  const vk::SurfaceFormatKHR& depthFormat,
+                                  ShadingMode shadingMode) -> std::vector<vk::Image>
 {
     auto depthImages = std::vector<vk::Image> {};
     depthImages.reserve(imagesCount);
 
+    static constexpr auto baseUsage =
+        vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled;
+    const auto usage =
+        shadingMode == ShadingMode::Deferred ? baseUsage | vk::ImageUsageFlagBits::eInputAttachment : baseUsage;
+
     for (auto i = size_t {}; i < imagesCount; i++)
     {
         const auto imageInfo = vk::ImageCreateInfo {
@@ -460,7 +1151,7 @@ auto SwapChain::createDepthImages(const Device& device,
             1,
             vk::SampleCountFlagBits::e1,
             vk::ImageTiling::eOptimal,
-            vk::ImageUsageFlagBits::eDepthStencilAttachment,
+            usage,
             vk::SharingMode::eExclusive
         };
         depthImages.push_back(
@@ -518,6 +1209,85 @@ auto SwapChain::createDepthImageMemories(const Device& device,
     return depthImageMemories;
 }
 
+auto SwapChain::createGBuffers(const Device& device,
+                               vk::Extent2D swapChainExtent,
+                               size_t imagesCount,
+                               ShadingMode shadingMode) -> std::vector<GBuffer>
+{
+    if (shadingMode != ShadingMode::Deferred)
+    {
+        return {};
+    }
+
+    static constexpr auto usage = vk::ImageUsageFlagBits::eColorAttachment |
+                                  vk::ImageUsageFlagBits::eInputAttachment |
+                                  vk::ImageUsageFlagBits::eTransientAttachment;
+    static constexpr auto aspect = vk::ImageAspectFlagBits::eColor;
+
+    auto gBuffers = std::vector<GBuffer> {};
+    gBuffers.reserve(imagesCount);
+
+    for (auto i = size_t {}; i < imagesCount; i++)
+    {
+        gBuffers.push_back({.albedo = createAttachment(device, swapChainExtent, albedoFormat, usage, aspect),
+                            .normal = createAttachment(device, swapChainExtent, normalFormat, usage, aspect)});
+    }
+    return gBuffers;
+}
+
+auto SwapChain::createAttachment(const Device& device,
+                                 vk::Extent2D extent,
+                                 vk::Format format,
+                                 vk::ImageUsageFlags usage,
+                                 vk::ImageAspectFlags aspect) -> FrameBufferAttachment
+{
+    const auto imageInfo = vk::ImageCreateInfo {
+        {},
+        vk::ImageType::e2D,
+        format,
+        {extent.width, extent.height, 1},
+        1,
+        1,
+        vk::SampleCountFlagBits::e1,
+        vk::ImageTiling::eOptimal,
+        usage,
+        vk::SharingMode::eExclusive
+    };
+    const auto image =
+        expect(device.logicalDevice.createImage(imageInfo), vk::Result::eSuccess, "Failed to create attachment image");
+
+    const auto memoryRequirements = device.logicalDevice.getImageMemoryRequirements(image);
+    const auto lazyMemoryType =
+        device.findMemoryType(memoryRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eLazilyAllocated);
+    const auto memoryType =
+        lazyMemoryType.has_value()
+            ? lazyMemoryType.value()
+            : expect(device.findMemoryType(memoryRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal),
+                     "Failed to find memory type");
+
+    const auto allocInfo = vk::MemoryAllocateInfo {memoryRequirements.size, memoryType};
+    const auto memory = expect(device.logicalDevice.allocateMemory(allocInfo),
+                               vk::Result::eSuccess,
+                               "Failed to allocate attachment memory");
+    expect(device.logicalDevice.bindImageMemory(image, memory, 0),
+           vk::Result::eSuccess,
+           "Failed to bind attachment memory");
+
+    const auto viewInfo = vk::ImageViewCreateInfo {
+        {},
+        image,
+        vk::ImageViewType::e2D,
+        format,
+        {},
+        {aspect, 0, 1, 0, 1}
+    };
+    const auto view = expect(device.logicalDevice.createImageView(viewInfo),
+                             vk::Result::eSuccess,
+                             "Failed to create attachment image view");
+
+    return {.image = image, .memory = memory, .view = view};
+}
+
 auto SwapChain::getExtentAspectRatio() const noexcept -> float
 {
     return static_cast<float>(_swapChainExtent.width) / static_cast<float>(_swapChainExtent.height);
@@ -0,0 +1,273 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/geometric.hpp>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/Logger.h"
+#include "panda/gfx/Camera.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/object/Mesh.h"
+#include "panda/gfx/vulkan/object/Object.h"
+#include "panda/gfx/vulkan/object/Texture.h"
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+auto getProjectedSize(const Camera& camera, const Transform& transform, const Mesh& mesh, float viewportHeight)
+    -> float
+{
+    const auto& boundingSphere = mesh.getBoundingSphere();
+    const auto maxScale =
+        std::max({std::abs(transform.scale.x), std::abs(transform.scale.y), std::abs(transform.scale.z)});
+    const auto radius = (glm::length(boundingSphere.center) + boundingSphere.radius) * maxScale;
+
+    const auto& projection = camera.getProjection();
+    const auto isPerspective = projection[2][3] != 0.F;
+
+    if (!isPerspective)
+    {
+        return radius * projection[1][1] * viewportHeight;
+    }
+
+    const auto viewCenter = camera.getView() * glm::vec4 {transform.translation, 1.F};
+    const auto distance = viewCenter.z;
+
+    if (distance <= radius)
+    {
+        return viewportHeight;
+    }
+
+    return radius * std::abs(projection[1][1]) * viewportHeight / distance;
+}
+
+auto getDesiredMipLevel(const Texture& texture, float projectedSize) -> uint32_t
+{
+    const auto textureSize = static_cast<float>(std::max(texture.getWidth(), texture.getHeight()));
+    const auto ratio = textureSize / std::max(projectedSize, 1.F);
+    const auto level = ratio > 1.F ? static_cast<uint32_t>(std::floor(std::log2(ratio))) : uint32_t {};
+
+    return std::min(level, texture.getTailMipLevel());
+}
+
+}
+
+TextureStreamer::TextureStreamer(DeletionQueue& deletionQueue, vk::DeviceSize budget)
+    : _deletionQueue {deletionQueue},
+      _budget {budget}
+{
+    log::Info("Texture streaming budget: {} MiB", _budget / (1024 * 1024));
+}
+
+auto TextureStreamer::getDefaultBudget(const Device& device) -> vk::DeviceSize
+{
+    const auto memoryProperties = device.physicalDevice.getMemoryProperties();
+    const auto heaps = std::span {memoryProperties.memoryHeaps.data(), memoryProperties.memoryHeapCount};
+
+    auto largestDeviceHeap = vk::DeviceSize {};
+    for (const auto& heap : heaps)
+    {
+        if (heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal)
+        {
+            largestDeviceHeap = std::max(largestDeviceHeap, heap.size);
+        }
+    }
+
+    return largestDeviceHeap / 2;
+}
+
+auto TextureStreamer::addTexture(Texture& texture) -> void
+{
+    if (!texture.isStreamed())
+    {
+        return;
+    }
+
+    _entries.insert({
+        &texture,
+        Entry {.texture = &texture, .lastUsedFrame = 0, .desiredMipLevel = texture.getBaseMipLevel()}
+    });
+    _residentSize += texture.getResidentSize(texture.getBaseMipLevel());
+}
+
+auto TextureStreamer::update(vk::CommandBuffer commandBuffer, const Scene& scene, vk::Extent2D extent) -> void
+{
+    _currentFrame++;
+    gatherFeedback(scene, extent);
+
+    auto candidates = std::vector<Entry*> {};
+    for (auto& entry : _entries | std::views::values)
+    {
+        if (entry.lastUsedFrame == _currentFrame && entry.desiredMipLevel < entry.texture->getBaseMipLevel())
+        {
+            candidates.push_back(&entry);
+        }
+    }
+
+    std::ranges::sort(candidates, [](const auto* lhs, const auto* rhs) {
+        return lhs->texture->getBaseMipLevel() - lhs->desiredMipLevel >
+               rhs->texture->getBaseMipLevel() - rhs->desiredMipLevel;
+    });
+
+    auto uploads = uint32_t {};
+    for (auto* candidate : candidates)
+    {
+        if (uploads == maxUploadsPerFrame)
+        {
+            break;
+        }
+
+        const auto& texture = *candidate->texture;
+        const auto nextMipLevel = texture.getBaseMipLevel() - 1;
+        const auto requiredSize =
+            texture.getResidentSize(nextMipLevel) - texture.getResidentSize(texture.getBaseMipLevel());
+
+        if (_residentSize + requiredSize > _budget && !evict(commandBuffer, _residentSize + requiredSize - _budget))
+        {
+            continue;
+        }
+
+        setBaseMipLevel(commandBuffer, *candidate, nextMipLevel);
+        uploads++;
+    }
+
+    _hasPendingUploads = uploads > 0;
+}
+
+auto TextureStreamer::gatherFeedback(const Scene& scene, vk::Extent2D extent) -> void
+{
+    const auto viewportHeight = static_cast<float>(extent.height);
+
+    for (const auto& object : scene.getObjects())
+    {
+        for (const auto& surface : object->getSurfaces())
+        {
+            const auto it = _entries.find(&surface.getTexture());
+            if (it == _entries.end())
+            {
+                continue;
+            }
+
+            auto& entry = it->second;
+            const auto projectedSize =
+                getProjectedSize(scene.getCamera(), object->transform, surface.getMesh(), viewportHeight);
+            const auto desiredMipLevel = getDesiredMipLevel(*entry.texture, projectedSize);
+
+            if (entry.lastUsedFrame != _currentFrame)
+            {
+                entry.lastUsedFrame = _currentFrame;
+                entry.desiredMipLevel = desiredMipLevel;
+            }
+            else
+            {
+                entry.desiredMipLevel = std::min(entry.desiredMipLevel, desiredMipLevel);
+            }
+        }
+    }
+}
+
+auto TextureStreamer::setBaseMipLevel(vk::CommandBuffer commandBuffer, Entry& entry, uint32_t baseMipLevel) -> void
+{
+    auto& texture = *entry.texture;
+    _residentSize -= texture.getResidentSize(texture.getBaseMipLevel());
+    texture.setBaseMipLevel(commandBuffer, baseMipLevel, _deletionQueue);
+    _residentSize += texture.getResidentSize(texture.getBaseMipLevel());
+}
+
+auto TextureStreamer::evict(vk::CommandBuffer commandBuffer, vk::DeviceSize requiredSize) -> bool
+{
+    auto candidates = std::vector<Entry*> {};
+    for (auto& entry : _entries | std::views::values)
+    {
+        const auto lowestMipLevel =
+            entry.lastUsedFrame == _currentFrame ? entry.desiredMipLevel : entry.texture->getTailMipLevel();
+        if (entry.texture->getBaseMipLevel() < lowestMipLevel)
+        {
+            candidates.push_back(&entry);
+        }
+    }
+
+    std::ranges::sort(candidates, {}, &Entry::lastUsedFrame);
+
+    auto evictions = std::vector<std::pair<Entry*, uint32_t>> {};
+    auto freedSize = vk::DeviceSize {};
+    for (auto* candidate : candidates)
+    {
+        if (freedSize >= requiredSize)
+        {
+            break;
+        }
+
+        const auto& texture = *candidate->texture;
+        const auto lowestMipLevel =
+            candidate->lastUsedFrame == _currentFrame ? candidate->desiredMipLevel : texture.getTailMipLevel();
+        auto mipLevel = texture.getBaseMipLevel();
+
+        while (mipLevel < lowestMipLevel &&
+               freedSize + texture.getResidentSize(texture.getBaseMipLevel()) - texture.getResidentSize(mipLevel) <
+                   requiredSize)
+        {
+            mipLevel++;
+        }
+
+        freedSize += texture.getResidentSize(texture.getBaseMipLevel()) - texture.getResidentSize(mipLevel);
+        evictions.emplace_back(candidate, mipLevel);
+    }
+
+    // Evicting without reaching the required size would only lose detail, the upload is skipped anyway
+    if (freedSize < requiredSize)
+    {
+        return false;
+    }
+
+    for (const auto [entry, mipLevel] : evictions)
+    {
+        setBaseMipLevel(commandBuffer, *entry, mipLevel);
+    }
+
+    log::Debug("Evicted {} bytes of texture mip levels", freedSize);
+    return true;
+}
+
+auto TextureStreamer::setBudget(vk::DeviceSize budget) noexcept -> void
+{
+    _budget = budget;
+}
+
+auto TextureStreamer::getBudget() const noexcept -> vk::DeviceSize
+{
+    return _budget;
+}
+
+auto TextureStreamer::getResidentSize() const noexcept -> vk::DeviceSize
+{
+    return _residentSize;
+}
+
+auto TextureStreamer::hasPendingUploads() const noexcept -> bool
+{
+    return _hasPendingUploads;
+}
+
+}
@@ -0,0 +1,60 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/UniformRingAllocator.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Device.h"
+
+namespace panda::gfx::vulkan
+{
+
+UniformRingAllocator::UniformRingAllocator(const Device& device, vk::DeviceSize frameSize, size_t framesInFlight)
+    : _alignment {device.physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment}
+{
+    _frameSize = (frameSize + _alignment - 1) / _alignment * _alignment;
+    _buffer = std::make_unique<Buffer>(device,
+                                       _frameSize * framesInFlight,
+                                       vk::BufferUsageFlagBits::eUniformBuffer,
+                                       vk::MemoryPropertyFlagBits::eHostVisible |
+                                           vk::MemoryPropertyFlagBits::eHostCoherent);
+    _buffer->mapWhole();
+}
+
+auto UniformRingAllocator::beginFrame(uint32_t frameIndex) -> void
+{
+    _highWaterMark = std::max(_highWaterMark, _head.load(std::memory_order_relaxed));
+    _frameOffset = frameIndex * _frameSize;
+    _head.store(0, std::memory_order_relaxed);
+}
+
+auto UniformRingAllocator::allocate(vk::DeviceSize dataSize) -> Allocation
+{
+    const auto alignedSize = (dataSize + _alignment - 1) / _alignment * _alignment;
+    const auto offset = _head.fetch_add(alignedSize, std::memory_order_relaxed);
+    expect(offset + alignedSize <= _frameSize,
+           fmt::format("Uniform allocation with size: {} doesn't fit in frame with size: {} and offset: {}",
+                       dataSize,
+                       _frameSize,
+                       offset));
+
+    return {.descriptorInfo = _buffer->getDescriptorInfoAt(dataSize, _frameOffset + offset),
+            .data = static_cast<char*>(_buffer->getMappedMemory()) + _frameOffset + offset};
+}
+
+auto UniformRingAllocator::getHighWaterMark() const noexcept -> vk::DeviceSize
+{
+    return std::max(_highWaterMark, _head.load(std::memory_order_relaxed));
+}
+
+}
@@ -4,35 +4,134 @@
 
 #include "panda/gfx/vulkan/object/Mesh.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <iterator>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/geometric.hpp>
 #include <memory>
+#include <numeric>
+#include <ranges>
 #include <span>
 #include <string>
 #include <utility>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
 #include "panda/Logger.h"
 #include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
 #include "panda/gfx/vulkan/Device.h"
 #include "panda/gfx/vulkan/Vertex.h"
 
 namespace panda::gfx::vulkan
 {
 
-Mesh::Mesh(std::string name, const Device& device, std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+namespace
+{
+
+template <std::ranges::range T>
+auto createDeviceLocalBuffer(const Device& device,
+                             const Mesh::Upload* upload,
+                             const T& data,
+                             vk::BufferUsageFlags usage,
+                             vk::AccessFlags dstAccess) -> std::unique_ptr<Buffer>
+{
+    auto stagingBuffer =
+        std::make_shared<Buffer>(device,
+                                 data,
+                                 vk::BufferUsageFlagBits::eTransferSrc,
+                                 vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    auto deviceBuffer = std::make_unique<Buffer>(device,
+                                                 stagingBuffer->size,
+                                                 usage | vk::BufferUsageFlagBits::eTransferDst,
+                                                 vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    if (upload == nullptr)
+    {
+        Buffer::copy(*stagingBuffer, *deviceBuffer);
+        return deviceBuffer;
+    }
+
+    upload->commandBuffer.copyBuffer(stagingBuffer->buffer,
+                                     deviceBuffer->buffer,
+                                     vk::BufferCopy {{}, {}, stagingBuffer->size});
+
+    const auto barrier = vk::BufferMemoryBarrier {vk::AccessFlagBits::eTransferWrite,
+                                                  dstAccess,
+                                                  vk::QueueFamilyIgnored,
+                                                  vk::QueueFamilyIgnored,
+                                                  deviceBuffer->buffer,
+                                                  0,
+                                                  vk::WholeSize};
+    upload->commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eVertexInput, {}, {}, barrier, {});
+
+    upload->deletionQueue.push([stagingBuffer = std::move(stagingBuffer)] {});
+    return deviceBuffer;
+}
+
+}
+
+Mesh::Mesh(std::string name,
+           const Device& device,
+           std::span<const Vertex> vertices,
+           std::span<const uint32_t> indices,
+           bool createPositionStream,
+           bool keepOccluderGeometry,
+           bool keepGeometry)
+    : Mesh {std::move(name),
+            device,
+            nullptr,
+            vertices,
+            indices,
+            createPositionStream,
+            keepOccluderGeometry,
+            keepGeometry}
+{
+}
+
+Mesh::Mesh(std::string name,
+           const Device& device,
+           const Upload& upload,
+           std::span<const Vertex> vertices,
+           std::span<const uint32_t> indices,
+           bool createPositionStream)
+    : Mesh {std::move(name), device, &upload, vertices, indices, createPositionStream, false, false}
+{
+}
+
+Mesh::Mesh(std::string name,
+           const Device& device,
+           const Upload* upload,
+           std::span<const Vertex> vertices,
+           std::span<const uint32_t> indices,
+           bool createPositionStream,
+           bool keepOccluderGeometry,
+           bool keepGeometry)
     : _device {device},
       _name {std::move(name)},
-      _vertexBuffer {createVertexBuffer(_device, vertices)},
-      _indexBuffer {createIndexBuffer(_device, indices)},
+      _vertexBuffer {createVertexBuffer(_device, upload, vertices)},
+      _positionBuffer {createPositionStream ? createPositionBuffer(_device, upload, vertices) : nullptr},
+      _indexBuffer {createIndexBuffer(_device, upload, indices)},
       _vertexCount {static_cast<uint32_t>(vertices.size())},
-      _indexCount {static_cast<uint32_t>(indices.size())}
+      _indexCount {static_cast<uint32_t>(indices.size())},
+      _boundingBox {computeBoundingBox(vertices)},
+      _boundingSphere {computeBoundingSphere(vertices, _boundingBox)},
+      _occluderGeometry {keepOccluderGeometry ? createOccluderGeometry(vertices, indices) : OccluderGeometry {}},
+      _geometry {keepGeometry ? MeshGeometry {.vertices = {vertices.begin(), vertices.end()},
+                                              .indices = {indices.begin(), indices.end()}}
+                              : MeshGeometry {}},
+      _id {currentId++}
 {
     log::Info("Created Mesh with {} vertices and {} indices", _vertexCount, _indexCount);
 }
 
-auto Mesh::createVertexBuffer(const Device& device, std::span<const Vertex> vertices) -> std::unique_ptr<Buffer>
+auto Mesh::createVertexBuffer(const Device& device, const Upload* upload, std::span<const Vertex> vertices)
+    -> std::unique_ptr<Buffer>
 {
     expect(
         vertices.size(),
@@ -41,21 +140,25 @@ auto Mesh::createVertexBuffer(const Device& device, std::span<const Vertex> vert
         },
         "Vertices size should be greater or equal to 3");
 
-    const auto stagingBuffer =
-        Buffer {device,
-                vertices,
-                vk::BufferUsageFlagBits::eTransferSrc,
-                vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent};
-
-    auto newVertexBuffer =
-        std::make_unique<Buffer>(device,
-                                 stagingBuffer.size,
-                                 vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-                                 vk::MemoryPropertyFlagBits::eDeviceLocal);
+    return createDeviceLocalBuffer(device,
+                                   upload,
+                                   vertices,
+                                   vk::BufferUsageFlagBits::eVertexBuffer,
+                                   vk::AccessFlagBits::eVertexAttributeRead);
+}
 
-    Buffer::copy(stagingBuffer, *newVertexBuffer);
+auto Mesh::createPositionBuffer(const Device& device, const Upload* upload, std::span<const Vertex> vertices)
+    -> std::unique_ptr<Buffer>
+{
+    auto positions = std::vector<glm::vec3> {};
+    positions.reserve(vertices.size());
+    std::ranges::transform(vertices, std::back_inserter(positions), &Vertex::position);
 
-    return newVertexBuffer;
+    return createDeviceLocalBuffer(device,
+                                   upload,
+                                   positions,
+                                   vk::BufferUsageFlagBits::eVertexBuffer,
+                                   vk::AccessFlagBits::eVertexAttributeRead);
 }
 
 auto Mesh::bind(const vk::CommandBuffer& commandBuffer) const -> void
@@ -68,6 +171,22 @@ auto Mesh::bind(const vk::CommandBuffer& commandBuffer) const -> void
     }
 }
 
+auto Mesh::bindPositions(const vk::CommandBuffer& commandBuffer) const -> void
+{
+    if (_positionBuffer == nullptr)
+    {
+        bind(commandBuffer);
+        return;
+    }
+
+    commandBuffer.bindVertexBuffers(0, _positionBuffer->buffer, {0});
+
+    if (_indexBuffer != nullptr)
+    {
+        commandBuffer.bindIndexBuffer(_indexBuffer->buffer, 0, vk::IndexType::eUint32);
+    }
+}
+
 auto Mesh::draw(const vk::CommandBuffer& commandBuffer) const -> void
 {
     if (_indexBuffer != nullptr)
@@ -92,7 +211,32 @@ auto Mesh::drawInstanced(const vk::CommandBuffer& commandBuffer, uint32_t instan
     }
 }
 
-auto Mesh::createIndexBuffer(const Device& device, const std::span<const uint32_t> indices) -> std::unique_ptr<Buffer>
+auto Mesh::drawIndirect(const vk::CommandBuffer& commandBuffer, vk::Buffer buffer, vk::DeviceSize offset) const
+    -> void
+{
+    if (_indexBuffer != nullptr)
+    {
+        commandBuffer.drawIndexedIndirect(buffer, offset, 1, sizeof(vk::DrawIndexedIndirectCommand));
+    }
+    else
+    {
+        commandBuffer.drawIndirect(buffer, offset, 1, sizeof(vk::DrawIndexedIndirectCommand));
+    }
+}
+
+auto Mesh::getIndirectCommand(uint32_t firstInstance) const noexcept -> vk::DrawIndexedIndirectCommand
+{
+    if (_indexBuffer != nullptr)
+    {
+        return {_indexCount, 0, 0, 0, firstInstance};
+    }
+
+    // Non-indexed meshes reuse the slot as vk::DrawIndirectCommand, whose firstInstance overlaps vertexOffset
+    return {_vertexCount, 0, 0, static_cast<int32_t>(firstInstance), 0};
+}
+
+auto Mesh::createIndexBuffer(const Device& device, const Upload* upload, const std::span<const uint32_t> indices)
+    -> std::unique_ptr<Buffer>
 {
     if (indices.empty())
     {
@@ -109,21 +253,13 @@ auto Mesh::createIndexBuffer(const Device& device, const std::span<const uint32_
         return nullptr;
     }
 
-    const auto stagingBuffer =
-        Buffer {device,
-                indices,
-                vk::BufferUsageFlagBits::eTransferSrc,
-                vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent};
-
-    auto newIndexBuffer =
-        std::make_unique<Buffer>(device,
-                                 stagingBuffer.size,
-                                 vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst,
-                                 vk::MemoryPropertyFlagBits::eDeviceLocal);
-
-    Buffer::copy(stagingBuffer, *newIndexBuffer);
+    return createDeviceLocalBuffer(
+        device, upload, indices, vk::BufferUsageFlagBits::eIndexBuffer, vk::AccessFlagBits::eIndexRead);
+}
 
-    return newIndexBuffer;
+auto Mesh::getId() const noexcept -> Id
+{
+    return _id;
 }
 
 auto Mesh::getName() const noexcept -> const std::string&
@@ -131,4 +267,76 @@ auto Mesh::getName() const noexcept -> const std::string&
     return _name;
 }
 
+auto Mesh::getBoundingBox() const noexcept -> const BoundingBox&
+{
+    return _boundingBox;
+}
+
+auto Mesh::getBoundingSphere() const noexcept -> const BoundingSphere&
+{
+    return _boundingSphere;
+}
+
+auto Mesh::hasPositionStream() const noexcept -> bool
+{
+    return _positionBuffer != nullptr;
+}
+
+auto Mesh::getOccluderGeometry() const noexcept -> const OccluderGeometry&
+{
+    return _occluderGeometry;
+}
+
+auto Mesh::getGeometry() const noexcept -> const MeshGeometry&
+{
+    return _geometry;
+}
+
+auto Mesh::createOccluderGeometry(std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+    -> OccluderGeometry
+{
+    auto geometry = OccluderGeometry {};
+    geometry.positions.reserve(vertices.size());
+    std::ranges::transform(vertices, std::back_inserter(geometry.positions), &Vertex::position);
+
+    if (indices.empty())
+    {
+        geometry.indices.resize(vertices.size() - vertices.size() % 3);
+        std::iota(geometry.indices.begin(), geometry.indices.end(), uint32_t {});
+    }
+    else
+    {
+        geometry.indices.assign(indices.begin(), indices.end());
+    }
+
+    return geometry;
+}
+
+auto Mesh::computeBoundingBox(std::span<const Vertex> vertices) noexcept -> BoundingBox
+{
+    auto result = BoundingBox {.min = vertices.front().position, .max = vertices.front().position};
+
+    for (const auto& vertex : vertices)
+    {
+        result.min = glm::min(result.min, vertex.position);
+        result.max = glm::max(result.max, vertex.position);
+    }
+
+    return result;
+}
+
+auto Mesh::computeBoundingSphere(std::span<const Vertex> vertices, const BoundingBox& boundingBox) noexcept
+    -> BoundingSphere
+{
+    const auto center = (boundingBox.min + boundingBox.max) / 2.F;
+    auto radius = 0.F;
+
+    for (const auto& vertex : vertices)
+    {
+        radius = std::max(radius, glm::distance(center, vertex.position));
+    }
+
+    return {.center = center, .radius = radius};
+}
+
 }
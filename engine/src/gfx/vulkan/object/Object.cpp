@@ -12,9 +12,14 @@
 #include <bit>
 #include <cstdint>
 #include <filesystem>
+#include <glm/ext/matrix_float3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/rotate_vector.hpp>
+#include <glm/matrix.hpp>
 #include <memory>
 #include <span>
 #include <string>
@@ -104,6 +109,21 @@ auto getTextureCache(Context& context, const aiScene& scene, const std::filesyst
 
 }
 
+auto Transform::getRotationMatrix() const -> glm::mat3
+{
+    // Same rotation as eulerToQuat and quatToMat3 in utils.glsl
+    return glm::transpose(glm::mat3_cast(glm::quat {rotation}));
+}
+
+auto Transform::getModelMatrix() const -> glm::mat4
+{
+    const auto rotationMatrix = getRotationMatrix();
+    return {glm::vec4 {rotationMatrix[0] * scale.x, 0.F},
+            glm::vec4 {rotationMatrix[1] * scale.y, 0.F},
+            glm::vec4 {rotationMatrix[2] * scale.z, 0.F},
+            glm::vec4 {translation, 1.F}};
+}
+
 auto Object::getId() const noexcept -> Id
 {
     return _id;
@@ -149,7 +169,13 @@ auto Object::loadSurfaces(Context& context, const std::filesystem::path& path, b
         getIndices(*currentMesh, indices);
         getVertices(*currentMesh, vertices);
 
-        auto mesh = std::make_unique<Mesh>(currentMesh->mName.C_Str(), context.getDevice(), vertices, indices);
+        auto mesh = std::make_unique<Mesh>(currentMesh->mName.C_Str(),
+                                           context.getDevice(),
+                                           vertices,
+                                           indices,
+                                           context.isDepthPrepassEnabled(),
+                                           context.isSoftwareOcclusionEnabled() && !shouldBeInstanced,
+                                           context.isStaticBatchingEnabled() && !shouldBeInstanced);
 
         result.emplace_back(textureCache.at(currentMesh->mMaterialIndex), mesh.get(), shouldBeInstanced);
 
@@ -13,50 +13,92 @@
 #include <filesystem>
 #include <glm/ext/vector_float4.hpp>
 #include <memory>
+#include <optional>
 #include <span>
 #include <string>
+#include <utility>
 #include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_handles.hpp>
 #include <vulkan/vulkan_structs.hpp>
 
+#include "panda/Logger.h"
 #include "panda/gfx/vulkan/Buffer.h"
 #include "panda/gfx/vulkan/CommandBuffer.h"
 #include "panda/gfx/vulkan/Context.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
 #include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/object/TextureData.h"
 #include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
 namespace panda::gfx::vulkan
 {
 
 namespace
 {
-auto copyBufferToImage(const Device& device, const Buffer& buffer, vk::Image image, uint32_t width, uint32_t height)
-    -> void
+auto copyBufferToImage(vk::CommandBuffer commandBuffer,
+                       const Buffer& buffer,
+                       vk::Image image,
+                       const TextureData& textureData,
+                       uint32_t baseMipLevel,
+                       uint32_t endMipLevel) -> void
 {
-    const auto commandBuffer = CommandBuffer::beginSingleTimeCommandBuffer(device);
+    const auto baseOffset = textureData.mipLevels[baseMipLevel].offset;
 
-    const auto region = vk::BufferImageCopy {
-        0,
-        0,
-        0,
-        {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
-        {0, 0, 0},
-        {width, height, 1}
-    };
-    commandBuffer.copyBufferToImage(buffer.buffer, image, vk::ImageLayout::eTransferDstOptimal, region);
-    CommandBuffer::endSingleTimeCommandBuffer(device, commandBuffer);
+    auto regions = std::vector<vk::BufferImageCopy> {};
+    regions.reserve(endMipLevel - baseMipLevel);
+
+    for (auto level = baseMipLevel; level < endMipLevel; level++)
+    {
+        const auto& mipLevel = textureData.mipLevels[level];
+        regions.emplace_back(mipLevel.offset - baseOffset,
+                             0,
+                             0,
+                             vk::ImageSubresourceLayers {vk::ImageAspectFlagBits::eColor, level - baseMipLevel, 0, 1},
+                             vk::Offset3D {0, 0, 0},
+                             vk::Extent3D {mipLevel.width, mipLevel.height, 1});
+    }
+
+    commandBuffer.copyBufferToImage(buffer.buffer, image, vk::ImageLayout::eTransferDstOptimal, regions);
 }
 
-auto transitionImageLayout(const Device& device, vk::Image image, vk::ImageLayout oldLayout, vk::ImageLayout newLayout)
-    -> void
+auto copyImageToImage(vk::CommandBuffer commandBuffer,
+                      vk::Image sourceImage,
+                      uint32_t sourceBaseMipLevel,
+                      vk::Image destinationImage,
+                      uint32_t destinationBaseMipLevel,
+                      const TextureData& textureData) -> void
 {
-    const auto commandBuffer = CommandBuffer::beginSingleTimeCommandBuffer(device);
+    const auto firstMipLevel = std::max(sourceBaseMipLevel, destinationBaseMipLevel);
+
+    auto regions = std::vector<vk::ImageCopy> {};
+    regions.reserve(textureData.mipLevels.size() - firstMipLevel);
+
+    for (auto level = firstMipLevel; level < textureData.mipLevels.size(); level++)
+    {
+        const auto& mipLevel = textureData.mipLevels[level];
+        regions.emplace_back(
+            vk::ImageSubresourceLayers {vk::ImageAspectFlagBits::eColor, level - sourceBaseMipLevel, 0, 1},
+            vk::Offset3D {0, 0, 0},
+            vk::ImageSubresourceLayers {vk::ImageAspectFlagBits::eColor, level - destinationBaseMipLevel, 0, 1},
+            vk::Offset3D {0, 0, 0},
+            vk::Extent3D {mipLevel.width, mipLevel.height, 1});
+    }
+
+    commandBuffer.copyImage(sourceImage,
+                            vk::ImageLayout::eTransferSrcOptimal,
+                            destinationImage,
+                            vk::ImageLayout::eTransferDstOptimal,
+                            regions);
+}
 
+auto transitionImageLayout(vk::CommandBuffer commandBuffer,
+                           vk::Image image,
+                           uint32_t mipLevels,
+                           vk::ImageLayout oldLayout,
+                           vk::ImageLayout newLayout) -> void
+{
     auto barrier = vk::ImageMemoryBarrier {
         {},
         {},
@@ -65,7 +107,7 @@ auto transitionImageLayout(const Device& device, vk::Image image, vk::ImageLayou
         vk::QueueFamilyIgnored,
         vk::QueueFamilyIgnored,
         image,
-        {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
+        {vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1}
     };
 
     auto sourceStage = vk::PipelineStageFlags {};
@@ -86,27 +128,33 @@ auto transitionImageLayout(const Device& device, vk::Image image, vk::ImageLayou
         sourceStage = vk::PipelineStageFlagBits::eTransfer;
         destinationStage = vk::PipelineStageFlagBits::eFragmentShader;
     }
+    else if (oldLayout == vk::ImageLayout::eShaderReadOnlyOptimal && newLayout == vk::ImageLayout::eTransferSrcOptimal)
+    {
+        barrier.srcAccessMask = {};
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
 
-    commandBuffer.pipelineBarrier(sourceStage, destinationStage, {}, {}, {}, barrier);
+        sourceStage = vk::PipelineStageFlagBits::eFragmentShader;
+        destinationStage = vk::PipelineStageFlagBits::eTransfer;
+    }
 
-    CommandBuffer::endSingleTimeCommandBuffer(device, commandBuffer);
+    commandBuffer.pipelineBarrier(sourceStage, destinationStage, {}, {}, {}, barrier);
 }
 
-auto createTextureImageView(const Device& device, vk::Image image)
+auto createTextureImageView(const Device& device, vk::Image image, vk::Format format, uint32_t mipLevels)
 {
     const auto viewInfo = vk::ImageViewCreateInfo {
         {},
         image,
         vk::ImageViewType::e2D,
-        vk::Format::eR8G8B8A8Srgb,
+        format,
         {},
-        {vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1}
+        {vk::ImageAspectFlagBits::eColor, 0, mipLevels, 0, 1}
     };
 
     return expect(device.logicalDevice.createImageView(viewInfo), vk::Result::eSuccess, "Failed to create image view");
 }
 
-auto createTextureSampler(const Device& device) -> vk::Sampler
+auto createTextureSampler(const Device& device, uint32_t mipLevels) -> vk::Sampler
 {
     const auto samplerInfo = vk::SamplerCreateInfo {{},
                                                     vk::Filter::eLinear,
@@ -121,12 +169,22 @@ auto createTextureSampler(const Device& device) -> vk::Sampler
                                                     vk::False,
                                                     vk::CompareOp::eAlways,
                                                     0.F,
-                                                    0.F,
+                                                    static_cast<float>(mipLevels),
                                                     vk::BorderColor::eIntOpaqueBlack,
                                                     vk::False};
 
     return expect(device.logicalDevice.createSampler(samplerInfo), vk::Result::eSuccess, "Failed to create sampler");
 }
+
+auto isFormatSupported(const Device& device, vk::Format format) -> bool
+{
+    return device
+        .findSupportedFormat(std::array {format},
+                             vk::ImageTiling::eOptimal,
+                             vk::FormatFeatureFlagBits::eSampledImage |
+                                 vk::FormatFeatureFlagBits::eSampledImageFilterLinear)
+        .has_value();
+}
 }
 
 Texture::~Texture()
@@ -137,11 +195,55 @@ Texture::~Texture()
     _context.getDevice().logicalDevice.free(_imageMemory);
 }
 
+auto Texture::getId() const noexcept -> Id
+{
+    return _id;
+}
+
 auto Texture::getDescriptorImageInfo() const noexcept -> vk::DescriptorImageInfo
 {
     return vk::DescriptorImageInfo {_sampler, _imageView, vk::ImageLayout::eShaderReadOnlyOptimal};
 }
 
+auto Texture::isStreamed() const noexcept -> bool
+{
+    return _streamedData.has_value();
+}
+
+auto Texture::getWidth() const noexcept -> uint32_t
+{
+    return _width;
+}
+
+auto Texture::getHeight() const noexcept -> uint32_t
+{
+    return _height;
+}
+
+auto Texture::getMipLevelCount() const noexcept -> uint32_t
+{
+    return _mipLevelCount;
+}
+
+auto Texture::getBaseMipLevel() const noexcept -> uint32_t
+{
+    return _baseMipLevel;
+}
+
+auto Texture::getTailMipLevel() const noexcept -> uint32_t
+{
+    return _tailMipLevel;
+}
+
+auto Texture::getResidentSize(uint32_t baseMipLevel) const noexcept -> vk::DeviceSize
+{
+    if (!_streamedData.has_value())
+    {
+        return 0;
+    }
+    return _streamedData->data.size() - _streamedData->mipLevels[baseMipLevel].offset;
+}
+
 auto Texture::getDefaultTexture(const Context& context, glm::vec4 color) -> std::unique_ptr<Texture>
 {
     static constexpr auto max = int32_t {255};
@@ -156,33 +258,161 @@ auto Texture::getDefaultTexture(const Context& context, glm::vec4 color) -> std:
 }
 
 Texture::Texture(const Context& context, std::span<const uint8_t> data, size_t width, size_t height)
-    : _context {context}
+    : Texture {context, TextureData::fromRgba(data, static_cast<uint32_t>(width), static_cast<uint32_t>(height))}
+{
+}
+
+Texture::Texture(const Context& context, TextureData textureData, bool isStreamed)
+    : _context {context},
+      _sampler {createTextureSampler(context.getDevice(), static_cast<uint32_t>(textureData.mipLevels.size()))},
+      _width {textureData.width},
+      _height {textureData.height},
+      _mipLevelCount {static_cast<uint32_t>(textureData.mipLevels.size())},
+      _tailMipLevel {isStreamed ? findTailMipLevel(textureData) : 0},
+      _baseMipLevel {_tailMipLevel},
+      _id {currentId++}
 {
-    load(data, width, height);
+    load(textureData, _baseMipLevel);
+
+    if (isStreamed)
+    {
+        _streamedData = std::move(textureData);
+    }
+}
+
+auto Texture::setBaseMipLevel(vk::CommandBuffer commandBuffer, uint32_t baseMipLevel, DeletionQueue& deletionQueue)
+    -> void
+{
+    expect(_streamedData.has_value(), true, "Only streamed textures can change their resident mip levels");
+
+    baseMipLevel = std::min(baseMipLevel, _tailMipLevel);
+    if (baseMipLevel == _baseMipLevel)
+    {
+        return;
+    }
+
+    deletionQueue.push([device = _context.getDevice().logicalDevice,
+                        image = _image,
+                        imageView = _imageView,
+                        imageMemory = _imageMemory] {
+        device.destroy(imageView);
+        device.destroy(image);
+        device.free(imageMemory);
+    });
+
+    const auto oldImage = _image;
+    const auto mipLevels = _mipLevelCount - baseMipLevel;
+    createImage(*_streamedData, baseMipLevel);
+
+    transitionImageLayout(commandBuffer,
+                          oldImage,
+                          _mipLevelCount - _baseMipLevel,
+                          vk::ImageLayout::eShaderReadOnlyOptimal,
+                          vk::ImageLayout::eTransferSrcOptimal);
+    transitionImageLayout(commandBuffer,
+                          _image,
+                          mipLevels,
+                          vk::ImageLayout::eUndefined,
+                          vk::ImageLayout::eTransferDstOptimal);
+
+    // Levels that are already resident are copied on the GPU, only the finer ones come from the CPU
+    copyImageToImage(commandBuffer, oldImage, _baseMipLevel, _image, baseMipLevel, *_streamedData);
+
+    if (baseMipLevel < _baseMipLevel)
+    {
+        const auto& streamedLevels = _streamedData->mipLevels;
+        const auto dataSize = streamedLevels[_baseMipLevel].offset - streamedLevels[baseMipLevel].offset;
+        auto stagingBuffer = std::make_shared<Buffer>(_context.getDevice(),
+                                                      static_cast<vk::DeviceSize>(dataSize),
+                                                      vk::BufferUsageFlagBits::eTransferSrc,
+                                                      vk::MemoryPropertyFlagBits::eHostVisible |
+                                                          vk::MemoryPropertyFlagBits::eHostCoherent);
+
+        stagingBuffer->mapWhole();
+        stagingBuffer->write(_streamedData->data.data() + streamedLevels[baseMipLevel].offset, dataSize);
+        stagingBuffer->unmapWhole();
+
+        copyBufferToImage(commandBuffer, *stagingBuffer, _image, *_streamedData, baseMipLevel, _baseMipLevel);
+        deletionQueue.push([stagingBuffer = std::move(stagingBuffer)] {});
+    }
+
+    transitionImageLayout(commandBuffer,
+                          _image,
+                          mipLevels,
+                          vk::ImageLayout::eTransferDstOptimal,
+                          vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    _imageView = createTextureImageView(_context.getDevice(), _image, _streamedData->format, mipLevels);
+    _baseMipLevel = baseMipLevel;
+}
+
+auto Texture::findTailMipLevel(const TextureData& textureData) noexcept -> uint32_t
+{
+    static constexpr auto tailSize = uint32_t {64};
+
+    auto level = uint32_t {};
+    while (level + 1 < textureData.mipLevels.size() &&
+           std::max(textureData.mipLevels[level].width, textureData.mipLevels[level].height) > tailSize)
+    {
+        level++;
+    }
+    return level;
 }
 
-auto Texture::load(std::span<const uint8_t> data, size_t width, size_t height) -> void
+auto Texture::load(const TextureData& textureData, uint32_t baseMipLevel) -> void
 {
-    const auto imageSize = width * height * 4;
+    const auto mipLevels = static_cast<uint32_t>(textureData.mipLevels.size()) - baseMipLevel;
+    const auto& baseLevel = textureData.mipLevels[baseMipLevel];
+    const auto dataSize = textureData.data.size() - baseLevel.offset;
+
     auto stagingBuffer = Buffer {_context.getDevice(),
-                                 static_cast<vk::DeviceSize>(imageSize),
+                                 static_cast<vk::DeviceSize>(dataSize),
                                  vk::BufferUsageFlagBits::eTransferSrc,
                                  vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent};
 
     stagingBuffer.mapWhole();
-    stagingBuffer.write(data.data(), imageSize);
+    stagingBuffer.write(textureData.data.data() + baseLevel.offset, dataSize);
     stagingBuffer.unmapWhole();
 
+    createImage(textureData, baseMipLevel);
+
+    const auto commandBuffer = CommandBuffer::beginSingleTimeCommandBuffer(_context.getDevice());
+    transitionImageLayout(commandBuffer,
+                          _image,
+                          mipLevels,
+                          vk::ImageLayout::eUndefined,
+                          vk::ImageLayout::eTransferDstOptimal);
+    copyBufferToImage(commandBuffer,
+                      stagingBuffer,
+                      _image,
+                      textureData,
+                      baseMipLevel,
+                      static_cast<uint32_t>(textureData.mipLevels.size()));
+    transitionImageLayout(commandBuffer,
+                          _image,
+                          mipLevels,
+                          vk::ImageLayout::eTransferDstOptimal,
+                          vk::ImageLayout::eShaderReadOnlyOptimal);
+    CommandBuffer::endSingleTimeCommandBuffer(_context.getDevice(), commandBuffer);
+
+    _imageView = createTextureImageView(_context.getDevice(), _image, textureData.format, mipLevels);
+}
+
+auto Texture::createImage(const TextureData& textureData, uint32_t baseMipLevel) -> void
+{
+    const auto mipLevels = static_cast<uint32_t>(textureData.mipLevels.size()) - baseMipLevel;
+    const auto& baseLevel = textureData.mipLevels[baseMipLevel];
+
     const auto imageInfo = vk::ImageCreateInfo {
         {},
         vk::ImageType::e2D,
-        vk::Format::eR8G8B8A8Srgb,
-        {static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1},
-        1,
+        textureData.format,
+        {baseLevel.width, baseLevel.height, 1},
+        mipLevels,
         1,
         vk::SampleCountFlagBits::e1,
         vk::ImageTiling::eOptimal,
-        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+        vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
         vk::SharingMode::eExclusive,
         {},
         {},
@@ -208,40 +438,32 @@ auto Texture::load(std::span<const uint8_t> data, size_t width, size_t height) -
     expect(_context.getDevice().logicalDevice.bindImageMemory(_image, _imageMemory, 0),
            vk::Result::eSuccess,
            "Failed to bind image memory");
-
-    transitionImageLayout(_context.getDevice(),
-                          _image,
-                          vk::ImageLayout::eUndefined,
-                          vk::ImageLayout::eTransferDstOptimal);
-
-    copyBufferToImage(_context.getDevice(), stagingBuffer, _image, width, height);
-    transitionImageLayout(_context.getDevice(),
-                          _image,
-                          vk::ImageLayout::eTransferDstOptimal,
-                          vk::ImageLayout::eShaderReadOnlyOptimal);
-
-    _imageView = createTextureImageView(_context.getDevice(), _image);
-    _sampler = createTextureSampler(_context.getDevice());
 }
 
 auto Texture::fromFile(const Context& context, const std::filesystem::path& path) -> std::unique_ptr<Texture>
 {
-    auto width = int {};
-    auto height = int {};
-    auto channels = int {};
-    auto* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    auto textureData = TextureData::fromFile(path);
 
-    if (!shouldBe(pixels, fmt::format("Failed to read the texture file: {}", path.string())))
+    if (!shouldBe(textureData.has_value(), fmt::format("Failed to read the texture file: {}", path.string())))
     {
         return {};
     }
 
-    const auto size = static_cast<size_t>(width) * static_cast<size_t>(height) * 4;
-    const auto data = std::span {pixels, size};
+    if (textureData->isCompressed() && !isFormatSupported(context.getDevice(), textureData->format))
+    {
+        log::Warning("Texture format {} of file {} is not supported by the device, falling back to CPU decompression",
+                     vk::to_string(textureData->format),
+                     path.string());
+        textureData = textureData->decompress();
+
+        if (!textureData.has_value())
+        {
+            return {};
+        }
+    }
 
-    auto texture = std::make_unique<Texture>(context, std::vector<uint8_t> {data.begin(), data.end()}, width, height);
-    stbi_image_free(pixels);
+    textureData->generateMipmaps();
 
-    return texture;
+    return std::make_unique<Texture>(context, std::move(*textureData), true);
 }
 }
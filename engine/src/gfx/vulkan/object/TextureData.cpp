@@ -0,0 +1,968 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/object/TextureData.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+
+#include "panda/Logger.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+constexpr auto ktx2Identifier =
+    std::array<uint8_t, 12> {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+constexpr auto ktx2HeaderSize = size_t {80};
+constexpr auto ktx2LevelIndexEntrySize = size_t {24};
+
+constexpr auto ddsMagic = uint32_t {0x20534444};
+constexpr auto ddsHeaderSize = size_t {124};
+constexpr auto ddsDx10HeaderSize = size_t {20};
+constexpr auto ddsCaps2Cubemap = uint32_t {0x200};
+constexpr auto ddsResourceMiscTextureCube = uint32_t {0x4};
+
+constexpr auto blockDimension = uint32_t {4};
+constexpr auto rgbaChannels = size_t {4};
+
+constexpr auto makeFourCC(char a, char b, char c, char d) noexcept -> uint32_t
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8U) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16U) |
+           (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24U);
+}
+
+template <typename T>
+auto readValue(std::span<const uint8_t> bytes, size_t offset) noexcept -> T
+{
+    auto value = T {};
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+auto readFile(const std::filesystem::path& path) -> std::optional<std::vector<uint8_t>>
+{
+    auto fin = std::ifstream(path, std::ios::ate | std::ios::binary);
+
+    if (!fin.is_open())
+    {
+        log::Warning("File {} cannot be opened", path.string());
+        return {};
+    }
+
+    const auto fileSize = fin.tellg();
+    auto buffer = std::vector<uint8_t>(static_cast<size_t>(fileSize));
+
+    fin.seekg(0);
+    fin.read(reinterpret_cast<char*>(buffer.data()), fileSize);
+
+    return buffer;
+}
+
+auto isSupportedFormat(vk::Format format) noexcept -> bool
+{
+    switch (format)
+    {
+    case vk::Format::eR8G8B8A8Unorm:
+    case vk::Format::eR8G8B8A8Srgb:
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+    case vk::Format::eBc5UnormBlock:
+    case vk::Format::eBc5SnormBlock:
+    case vk::Format::eBc7UnormBlock:
+    case vk::Format::eBc7SrgbBlock:
+        return true;
+    default:
+        return false;
+    }
+}
+
+auto isSrgb(vk::Format format) noexcept -> bool
+{
+    return format == vk::Format::eR8G8B8A8Srgb || format == vk::Format::eBc1RgbSrgbBlock ||
+           format == vk::Format::eBc1RgbaSrgbBlock || format == vk::Format::eBc3SrgbBlock ||
+           format == vk::Format::eBc7SrgbBlock;
+}
+
+auto getDecompressedFormat(vk::Format format) noexcept -> vk::Format
+{
+    if (format == vk::Format::eBc5SnormBlock)
+    {
+        return vk::Format::eR8G8B8A8Snorm;
+    }
+    return isSrgb(format) ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm;
+}
+
+auto getLevelSize(vk::Format format, uint32_t width, uint32_t height) noexcept -> size_t
+{
+    if (!TextureData::isBlockCompressed(format))
+    {
+        return static_cast<size_t>(width) * height * rgbaChannels;
+    }
+    const auto blocksX = std::max(uint32_t {1}, (width + blockDimension - 1) / blockDimension);
+    const auto blocksY = std::max(uint32_t {1}, (height + blockDimension - 1) / blockDimension);
+    return static_cast<size_t>(blocksX) * blocksY * TextureData::getBlockSize(format);
+}
+
+auto fromDxgiFormat(uint32_t dxgiFormat) noexcept -> vk::Format
+{
+    switch (dxgiFormat)
+    {
+    case 28:
+        return vk::Format::eR8G8B8A8Unorm;
+    case 29:
+        return vk::Format::eR8G8B8A8Srgb;
+    case 71:
+        return vk::Format::eBc1RgbaUnormBlock;
+    case 72:
+        return vk::Format::eBc1RgbaSrgbBlock;
+    case 77:
+        return vk::Format::eBc3UnormBlock;
+    case 78:
+        return vk::Format::eBc3SrgbBlock;
+    case 83:
+        return vk::Format::eBc5UnormBlock;
+    case 84:
+        return vk::Format::eBc5SnormBlock;
+    case 98:
+        return vk::Format::eBc7UnormBlock;
+    case 99:
+        return vk::Format::eBc7SrgbBlock;
+    default:
+        return vk::Format::eUndefined;
+    }
+}
+
+// Legacy DDS headers don't say whether the data is colour, so DXT1 and DXT5 are assumed to be sRGB colour textures.
+// Non-colour data such as normal maps should use a DX10 header with an explicit UNORM format instead
+auto fromFourCC(uint32_t fourCC) noexcept -> vk::Format
+{
+    if (fourCC == makeFourCC('D', 'X', 'T', '1'))
+    {
+        return vk::Format::eBc1RgbaSrgbBlock;
+    }
+    if (fourCC == makeFourCC('D', 'X', 'T', '5'))
+    {
+        return vk::Format::eBc3SrgbBlock;
+    }
+    if (fourCC == makeFourCC('A', 'T', 'I', '2') || fourCC == makeFourCC('B', 'C', '5', 'U'))
+    {
+        return vk::Format::eBc5UnormBlock;
+    }
+    return vk::Format::eUndefined;
+}
+
+struct Rgba
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+};
+
+auto fromRgb565(uint16_t color) noexcept -> Rgba
+{
+    const auto r = static_cast<uint32_t>((color >> 11U) & 0x1FU);
+    const auto g = static_cast<uint32_t>((color >> 5U) & 0x3FU);
+    const auto b = static_cast<uint32_t>(color & 0x1FU);
+    return {.r = static_cast<uint8_t>((r << 3U) | (r >> 2U)),
+            .g = static_cast<uint8_t>((g << 2U) | (g >> 4U)),
+            .b = static_cast<uint8_t>((b << 3U) | (b >> 2U)),
+            .a = 255};
+}
+
+auto interpolate(uint8_t a, uint8_t b, uint32_t weightA, uint32_t weightB) noexcept -> uint8_t
+{
+    return static_cast<uint8_t>((weightA * a + weightB * b) / (weightA + weightB));
+}
+
+auto decodeColorBlock(std::span<const uint8_t> block, bool alwaysFourColors) noexcept -> std::array<Rgba, 16>
+{
+    const auto color0 = readValue<uint16_t>(block, 0);
+    const auto color1 = readValue<uint16_t>(block, 2);
+    const auto indices = readValue<uint32_t>(block, 4);
+
+    auto palette = std::array<Rgba, 4> {fromRgb565(color0), fromRgb565(color1)};
+    if (alwaysFourColors || color0 > color1)
+    {
+        palette[2] = {.r = interpolate(palette[0].r, palette[1].r, 2, 1),
+                      .g = interpolate(palette[0].g, palette[1].g, 2, 1),
+                      .b = interpolate(palette[0].b, palette[1].b, 2, 1),
+                      .a = 255};
+        palette[3] = {.r = interpolate(palette[0].r, palette[1].r, 1, 2),
+                      .g = interpolate(palette[0].g, palette[1].g, 1, 2),
+                      .b = interpolate(palette[0].b, palette[1].b, 1, 2),
+                      .a = 255};
+    }
+    else
+    {
+        palette[2] = {.r = interpolate(palette[0].r, palette[1].r, 1, 1),
+                      .g = interpolate(palette[0].g, palette[1].g, 1, 1),
+                      .b = interpolate(palette[0].b, palette[1].b, 1, 1),
+                      .a = 255};
+        palette[3] = {.r = 0, .g = 0, .b = 0, .a = 0};
+    }
+
+    auto result = std::array<Rgba, 16> {};
+    for (auto i = uint32_t {}; i < result.size(); i++)
+    {
+        result[i] = palette[(indices >> (2U * i)) & 0x3U];
+    }
+    return result;
+}
+
+auto readChannelIndices(std::span<const uint8_t> block) noexcept -> std::array<uint8_t, 16>
+{
+    auto indices = uint64_t {};
+    for (auto i = size_t {}; i < 6; i++)
+    {
+        indices |= static_cast<uint64_t>(block[2 + i]) << (8U * i);
+    }
+
+    auto result = std::array<uint8_t, 16> {};
+    for (auto i = uint32_t {}; i < result.size(); i++)
+    {
+        result[i] = static_cast<uint8_t>((indices >> (3U * i)) & 0x7U);
+    }
+    return result;
+}
+
+auto decodeSingleChannelBlock(std::span<const uint8_t> block) noexcept -> std::array<uint8_t, 16>
+{
+    const auto value0 = block[0];
+    const auto value1 = block[1];
+
+    auto palette = std::array<uint8_t, 8> {value0, value1};
+    if (value0 > value1)
+    {
+        for (auto i = uint32_t {1}; i < 7; i++)
+        {
+            palette[i + 1] = interpolate(value0, value1, 7 - i, i);
+        }
+    }
+    else
+    {
+        for (auto i = uint32_t {1}; i < 5; i++)
+        {
+            palette[i + 1] = interpolate(value0, value1, 5 - i, i);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    auto result = readChannelIndices(block);
+    std::ranges::transform(result, result.begin(), [&palette](auto index) {
+        return palette[index];
+    });
+    return result;
+}
+
+// Endpoints are compared as signed values, -128 and -127 both represent -1
+auto decodeSignedChannelBlock(std::span<const uint8_t> block) noexcept -> std::array<int8_t, 16>
+{
+    const auto value0 = static_cast<int32_t>(std::bit_cast<int8_t>(block[0]));
+    const auto value1 = static_cast<int32_t>(std::bit_cast<int8_t>(block[1]));
+    const auto endpoint0 = std::max(value0, -127);
+    const auto endpoint1 = std::max(value1, -127);
+
+    auto palette = std::array<int32_t, 8> {endpoint0, endpoint1};
+    if (value0 > value1)
+    {
+        for (auto i = int32_t {1}; i < 7; i++)
+        {
+            palette[static_cast<size_t>(i) + 1] = (((7 - i) * endpoint0) + (i * endpoint1)) / 7;
+        }
+    }
+    else
+    {
+        for (auto i = int32_t {1}; i < 5; i++)
+        {
+            palette[static_cast<size_t>(i) + 1] = (((5 - i) * endpoint0) + (i * endpoint1)) / 5;
+        }
+        palette[6] = -127;
+        palette[7] = 127;
+    }
+
+    const auto indices = readChannelIndices(block);
+    auto result = std::array<int8_t, 16> {};
+    std::ranges::transform(indices, result.begin(), [&palette](auto index) {
+        return static_cast<int8_t>(palette[index]);
+    });
+    return result;
+}
+
+struct Bc7Mode
+{
+    uint32_t subsetCount;
+    uint32_t partitionBits;
+    uint32_t rotationBits;
+    uint32_t indexSelectionBits;
+    uint32_t colorBits;
+    uint32_t alphaBits;
+    uint32_t endpointPBits;
+    uint32_t sharedPBits;
+    uint32_t indexBits;
+    uint32_t secondaryIndexBits;
+};
+
+constexpr auto bc7Modes = std::array<Bc7Mode, 8> {
+    {{3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+     {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+     {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+     {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+     {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+     {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+     {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+     {2, 6, 0, 0, 5, 5, 1, 0, 2, 0}}
+};
+
+// One bit per texel selecting the subset
+constexpr auto bc7Partitions2 = std::array<uint16_t, 64> {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8,
+    0xFF00, 0xFFF0, 0xF000, 0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110,
+    0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C, 0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696,
+    0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660, 0x0272, 0x04E4, 0x4E40, 0x2720,
+    0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22};
+
+// Two bits per texel selecting the subset
+constexpr auto bc7Partitions3 = std::array<uint32_t, 64> {
+    0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+    0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+    0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+    0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+    0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+    0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+    0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+    0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254};
+
+// Anchor texels of the second subset in two subset partitions and of the second and third in three subset ones
+constexpr auto bc7Anchors2 = std::array<uint8_t, 64> {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 2, 8, 2,  2, 8,  8,  15, 2,  8,  2,  2,
+    8,  8,  2,  2,  15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,  2,  15, 15, 6, 6, 2,  6,  8,  15, 15, 2,  2,
+    15, 15, 15, 15, 15, 2,  2,  15};
+
+constexpr auto bc7Anchors3Second = std::array<uint8_t, 64> {
+    3, 3,  15, 15, 8,  3,  15, 15, 8,  8,  6,  6, 6, 5, 3,  3,  3, 3,  8, 15, 3, 3,  6,  10, 5,  8,  8, 6,
+    8, 5,  15, 15, 8,  15, 3,  5,  6,  10, 8,  15, 15, 3, 15, 5, 15, 15, 15, 15, 3, 15, 5, 5,  5,  8,  5, 10,
+    5, 10, 8,  13, 15, 12, 3,  3};
+
+constexpr auto bc7Anchors3Third = std::array<uint8_t, 64> {
+    15, 8,  8,  3,  15, 15, 3,  8,  15, 15, 15, 15, 15, 15, 15, 8,  15, 8,  15, 3,  15, 8,  15, 8,  3,  15, 6,  10,
+    15, 15, 10, 8,  15, 3,  15, 10, 10, 8,  9,  10, 6,  15, 8,  15, 3,  6,  6,  8,  15, 3,  15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 3,  15, 15, 8};
+
+constexpr auto bc7Weights2 = std::array<uint32_t, 4> {0, 21, 43, 64};
+constexpr auto bc7Weights3 = std::array<uint32_t, 8> {0, 9, 18, 27, 37, 46, 55, 64};
+constexpr auto bc7Weights4 = std::array<uint32_t, 16> {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+class BitReader
+{
+public:
+    explicit BitReader(std::span<const uint8_t> bytes) noexcept
+        : _bytes {bytes}
+    {
+    }
+
+    auto read(uint32_t count) noexcept -> uint32_t
+    {
+        auto result = uint32_t {};
+        for (auto i = uint32_t {}; i < count; i++, _position++)
+        {
+            result |= static_cast<uint32_t>((_bytes[_position / 8] >> (_position % 8)) & 1U) << i;
+        }
+        return result;
+    }
+
+private:
+    std::span<const uint8_t> _bytes;
+    size_t _position = 0;
+};
+
+auto getBc7Subset(const Bc7Mode& mode, uint32_t partition, uint32_t texel) noexcept -> uint32_t
+{
+    switch (mode.subsetCount)
+    {
+    case 2:
+        return (bc7Partitions2[partition] >> texel) & 0x1U;
+    case 3:
+        return (bc7Partitions3[partition] >> (2U * texel)) & 0x3U;
+    default:
+        return 0;
+    }
+}
+
+auto isBc7Anchor(const Bc7Mode& mode, uint32_t partition, uint32_t texel) noexcept -> bool
+{
+    switch (mode.subsetCount)
+    {
+    case 2:
+        return texel == 0 || texel == bc7Anchors2[partition];
+    case 3:
+        return texel == 0 || texel == bc7Anchors3Second[partition] || texel == bc7Anchors3Third[partition];
+    default:
+        return texel == 0;
+    }
+}
+
+auto interpolateBc7(uint32_t a, uint32_t b, uint32_t indexBits, uint32_t index) noexcept -> uint8_t
+{
+    const auto weight = indexBits == 2   ? bc7Weights2[index]
+                        : indexBits == 3 ? bc7Weights3[index]
+                                         : bc7Weights4[index];
+    return static_cast<uint8_t>(((64 - weight) * a + weight * b + 32) >> 6U);
+}
+
+auto decodeBc7Block(std::span<const uint8_t> block) noexcept -> std::array<Rgba, 16>
+{
+    // Reserved mode decodes to transparent black
+    const auto modeIndex = static_cast<uint32_t>(std::countr_zero(block[0]));
+    if (modeIndex >= bc7Modes.size())
+    {
+        return {};
+    }
+
+    const auto& mode = bc7Modes[modeIndex];
+    auto reader = BitReader {block};
+    reader.read(modeIndex + 1);
+    const auto partition = reader.read(mode.partitionBits);
+    const auto rotation = reader.read(mode.rotationBits);
+    const auto indexSelection = reader.read(mode.indexSelectionBits);
+
+    // Channel values stored per subset and endpoint, RGB first and alpha after all of them
+    const auto channelCount = mode.alphaBits > 0 ? uint32_t {4} : uint32_t {3};
+    auto endpoints = std::array<std::array<std::array<uint32_t, 4>, 2>, 3> {};
+    for (auto channel = uint32_t {}; channel < channelCount; channel++)
+    {
+        for (auto subset = uint32_t {}; subset < mode.subsetCount; subset++)
+        {
+            for (auto& endpoint : endpoints[subset])
+            {
+                endpoint[channel] = reader.read(channel < 3 ? mode.colorBits : mode.alphaBits);
+            }
+        }
+    }
+
+    for (auto subset = uint32_t {}; subset < mode.subsetCount; subset++)
+    {
+        const auto sharedPBit = reader.read(mode.sharedPBits);
+        for (auto& endpoint : endpoints[subset])
+        {
+            const auto pBit = mode.sharedPBits > 0 ? sharedPBit : reader.read(mode.endpointPBits);
+            for (auto channel = uint32_t {}; channel < channelCount; channel++)
+            {
+                const auto precision = (channel < 3 ? mode.colorBits : mode.alphaBits) + mode.endpointPBits +
+                                       mode.sharedPBits;
+                auto value = (endpoint[channel] << (mode.endpointPBits + mode.sharedPBits)) | pBit;
+                value <<= 8 - precision;
+                endpoint[channel] = value | (value >> precision);
+            }
+            if (channelCount == 3)
+            {
+                endpoint[3] = 255;
+            }
+        }
+    }
+
+    auto indices = std::array<uint32_t, 16> {};
+    for (auto texel = uint32_t {}; texel < indices.size(); texel++)
+    {
+        indices[texel] = reader.read(mode.indexBits - (isBc7Anchor(mode, partition, texel) ? 1 : 0));
+    }
+    auto secondaryIndices = std::array<uint32_t, 16> {};
+    if (mode.secondaryIndexBits > 0)
+    {
+        for (auto texel = uint32_t {}; texel < secondaryIndices.size(); texel++)
+        {
+            secondaryIndices[texel] = reader.read(mode.secondaryIndexBits - (texel == 0 ? 1 : 0));
+        }
+    }
+
+    const auto swapIndices = mode.secondaryIndexBits > 0 && indexSelection != 0;
+    const auto colorIndexBits = swapIndices ? mode.secondaryIndexBits : mode.indexBits;
+    const auto alphaIndexBits = mode.secondaryIndexBits == 0 || swapIndices ? mode.indexBits : mode.secondaryIndexBits;
+
+    auto result = std::array<Rgba, 16> {};
+    for (auto texel = uint32_t {}; texel < result.size(); texel++)
+    {
+        const auto& [endpoint0, endpoint1] = endpoints[getBc7Subset(mode, partition, texel)];
+        const auto colorIndex = swapIndices ? secondaryIndices[texel] : indices[texel];
+        const auto alphaIndex = mode.secondaryIndexBits == 0 || swapIndices ? indices[texel] : secondaryIndices[texel];
+
+        auto texelColor = std::array {interpolateBc7(endpoint0[0], endpoint1[0], colorIndexBits, colorIndex),
+                                      interpolateBc7(endpoint0[1], endpoint1[1], colorIndexBits, colorIndex),
+                                      interpolateBc7(endpoint0[2], endpoint1[2], colorIndexBits, colorIndex),
+                                      interpolateBc7(endpoint0[3], endpoint1[3], alphaIndexBits, alphaIndex)};
+        if (rotation > 0)
+        {
+            std::swap(texelColor[3], texelColor[rotation - 1]);
+        }
+        result[texel] = {.r = texelColor[0], .g = texelColor[1], .b = texelColor[2], .a = texelColor[3]};
+    }
+    return result;
+}
+
+auto decodeBlock(vk::Format format, std::span<const uint8_t> block) noexcept -> std::array<Rgba, 16>
+{
+    switch (format)
+    {
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+        return decodeColorBlock(block, false);
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+    {
+        auto result = decodeColorBlock(block.subspan(8), true);
+        const auto alpha = decodeSingleChannelBlock(block.first(8));
+        for (auto i = size_t {}; i < result.size(); i++)
+        {
+            result[i].a = alpha[i];
+        }
+        return result;
+    }
+    case vk::Format::eBc5UnormBlock:
+    {
+        const auto red = decodeSingleChannelBlock(block.first(8));
+        const auto green = decodeSingleChannelBlock(block.subspan(8));
+        auto result = std::array<Rgba, 16> {};
+        for (auto i = size_t {}; i < result.size(); i++)
+        {
+            result[i] = {.r = red[i], .g = green[i], .b = 0, .a = 255};
+        }
+        return result;
+    }
+    case vk::Format::eBc5SnormBlock:
+    {
+        const auto red = decodeSignedChannelBlock(block.first(8));
+        const auto green = decodeSignedChannelBlock(block.subspan(8));
+        auto result = std::array<Rgba, 16> {};
+        for (auto i = size_t {}; i < result.size(); i++)
+        {
+            result[i] = {.r = std::bit_cast<uint8_t>(red[i]), .g = std::bit_cast<uint8_t>(green[i]), .b = 0, .a = 127};
+        }
+        return result;
+    }
+    case vk::Format::eBc7UnormBlock:
+    case vk::Format::eBc7SrgbBlock:
+        return decodeBc7Block(block);
+    default:
+        return {};
+    }
+}
+
+auto decompressLevel(vk::Format format, std::span<const uint8_t> level, uint32_t width, uint32_t height)
+    -> std::vector<uint8_t>
+{
+    auto pixels = std::vector<uint8_t>(static_cast<size_t>(width) * height * rgbaChannels);
+    const auto blocksX = std::max(uint32_t {1}, (width + blockDimension - 1) / blockDimension);
+    const auto blocksY = std::max(uint32_t {1}, (height + blockDimension - 1) / blockDimension);
+    const auto blockSize = TextureData::getBlockSize(format);
+
+    for (auto blockY = uint32_t {}; blockY < blocksY; blockY++)
+    {
+        for (auto blockX = uint32_t {}; blockX < blocksX; blockX++)
+        {
+            const auto blockIndex = (static_cast<size_t>(blockY) * blocksX) + blockX;
+            const auto texels = decodeBlock(format, level.subspan(blockIndex * blockSize, blockSize));
+
+            for (auto y = uint32_t {}; y < blockDimension && (blockY * blockDimension) + y < height; y++)
+            {
+                for (auto x = uint32_t {}; x < blockDimension && (blockX * blockDimension) + x < width; x++)
+                {
+                    const auto& texel = texels[(y * blockDimension) + x];
+                    const auto pixelIndex =
+                        ((static_cast<size_t>((blockY * blockDimension) + y) * width) + (blockX * blockDimension) + x) *
+                        rgbaChannels;
+                    pixels[pixelIndex] = texel.r;
+                    pixels[pixelIndex + 1] = texel.g;
+                    pixels[pixelIndex + 2] = texel.b;
+                    pixels[pixelIndex + 3] = texel.a;
+                }
+            }
+        }
+    }
+    return pixels;
+}
+
+auto downsampleLevel(std::span<const uint8_t> level,
+                     uint32_t width,
+                     uint32_t height,
+                     uint32_t newWidth,
+                     uint32_t newHeight,
+                     bool isSigned) -> std::vector<uint8_t>
+{
+    auto pixels = std::vector<uint8_t>(static_cast<size_t>(newWidth) * newHeight * rgbaChannels);
+
+    for (auto y = uint32_t {}; y < newHeight; y++)
+    {
+        const auto sourceRows = std::array {std::min(2 * y, height - 1), std::min((2 * y) + 1, height - 1)};
+        for (auto x = uint32_t {}; x < newWidth; x++)
+        {
+            const auto sourceColumns = std::array {std::min(2 * x, width - 1), std::min((2 * x) + 1, width - 1)};
+            for (auto channel = size_t {}; channel < rgbaChannels; channel++)
+            {
+                auto sum = int32_t {};
+                for (const auto row : sourceRows)
+                {
+                    for (const auto column : sourceColumns)
+                    {
+                        const auto index = (((static_cast<size_t>(row) * width) + column) * rgbaChannels) + channel;
+                        sum += isSigned ? std::bit_cast<int8_t>(level[index]) : level[index];
+                    }
+                }
+                pixels[(((static_cast<size_t>(y) * newWidth) + x) * rgbaChannels) + channel] =
+                    static_cast<uint8_t>((sum + (sum < 0 ? -2 : 2)) / 4);
+            }
+        }
+    }
+    return pixels;
+}
+
+auto fillMipLevels(TextureData& texture, uint32_t levelCount, size_t dataOffset) -> bool
+{
+    auto offset = dataOffset;
+    for (auto level = uint32_t {}; level < levelCount; level++)
+    {
+        const auto levelWidth = std::max(uint32_t {1}, texture.width >> level);
+        const auto levelHeight = std::max(uint32_t {1}, texture.height >> level);
+        const auto levelSize = getLevelSize(texture.format, levelWidth, levelHeight);
+
+        if (offset + levelSize > texture.data.size())
+        {
+            return false;
+        }
+        texture.mipLevels.push_back(
+            {.offset = offset, .size = levelSize, .width = levelWidth, .height = levelHeight});
+        offset += levelSize;
+    }
+    return true;
+}
+
+}
+
+auto TextureData::fromFile(const std::filesystem::path& path) -> std::optional<TextureData>
+{
+    auto extension = path.extension().string();
+    std::ranges::transform(extension, extension.begin(), [](auto character) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+    });
+
+    if (extension == ".ktx2")
+    {
+        return fromKtx2(path);
+    }
+    if (extension == ".dds")
+    {
+        return fromDds(path);
+    }
+    return fromImage(path);
+}
+
+auto TextureData::fromImage(const std::filesystem::path& path) -> std::optional<TextureData>
+{
+    auto width = int {};
+    auto height = int {};
+    auto channels = int {};
+    auto* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+    if (!shouldBe(pixels, fmt::format("Failed to read the texture file: {}", path.string())))
+    {
+        return {};
+    }
+
+    const auto size = static_cast<size_t>(width) * static_cast<size_t>(height) * rgbaChannels;
+    auto result = fromRgba(std::span {pixels, size}, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+    stbi_image_free(pixels);
+
+    return result;
+}
+
+auto TextureData::fromKtx2(const std::filesystem::path& path) -> std::optional<TextureData>
+{
+    auto file = readFile(path);
+    if (!file.has_value())
+    {
+        return {};
+    }
+
+    const auto bytes = std::span<const uint8_t> {*file};
+    if (bytes.size() < ktx2HeaderSize || !std::ranges::equal(bytes.first(ktx2Identifier.size()), ktx2Identifier))
+    {
+        log::Warning("File {} is not a valid KTX2 file", path.string());
+        return {};
+    }
+
+    const auto format = static_cast<vk::Format>(readValue<uint32_t>(bytes, 12));
+    const auto width = readValue<uint32_t>(bytes, 20);
+    const auto height = readValue<uint32_t>(bytes, 24);
+    const auto depth = readValue<uint32_t>(bytes, 28);
+    const auto layerCount = readValue<uint32_t>(bytes, 32);
+    const auto faceCount = readValue<uint32_t>(bytes, 36);
+    const auto levelCount = std::max(uint32_t {1}, readValue<uint32_t>(bytes, 40));
+    const auto supercompressionScheme = readValue<uint32_t>(bytes, 44);
+
+    if (!isSupportedFormat(format) || depth > 1 || layerCount > 1 || faceCount != 1 || supercompressionScheme != 0)
+    {
+        log::Warning("KTX2 file {} uses unsupported features (format: {}, supercompression: {})",
+                     path.string(),
+                     static_cast<uint32_t>(format),
+                     supercompressionScheme);
+        return {};
+    }
+
+    if (width == 0 || height == 0)
+    {
+        log::Warning("KTX2 file {} has invalid size {}x{}", path.string(), width, height);
+        return {};
+    }
+
+    if (bytes.size() < ktx2HeaderSize + (static_cast<size_t>(levelCount) * ktx2LevelIndexEntrySize))
+    {
+        log::Warning("KTX2 file {} is truncated", path.string());
+        return {};
+    }
+
+    auto result = TextureData {.format = format, .width = width, .height = height, .data = {}, .mipLevels = {}};
+    result.mipLevels.reserve(levelCount);
+
+    for (auto level = uint32_t {}; level < levelCount; level++)
+    {
+        const auto entryOffset = ktx2HeaderSize + (static_cast<size_t>(level) * ktx2LevelIndexEntrySize);
+        const auto byteOffset = static_cast<size_t>(readValue<uint64_t>(bytes, entryOffset));
+        const auto byteLength = static_cast<size_t>(readValue<uint64_t>(bytes, entryOffset + 8));
+        const auto levelWidth = std::max(uint32_t {1}, width >> level);
+        const auto levelHeight = std::max(uint32_t {1}, height >> level);
+
+        if (byteOffset + byteLength > bytes.size() || byteLength < getLevelSize(format, levelWidth, levelHeight))
+        {
+            log::Warning("KTX2 file {} has invalid level {}", path.string(), level);
+            return {};
+        }
+
+        result.mipLevels.push_back(
+            {.offset = result.data.size(), .size = byteLength, .width = levelWidth, .height = levelHeight});
+        result.data.insert(result.data.end(),
+                           bytes.begin() + static_cast<std::ptrdiff_t>(byteOffset),
+                           bytes.begin() + static_cast<std::ptrdiff_t>(byteOffset + byteLength));
+    }
+
+    return result;
+}
+
+auto TextureData::fromDds(const std::filesystem::path& path) -> std::optional<TextureData>
+{
+    auto file = readFile(path);
+    if (!file.has_value())
+    {
+        return {};
+    }
+
+    const auto bytes = std::span<const uint8_t> {*file};
+    if (bytes.size() < sizeof(ddsMagic) + ddsHeaderSize || readValue<uint32_t>(bytes, 0) != ddsMagic)
+    {
+        log::Warning("File {} is not a valid DDS file", path.string());
+        return {};
+    }
+
+    const auto header = bytes.subspan(sizeof(ddsMagic), ddsHeaderSize);
+    const auto height = readValue<uint32_t>(header, 8);
+    const auto width = readValue<uint32_t>(header, 12);
+    const auto levelCount = std::max(uint32_t {1}, readValue<uint32_t>(header, 24));
+    const auto fourCC = readValue<uint32_t>(header, 80);
+    const auto caps2 = readValue<uint32_t>(header, 108);
+
+    auto dataOffset = sizeof(ddsMagic) + ddsHeaderSize;
+    auto format = vk::Format::eUndefined;
+
+    if (fourCC == makeFourCC('D', 'X', '1', '0'))
+    {
+        if (bytes.size() < dataOffset + ddsDx10HeaderSize)
+        {
+            log::Warning("DDS file {} is truncated", path.string());
+            return {};
+        }
+        format = fromDxgiFormat(readValue<uint32_t>(bytes, dataOffset));
+        const auto miscFlag = readValue<uint32_t>(bytes, dataOffset + 8);
+        const auto arraySize = readValue<uint32_t>(bytes, dataOffset + 12);
+        dataOffset += ddsDx10HeaderSize;
+
+        if (arraySize != 1 || (miscFlag & ddsResourceMiscTextureCube) != 0)
+        {
+            log::Error("DDS file {} is a cube map or texture array ({} layers), only 2D textures are supported",
+                       path.string(),
+                       arraySize);
+            return {};
+        }
+    }
+    else
+    {
+        format = fromFourCC(fourCC);
+    }
+
+    if (!isSupportedFormat(format))
+    {
+        log::Warning("DDS file {} uses unsupported pixel format", path.string());
+        return {};
+    }
+
+    if ((caps2 & ddsCaps2Cubemap) != 0)
+    {
+        log::Error("DDS file {} is a cube map, only 2D textures are supported", path.string());
+        return {};
+    }
+
+    if (width == 0 || height == 0)
+    {
+        log::Warning("DDS file {} has invalid size {}x{}", path.string(), width, height);
+        return {};
+    }
+
+    auto result = TextureData {
+        .format = format,
+        .width = width,
+        .height = height,
+        .data = {bytes.begin() + static_cast<std::ptrdiff_t>(dataOffset), bytes.end()},
+        .mipLevels = {}
+    };
+
+    if (!fillMipLevels(result, levelCount, 0))
+    {
+        log::Warning("DDS file {} is truncated", path.string());
+        return {};
+    }
+
+    return result;
+}
+
+auto TextureData::fromRgba(std::span<const uint8_t> pixels, uint32_t width, uint32_t height, vk::Format format)
+    -> TextureData
+{
+    const auto size = static_cast<size_t>(width) * height * rgbaChannels;
+    return {
+        .format = format,
+        .width = width,
+        .height = height,
+        .data = {pixels.begin(), pixels.begin() + static_cast<std::ptrdiff_t>(size)},
+        .mipLevels = {{.offset = 0, .size = size, .width = width, .height = height}}
+    };
+}
+
+auto TextureData::isBlockCompressed(vk::Format format) noexcept -> bool
+{
+    return getBlockSize(format) != 0;
+}
+
+auto TextureData::getBlockSize(vk::Format format) noexcept -> size_t
+{
+    switch (format)
+    {
+    case vk::Format::eBc1RgbUnormBlock:
+    case vk::Format::eBc1RgbSrgbBlock:
+    case vk::Format::eBc1RgbaUnormBlock:
+    case vk::Format::eBc1RgbaSrgbBlock:
+        return 8;
+    case vk::Format::eBc3UnormBlock:
+    case vk::Format::eBc3SrgbBlock:
+    case vk::Format::eBc5UnormBlock:
+    case vk::Format::eBc5SnormBlock:
+    case vk::Format::eBc7UnormBlock:
+    case vk::Format::eBc7SrgbBlock:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+auto TextureData::isCompressed() const noexcept -> bool
+{
+    return isBlockCompressed(format);
+}
+
+auto TextureData::decompress() const -> std::optional<TextureData>
+{
+    if (!isCompressed())
+    {
+        return *this;
+    }
+
+    auto result = TextureData {.format = getDecompressedFormat(format),
+                               .width = width,
+                               .height = height,
+                               .data = {},
+                               .mipLevels = {}};
+    result.mipLevels.reserve(mipLevels.size());
+
+    for (auto level = size_t {}; level < mipLevels.size(); level++)
+    {
+        const auto pixels = decompressLevel(format, getLevel(level), mipLevels[level].width, mipLevels[level].height);
+        result.mipLevels.push_back({.offset = result.data.size(),
+                                    .size = pixels.size(),
+                                    .width = mipLevels[level].width,
+                                    .height = mipLevels[level].height});
+        result.data.insert(result.data.end(), pixels.begin(), pixels.end());
+    }
+
+    log::Info("Decompressed {}x{} texture with {} mip levels on CPU", width, height, mipLevels.size());
+    return result;
+}
+
+auto TextureData::getLevel(size_t level) const noexcept -> std::span<const uint8_t>
+{
+    return std::span {data}.subspan(mipLevels[level].offset, mipLevels[level].size);
+}
+
+auto TextureData::generateMipmaps() -> void
+{
+    if (isCompressed() || mipLevels.size() != 1)
+    {
+        return;
+    }
+
+    while (mipLevels.back().width > 1 || mipLevels.back().height > 1)
+    {
+        const auto previous = mipLevels.back();
+        const auto levelWidth = std::max(uint32_t {1}, previous.width / 2);
+        const auto levelHeight = std::max(uint32_t {1}, previous.height / 2);
+        const auto pixels = downsampleLevel(getLevel(mipLevels.size() - 1),
+                                            previous.width,
+                                            previous.height,
+                                            levelWidth,
+                                            levelHeight,
+                                            format == vk::Format::eR8G8B8A8Snorm);
+
+        mipLevels.push_back(
+            {.offset = data.size(), .size = pixels.size(), .width = levelWidth, .height = levelHeight});
+        data.insert(data.end(), pixels.begin(), pixels.end());
+    }
+}
+
+}
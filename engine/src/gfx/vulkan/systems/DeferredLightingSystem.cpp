@@ -0,0 +1,234 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/systems/DeferredLightingSystem.h"
+
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/matrix.hpp>
+#include <memory>
+#include <unordered_map>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "panda/Logger.h"
+#include "panda/gfx/Camera.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Descriptor.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/FrameInfo.h"
+#include "panda/gfx/vulkan/LightCounts.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
+#include "panda/gfx/vulkan/SwapChain.h"
+#include "panda/gfx/vulkan/systems/LightCullingSystem.h"
+#include "panda/internal/config.h"
+#include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+struct PushConstantData
+{
+    glm::mat4 inverseViewProjection;
+};
+
+}
+
+DeferredLightingSystem::DeferredLightingSystem(const Device& device,
+                                               vk::RenderPass renderPass,
+                                               const LightCullingSystem* lightCullingSystem)
+    : _device {device},
+      _descriptorLayout {createDescriptorLayout(_device, lightCullingSystem != nullptr)},
+      _pipelineLayout {createPipelineLayout(_device, _descriptorLayout->getDescriptorSetLayout())},
+      _renderPass {renderPass},
+      _lightCullingSystem {lightCullingSystem}
+{
+    _pipelines.emplace(LightCounts {}, createPipeline(LightCounts {}));
+}
+
+DeferredLightingSystem::~DeferredLightingSystem() noexcept
+{
+    _device.logicalDevice.destroyPipelineLayout(_pipelineLayout);
+}
+
+auto DeferredLightingSystem::createDescriptorLayout(const Device& device, bool useClusteredLighting)
+    -> std::unique_ptr<DescriptorSetLayout>
+{
+    if (!useClusteredLighting)
+    {
+        return DescriptorSetLayout::Builder(device)
+            .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+            .addBinding(9, vk::DescriptorType::eInputAttachment, vk::ShaderStageFlagBits::eFragment)
+            .addBinding(10, vk::DescriptorType::eInputAttachment, vk::ShaderStageFlagBits::eFragment)
+            .addBinding(11, vk::DescriptorType::eInputAttachment, vk::ShaderStageFlagBits::eFragment)
+            .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR);
+    }
+
+    return DescriptorSetLayout::Builder(device)
+        .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(4, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(5, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(6, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(7, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(8, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(9, vk::DescriptorType::eInputAttachment, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(10, vk::DescriptorType::eInputAttachment, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(11, vk::DescriptorType::eInputAttachment, vk::ShaderStageFlagBits::eFragment)
+        .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR);
+}
+
+auto DeferredLightingSystem::createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout)
+    -> vk::PipelineLayout
+{
+    const auto pushConstantData =
+        vk::PushConstantRange {vk::ShaderStageFlagBits::eFragment, 0, sizeof(PushConstantData)};
+
+    const auto pipelineLayoutInfo = vk::PipelineLayoutCreateInfo {{}, setLayout, pushConstantData};
+    return expect(device.logicalDevice.createPipelineLayout(pipelineLayoutInfo),
+                  vk::Result::eSuccess,
+                  "Can't create pipeline layout");
+}
+
+auto DeferredLightingSystem::createPipeline(const LightCounts& lightCounts) const -> std::unique_ptr<Pipeline>
+{
+    const auto inputAssemblyInfo =
+        vk::PipelineInputAssemblyStateCreateInfo {{}, vk::PrimitiveTopology::eTriangleList, vk::False};
+
+    const auto viewportInfo = vk::PipelineViewportStateCreateInfo {{}, 1, {}, 1, {}};
+    const auto rasterizationInfo = vk::PipelineRasterizationStateCreateInfo {{},
+                                                                             vk::False,
+                                                                             vk::False,
+                                                                             vk::PolygonMode::eFill,
+                                                                             vk::CullModeFlagBits::eNone,
+                                                                             vk::FrontFace::eCounterClockwise,
+                                                                             vk::False,
+                                                                             {},
+                                                                             {},
+                                                                             {},
+                                                                             1.F};
+
+    const auto multisamplingInfo = vk::PipelineMultisampleStateCreateInfo {{}, vk::SampleCountFlagBits::e1, vk::False};
+    const auto colorBlendAttachment =
+        vk::PipelineColorBlendAttachmentState {vk::False,
+                                               vk::BlendFactor::eSrcAlpha,
+                                               vk::BlendFactor::eOneMinusSrcAlpha,
+                                               vk::BlendOp::eAdd,
+                                               vk::BlendFactor::eOne,
+                                               vk::BlendFactor::eZero,
+                                               vk::BlendOp::eAdd,
+                                               vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                                                   vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
+
+    const auto colorBlendInfo =
+        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachment};
+
+    const auto depthStencilInfo = vk::PipelineDepthStencilStateCreateInfo {{},
+                                                                           vk::False,
+                                                                           vk::False,
+                                                                           vk::CompareOp::eAlways,
+                                                                           vk::False,
+                                                                           vk::False};
+
+    const auto* fragmentShader = _lightCullingSystem != nullptr ? "deferredClustered.frag.spv" : "deferred.frag.spv";
+
+    return std::make_unique<Pipeline>(
+        _device,
+        PipelineConfig {.vertexShaderPath = config::shaderPath / "fullscreen.vert.spv",
+                        .fragmentShaderPath = config::shaderPath / fragmentShader,
+                        .vertexBindingDescriptions = {},
+                        .vertexAttributeDescriptions = {},
+                        .inputAssemblyInfo = inputAssemblyInfo,
+                        .viewportInfo = viewportInfo,
+                        .rasterizationInfo = rasterizationInfo,
+                        .multisamplingInfo = multisamplingInfo,
+                        .colorBlendInfo = colorBlendInfo,
+                        .depthStencilInfo = depthStencilInfo,
+                        .pipelineLayout = _pipelineLayout,
+                        .renderPass = _renderPass,
+                        .subpass = getLightingSubpass(ShadingMode::Deferred),
+                        .vertexSpecialization = {},
+                        .fragmentSpecialization = lightCounts.getSpecializationConstants()});
+}
+
+auto DeferredLightingSystem::getPipeline(LightCounts lightCounts) -> const Pipeline&
+{
+    if (_lightCullingSystem != nullptr)
+    {
+        lightCounts.pointLights = LightCounts::dynamicCount;
+        lightCounts.spotLights = LightCounts::dynamicCount;
+    }
+
+    auto it = _pipelines.find(lightCounts);
+    if (it == _pipelines.end())
+    {
+        log::Info("Creating deferred lighting pipeline for {} directional, {} point and {} spot lights",
+                  lightCounts.directionalLights,
+                  lightCounts.pointLights,
+                  lightCounts.spotLights);
+        it = _pipelines.emplace(lightCounts, createPipeline(lightCounts)).first;
+    }
+    return *it->second;
+}
+
+auto DeferredLightingSystem::render(const FrameInfo& frameInfo, const GBuffer& gBuffer, vk::ImageView depthView)
+    -> void
+{
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                         getPipeline(LightCounts::fromLights(frameInfo.scene.getLights())).getHandle());
+
+    pushDescriptors(frameInfo, gBuffer, depthView);
+
+    const auto& camera = frameInfo.scene.getCamera();
+    const auto push =
+        PushConstantData {.inverseViewProjection = glm::inverse(camera.getProjection() * camera.getView())};
+    frameInfo.commandBuffer.pushConstants<PushConstantData>(_pipelineLayout,
+                                                            vk::ShaderStageFlagBits::eFragment,
+                                                            0,
+                                                            push);
+
+    static constexpr auto fullscreenTriangleVerticesCount = 3;
+    frameInfo.commandBuffer.draw(fullscreenTriangleVerticesCount, 1, 0, 0);
+}
+
+auto DeferredLightingSystem::pushDescriptors(const FrameInfo& frameInfo,
+                                             const GBuffer& gBuffer,
+                                             vk::ImageView depthView) const -> void
+{
+    const auto albedoInfo =
+        vk::DescriptorImageInfo {{}, gBuffer.albedo.view, vk::ImageLayout::eShaderReadOnlyOptimal};
+    const auto normalInfo =
+        vk::DescriptorImageInfo {{}, gBuffer.normal.view, vk::ImageLayout::eShaderReadOnlyOptimal};
+    const auto depthInfo = vk::DescriptorImageInfo {{}, depthView, vk::ImageLayout::eDepthStencilReadOnlyOptimal};
+
+    if (_lightCullingSystem == nullptr)
+    {
+        DescriptorWriter(*_descriptorLayout)
+            .writeBuffer(1, frameInfo.fragUbo)
+            .writeImage(9, albedoInfo)
+            .writeImage(10, normalInfo)
+            .writeImage(11, depthInfo)
+            .push(frameInfo.commandBuffer, _pipelineLayout);
+        return;
+    }
+
+    const auto clusterBuffers = _lightCullingSystem->getBuffers(frameInfo.frameIndex);
+    DescriptorWriter(*_descriptorLayout)
+        .writeBuffer(1, frameInfo.fragUbo)
+        .writeBuffer(4, clusterBuffers.clusterUbo.getDescriptorInfo())
+        .writeBuffer(5, clusterBuffers.pointLights.getDescriptorInfo())
+        .writeBuffer(6, clusterBuffers.spotLights.getDescriptorInfo())
+        .writeBuffer(7, clusterBuffers.lightGrid.getDescriptorInfo())
+        .writeBuffer(8, clusterBuffers.lightIndices.getDescriptorInfo())
+        .writeImage(9, albedoInfo)
+        .writeImage(10, normalInfo)
+        .writeImage(11, depthInfo)
+        .push(frameInfo.commandBuffer, _pipelineLayout);
+}
+
+}
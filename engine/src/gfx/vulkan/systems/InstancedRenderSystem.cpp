@@ -6,9 +6,14 @@
 
 #include <panda/gfx/vulkan/Context.h>
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>
+#include <glm/ext/vector_float4.hpp>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -17,56 +22,185 @@
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
+#include "panda/Logger.h"
 #include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
 #include "panda/gfx/vulkan/Descriptor.h"
 #include "panda/gfx/vulkan/Device.h"
 #include "panda/gfx/vulkan/FrameInfo.h"
+#include "panda/gfx/vulkan/LightCounts.h"
 #include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/RenderQueue.h"
 #include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
 #include "panda/gfx/vulkan/Vertex.h"
+#include "panda/gfx/vulkan/systems/LightCullingSystem.h"
 #include "panda/gfx/vulkan/object/Mesh.h"
 #include "panda/gfx/vulkan/object/Object.h"
 #include "panda/gfx/vulkan/object/Surface.h"
 #include "panda/gfx/vulkan/object/Texture.h"
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
 #include "panda/internal/config.h"
 #include "panda/utils/Utils.h"
 #include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner, unused-includes)
 
 namespace panda::gfx::vulkan
 {
-InstancedRenderSystem::InstancedRenderSystem(const Device& device, vk::RenderPass renderPass, size_t maxInstanceCount)
+InstancedRenderSystem::InstancedRenderSystem(const Device& device,
+                                             DeletionQueue& deletionQueue,
+                                             utils::JobSystem& jobSystem,
+                                             vk::RenderPass renderPass,
+                                             size_t framesInFlight,
+                                             size_t initialInstanceCount,
+                                             ShadingMode shadingMode,
+                                             const LightCullingSystem* lightCullingSystem,
+                                             bool useDepthPrepass,
+                                             OcclusionCullingSystem* occlusionCullingSystem,
+                                             bool useAutoInstancing)
     : _device {device},
-      _descriptorLayout {
-          DescriptorSetLayout::Builder(_device)
-              .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
-              .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
-              .addBinding(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
-              .addBinding(3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eVertex)
-              .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR)},
+      _deletionQueue {deletionQueue},
+      _descriptorLayout {createDescriptorLayout(_device, lightCullingSystem != nullptr)},
       _pipelineLayout {createPipelineLayout(_device, _descriptorLayout->getDescriptorSetLayout())},
-      _pipeline {createPipeline(_device, renderPass, _pipelineLayout)}
+      _renderPass {renderPass},
+      _shadingMode {shadingMode},
+      _lightCullingSystem {lightCullingSystem},
+      _useDepthPrepass {useDepthPrepass},
+      _occlusionCullingSystem {occlusionCullingSystem},
+      _useAutoInstancing {useAutoInstancing},
+      _pipelines {jobSystem, [this](const LightCounts& lightCounts) {
+          return createPipeline(lightCounts);
+      }}
 {
-    for (auto i = uint32_t {}; i < Context::maxFramesInFlight; i++)
+    if (_useDepthPrepass)
     {
-        _instanceBuffers.push_back(std::make_unique<Buffer>(
-            device,
-            sizeof(InstanceData),
-            maxInstanceCount,
-            vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-            _device.physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment));
-        _instanceBuffers.back()->mapWhole();
+        _packedDepthPipeline = createDepthPipeline(true);
+        _interleavedDepthPipeline = createDepthPipeline(false);
     }
+
+    _instanceBuffers.resize(framesInFlight);
+    _capacities.resize(framesInFlight);
+
+    if (_occlusionCullingSystem != nullptr)
+    {
+        _culledInstanceBuffers.resize(framesInFlight);
+        _boundsBuffers.resize(framesInFlight);
+        _drawCommandBuffers.resize(framesInFlight);
+    }
+
+    for (auto i = uint32_t {}; i < framesInFlight; i++)
+    {
+        createBuffers(i, std::max(initialInstanceCount, size_t {1}));
+    }
+
+    _statistics.capacity = _capacities.front();
+}
+
+auto InstancedRenderSystem::createBuffers(uint32_t frameIndex, size_t capacity) -> void
+{
+    _instanceBuffers[frameIndex] = std::make_unique<Buffer>(
+        _device,
+        sizeof(InstanceData),
+        capacity,
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eTransferDst,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        _device.physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment);
+    _instanceBuffers[frameIndex]->mapWhole();
+    _capacities[frameIndex] = capacity;
+
+    if (_occlusionCullingSystem == nullptr)
+    {
+        return;
+    }
+
+    _culledInstanceBuffers[frameIndex] = std::make_unique<Buffer>(_device,
+                                                                  sizeof(InstanceData),
+                                                                  capacity,
+                                                                  vk::BufferUsageFlagBits::eStorageBuffer,
+                                                                  vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    _boundsBuffers[frameIndex] = std::make_unique<Buffer>(
+        _device,
+        sizeof(OcclusionCullingSystem::InstanceBounds),
+        capacity,
+        vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    _boundsBuffers[frameIndex]->mapWhole();
+
+    _drawCommandBuffers[frameIndex] = std::make_unique<Buffer>(
+        _device,
+        sizeof(vk::DrawIndexedIndirectCommand),
+        capacity,
+        vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    _drawCommandBuffers[frameIndex]->mapWhole();
+}
+
+auto InstancedRenderSystem::reserveInstances(uint32_t frameIndex, size_t instanceCount) -> void
+{
+    _statistics.instanceCount = instanceCount;
+    _statistics.highWaterMark = std::max(_statistics.highWaterMark, instanceCount);
+
+    if (instanceCount <= _capacities[frameIndex])
+    {
+        return;
+    }
+
+    auto capacity = _capacities[frameIndex];
+    while (capacity < instanceCount)
+    {
+        capacity *= 2;
+    }
+
+    log::Info("Growing instance buffers of frame {} from {} to {} instances",
+              frameIndex,
+              _capacities[frameIndex],
+              capacity);
+
+    for (auto* buffers : {&_instanceBuffers, &_culledInstanceBuffers, &_boundsBuffers, &_drawCommandBuffers})
+    {
+        if (!buffers->empty())
+        {
+            _deletionQueue.push([buffer = std::shared_ptr<Buffer> {std::move((*buffers)[frameIndex])}] {});
+        }
+    }
+
+    createBuffers(frameIndex, capacity);
+    _statistics.capacity = std::ranges::max(_capacities);
 }
 
 InstancedRenderSystem::~InstancedRenderSystem() noexcept
 {
+    _pipelines.waitForPending();
     _device.logicalDevice.destroyPipelineLayout(_pipelineLayout);
 }
 
-auto InstancedRenderSystem::createPipeline(const Device& device,
-                                           vk::RenderPass renderPass,
-                                           vk::PipelineLayout pipelineLayout) -> std::unique_ptr<Pipeline>
+auto InstancedRenderSystem::createDescriptorLayout(const Device& device, bool useClusteredLighting)
+    -> std::unique_ptr<DescriptorSetLayout>
+{
+    if (!useClusteredLighting)
+    {
+        return DescriptorSetLayout::Builder(device)
+            .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
+            .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+            .addBinding(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+            .addBinding(3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eVertex)
+            .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR);
+    }
+
+    return DescriptorSetLayout::Builder(device)
+        .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
+        .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eVertex)
+        .addBinding(4, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(5, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(6, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(7, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(8, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR);
+}
+
+auto InstancedRenderSystem::createPipeline(const LightCounts& lightCounts) const -> std::unique_ptr<Pipeline>
 {
     static constexpr auto inputAssemblyInfo =
         vk::PipelineInputAssemblyStateCreateInfo {{}, vk::PrimitiveTopology::eTriangleList, vk::False};
@@ -98,16 +232,23 @@ auto InstancedRenderSystem::createPipeline(const Device& device,
                                                vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
                                                    vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
 
+    const auto colorBlendAttachments = std::vector(_shadingMode == ShadingMode::Deferred ? 2 : 1, colorBlendAttachment);
+
     const auto colorBlendInfo =
-        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachment};
+        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachments};
 
-    static constexpr auto depthStencilInfo =
-        vk::PipelineDepthStencilStateCreateInfo {{}, vk::True, vk::True, vk::CompareOp::eLess, vk::False, vk::False};
+    const auto depthStencilInfo =
+        vk::PipelineDepthStencilStateCreateInfo {{},
+                                                 vk::True,
+                                                 _useDepthPrepass ? vk::False : vk::True,
+                                                 _useDepthPrepass ? vk::CompareOp::eEqual : vk::CompareOp::eLess,
+                                                 vk::False,
+                                                 vk::False};
 
     return std::make_unique<Pipeline>(
-        device,
+        _device,
         PipelineConfig {.vertexShaderPath = config::shaderPath / "instanced.vert.spv",
-                        .fragmentShaderPath = config::shaderPath / "basic.frag.spv",
+                        .fragmentShaderPath = getFragmentShaderPath(),
                         .vertexBindingDescriptions = {Vertex::getBindingDescription()},
                         .vertexAttributeDescriptions = utils::fromArray(Vertex::getAttributeDescriptions()),
                         .inputAssemblyInfo = inputAssemblyInfo,
@@ -116,9 +257,69 @@ auto InstancedRenderSystem::createPipeline(const Device& device,
                         .multisamplingInfo = multisamplingInfo,
                         .colorBlendInfo = colorBlendInfo,
                         .depthStencilInfo = depthStencilInfo,
-                        .pipelineLayout = pipelineLayout,
-                        .renderPass = renderPass,
-                        .subpass = 0});
+                        .pipelineLayout = _pipelineLayout,
+                        .renderPass = _renderPass,
+                        .subpass = 0,
+                        .vertexSpecialization = {},
+                        .fragmentSpecialization = lightCounts.getSpecializationConstants()});
+}
+
+auto InstancedRenderSystem::createDepthPipeline(bool packedPositions) const -> std::unique_ptr<Pipeline>
+{
+    static constexpr auto inputAssemblyInfo =
+        vk::PipelineInputAssemblyStateCreateInfo {{}, vk::PrimitiveTopology::eTriangleList, vk::False};
+
+    static constexpr auto viewportInfo = vk::PipelineViewportStateCreateInfo {{}, 1, {}, 1, {}};
+    static constexpr auto rasterizationInfo =
+        vk::PipelineRasterizationStateCreateInfo {{},
+                                                  vk::False,
+                                                  vk::False,
+                                                  vk::PolygonMode::eFill,
+                                                  vk::CullModeFlagBits::eBack,
+                                                  vk::FrontFace::eCounterClockwise,
+                                                  vk::False,
+                                                  {},
+                                                  {},
+                                                  {},
+                                                  1.F};
+
+    static constexpr auto multisamplingInfo =
+        vk::PipelineMultisampleStateCreateInfo {{}, vk::SampleCountFlagBits::e1, vk::False};
+    static constexpr auto colorBlendAttachment =
+        vk::PipelineColorBlendAttachmentState {vk::False,
+                                               vk::BlendFactor::eOne,
+                                               vk::BlendFactor::eZero,
+                                               vk::BlendOp::eAdd,
+                                               vk::BlendFactor::eOne,
+                                               vk::BlendFactor::eZero,
+                                               vk::BlendOp::eAdd,
+                                               {}};
+
+    const auto colorBlendAttachments = std::vector(_shadingMode == ShadingMode::Deferred ? 2 : 1, colorBlendAttachment);
+
+    const auto colorBlendInfo =
+        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachments};
+
+    static constexpr auto depthStencilInfo =
+        vk::PipelineDepthStencilStateCreateInfo {{}, vk::True, vk::True, vk::CompareOp::eLess, vk::False, vk::False};
+
+    return std::make_unique<Pipeline>(
+        _device,
+        PipelineConfig {.vertexShaderPath = config::shaderPath / "depthInstanced.vert.spv",
+                        .fragmentShaderPath = {},
+                        .vertexBindingDescriptions = {Vertex::getPositionBindingDescription(packedPositions)},
+                        .vertexAttributeDescriptions = {Vertex::getPositionAttributeDescription()},
+                        .inputAssemblyInfo = inputAssemblyInfo,
+                        .viewportInfo = viewportInfo,
+                        .rasterizationInfo = rasterizationInfo,
+                        .multisamplingInfo = multisamplingInfo,
+                        .colorBlendInfo = colorBlendInfo,
+                        .depthStencilInfo = depthStencilInfo,
+                        .pipelineLayout = _pipelineLayout,
+                        .renderPass = _renderPass,
+                        .subpass = 0,
+                        .vertexSpecialization = {},
+                        .fragmentSpecialization = {}});
 }
 
 auto InstancedRenderSystem::createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout)
@@ -130,44 +331,269 @@ auto InstancedRenderSystem::createPipelineLayout(const Device& device, vk::Descr
                   "Can't create pipeline layout");
 }
 
-auto InstancedRenderSystem::render(const FrameInfo& frameInfo) -> void
+auto InstancedRenderSystem::getFragmentShaderPath() const -> std::filesystem::path
 {
-    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, _pipeline->getHandle());
+    if (_shadingMode == ShadingMode::Deferred)
+    {
+        return config::shaderPath / "gbuffer.frag.spv";
+    }
+    return config::shaderPath / (_lightCullingSystem != nullptr ? "clustered.frag.spv" : "basic.frag.spv");
+}
+
+auto InstancedRenderSystem::getPipeline(LightCounts lightCounts) -> const Pipeline&
+{
+    if (_shadingMode == ShadingMode::Deferred)
+    {
+        lightCounts = LightCounts {};
+    }
+    else if (_lightCullingSystem != nullptr)
+    {
+        lightCounts.pointLights = LightCounts::dynamicCount;
+        lightCounts.spotLights = LightCounts::dynamicCount;
+    }
+
+    return _pipelines.get(lightCounts);
+}
+
+auto InstancedRenderSystem::update(const FrameInfo& frameInfo) -> void
+{
+    collectAutoInstances(frameInfo.scene);
+    const auto surfaceMaps = std::array {&frameInfo.scene.getInstancedSurfaceMap(), &_autoInstances};
 
-    _instances.resize(std::accumulate(frameInfo.scene.getInstancedSurfaceMap().begin(),
-                                      frameInfo.scene.getInstancedSurfaceMap().end(),
-                                      0,
-                                      [](auto value, const auto& mapping) {
-                                          return value + mapping.second.size();
+    _instances.resize(std::accumulate(surfaceMaps.begin(),
+                                      surfaceMaps.end(),
+                                      size_t {},
+                                      [](auto value, const auto* surfaceMap) {
+                                          for (const auto& mapping : *surfaceMap)
+                                          {
+                                              value += mapping.second.size();
+                                          }
+                                          return value;
                                       }));
+    reserveInstances(frameInfo.frameIndex, _instances.size());
 
+    _groups.clear();
+
+    const auto& view = frameInfo.scene.getCamera().getView();
     auto index = size_t {};
-    for (const auto& surfaces : frameInfo.scene.getInstancedSurfaceMap())
+    for (const auto* surfaceMap : surfaceMaps)
     {
-        for (const auto& object : surfaces.second)
+        for (const auto& [surface, objects] : *surfaceMap)
         {
-            _instances[index++] = {.translation = object->transform.translation,
-                                   .scale = object->transform.scale,
-                                   .rotation = object->transform.rotation};
+            _groups.push_back({.surface = surface,
+                               .baseIndex = index,
+                               .instanceCount = objects.size(),
+                               .depth = std::numeric_limits<float>::max()});
+
+            auto& group = _groups.back();
+            for (const auto& object : objects)
+            {
+                _instances[index++] = {.translation = object->transform.translation,
+                                       .scale = object->transform.scale,
+                                       .rotation = object->transform.rotation};
+                group.depth = std::min(group.depth, (view * glm::vec4 {object->transform.translation, 1.F}).z);
+            }
         }
     }
 
     _instanceBuffers[frameInfo.frameIndex]->writeAt(_instances, 0);
 
-    auto baseIndex = size_t {};
+    if (_occlusionCullingSystem == nullptr)
+    {
+        return;
+    }
+
+    _bounds.clear();
+    _drawCommands.clear();
+    for (const auto* surfaceMap : surfaceMaps)
+    {
+        for (const auto& [surface, objects] : *surfaceMap)
+        {
+            const auto drawCommand = static_cast<uint32_t>(_drawCommands.size());
+            const auto firstInstance = static_cast<uint32_t>(_bounds.size());
+            _drawCommands.push_back(surface.getMesh().getIndirectCommand(firstInstance));
+
+            for (const auto& object : objects)
+            {
+                const auto sphere = OcclusionCullingSystem::getBoundingSphere(object->transform, surface.getMesh());
+                _bounds.push_back({.sphere = sphere, .drawCommand = drawCommand, .firstInstance = firstInstance});
+            }
+        }
+    }
+
+    _boundsBuffers[frameInfo.frameIndex]->writeAt(_bounds, 0);
+    _drawCommandBuffers[frameInfo.frameIndex]->writeAt(_drawCommands, 0);
+
+    _isCulled = _occlusionCullingSystem->cullInstances(
+        frameInfo,
+        {.instances = *_instanceBuffers[frameInfo.frameIndex],
+         .bounds = *_boundsBuffers[frameInfo.frameIndex],
+         .culledInstances = *_culledInstanceBuffers[frameInfo.frameIndex],
+         .drawCommands = *_drawCommandBuffers[frameInfo.frameIndex]},
+        static_cast<uint32_t>(_bounds.size()));
+}
+
+auto InstancedRenderSystem::renderDepthPrepass(const FrameInfo& frameInfo) -> void
+{
+    DescriptorWriter(*_descriptorLayout)
+        .writeBuffer(0, frameInfo.vertUbo)
+        .writeBuffer(3, getInstanceBuffer(frameInfo.frameIndex).getDescriptorInfo())
+        .push(frameInfo.commandBuffer, _pipelineLayout);
+
+    _renderQueue.clear();
+    for (auto i = uint32_t {}; i < _groups.size(); i++)
+    {
+        const auto& mesh = _groups[i].surface.getMesh();
+        _renderQueue.push({.pass = RenderQueue::Pass::DepthPrepass,
+                           .pipeline = mesh.hasPositionStream() ? 1U : 0U,
+                           .material = 0,
+                           .mesh = mesh.getId(),
+                           .depth = _groups[i].depth},
+                          i);
+    }
+    _renderQueue.sort();
+
+    auto boundPipeline = vk::Pipeline {};
+    const Mesh* boundMesh = nullptr;
+
+    for (const auto& entry : _renderQueue.getEntries())
+    {
+        const auto& mesh = _groups[entry.drawIndex].surface.getMesh();
+        const auto pipeline =
+            mesh.hasPositionStream() ? _packedDepthPipeline->getHandle() : _interleavedDepthPipeline->getHandle();
+        if (pipeline != boundPipeline)
+        {
+            frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+            boundPipeline = pipeline;
+        }
+
+        if (&mesh != boundMesh)
+        {
+            mesh.bindPositions(frameInfo.commandBuffer);
+            boundMesh = &mesh;
+        }
+
+        drawGroup(frameInfo, entry.drawIndex);
+    }
+}
+
+auto InstancedRenderSystem::render(const FrameInfo& frameInfo) -> void
+{
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                         getPipeline(LightCounts::fromLights(frameInfo.scene.getLights())).getHandle());
+
+    _renderQueue.clear();
+    for (auto i = uint32_t {}; i < _groups.size(); i++)
+    {
+        _renderQueue.push({.pass = RenderQueue::Pass::Opaque,
+                           .pipeline = 0,
+                           .material = _groups[i].surface.getTexture().getId(),
+                           .mesh = _groups[i].surface.getMesh().getId(),
+                           .depth = _groups[i].depth},
+                          i);
+    }
+    _renderQueue.sort();
+
+    const Texture* boundTexture = nullptr;
+    const Mesh* boundMesh = nullptr;
+
+    for (const auto& entry : _renderQueue.getEntries())
+    {
+        const auto& surface = _groups[entry.drawIndex].surface;
+        if (&surface.getTexture() != boundTexture)
+        {
+            pushDescriptors(frameInfo, surface.getTexture());
+            boundTexture = &surface.getTexture();
+        }
+
+        if (&surface.getMesh() != boundMesh)
+        {
+            surface.getMesh().bind(frameInfo.commandBuffer);
+            boundMesh = &surface.getMesh();
+        }
+
+        drawGroup(frameInfo, entry.drawIndex);
+    }
+}
+
+auto InstancedRenderSystem::isAutoInstanced(const Surface& surface) const noexcept -> bool
+{
+    return _autoInstances.contains(surface);
+}
+
+auto InstancedRenderSystem::getStatistics() const noexcept -> const Statistics&
+{
+    return _statistics;
+}
+
+auto InstancedRenderSystem::collectAutoInstances(const Scene& scene) -> void
+{
+    _autoInstances.clear();
+    if (!_useAutoInstancing)
+    {
+        return;
+    }
+
+    for (const auto& [surface, objects] : scene.getSharedSurfaceMap())
+    {
+        auto dynamicObjects = std::vector<const Object*> {};
+        std::ranges::copy_if(objects, std::back_inserter(dynamicObjects), [](const auto* object) {
+            return !object->isStatic;
+        });
+
+        if (dynamicObjects.size() < 2)
+        {
+            continue;
+        }
+
+        _autoInstances.emplace(surface, std::move(dynamicObjects));
+    }
+}
+
+auto InstancedRenderSystem::drawGroup(const FrameInfo& frameInfo, size_t groupIndex) const -> void
+{
+    const auto& group = _groups[groupIndex];
+    if (_isCulled)
+    {
+        group.surface.getMesh().drawIndirect(frameInfo.commandBuffer,
+                                             _drawCommandBuffers[frameInfo.frameIndex]->buffer,
+                                             groupIndex * sizeof(vk::DrawIndexedIndirectCommand));
+    }
+    else
+    {
+        group.surface.getMesh().drawInstanced(frameInfo.commandBuffer, group.instanceCount, group.baseIndex);
+    }
+}
 
-    for (const auto& group : frameInfo.scene.getInstancedSurfaceMap())
+auto InstancedRenderSystem::getInstanceBuffer(uint32_t frameIndex) const -> const Buffer&
+{
+    return _isCulled ? *_culledInstanceBuffers[frameIndex] : *_instanceBuffers[frameIndex];
+}
+
+auto InstancedRenderSystem::pushDescriptors(const FrameInfo& frameInfo, const Texture& texture) const -> void
+{
+    if (_lightCullingSystem == nullptr)
     {
         DescriptorWriter(*_descriptorLayout)
-            .writeBuffer(0, frameInfo.vertUbo.getDescriptorInfo())
-            .writeBuffer(1, frameInfo.fragUbo.getDescriptorInfo())
-            .writeImage(2, group.first.getTexture().getDescriptorImageInfo())
-            .writeBuffer(3, _instanceBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+            .writeBuffer(0, frameInfo.vertUbo)
+            .writeBuffer(1, frameInfo.fragUbo)
+            .writeImage(2, texture.getDescriptorImageInfo())
+            .writeBuffer(3, getInstanceBuffer(frameInfo.frameIndex).getDescriptorInfo())
             .push(frameInfo.commandBuffer, _pipelineLayout);
-
-        group.first.getMesh().bind(frameInfo.commandBuffer);
-        group.first.getMesh().drawInstanced(frameInfo.commandBuffer, group.second.size(), baseIndex);
-        baseIndex += group.second.size();
+        return;
     }
+
+    const auto clusterBuffers = _lightCullingSystem->getBuffers(frameInfo.frameIndex);
+    DescriptorWriter(*_descriptorLayout)
+        .writeBuffer(0, frameInfo.vertUbo)
+        .writeBuffer(1, frameInfo.fragUbo)
+        .writeImage(2, texture.getDescriptorImageInfo())
+        .writeBuffer(3, getInstanceBuffer(frameInfo.frameIndex).getDescriptorInfo())
+        .writeBuffer(4, clusterBuffers.clusterUbo.getDescriptorInfo())
+        .writeBuffer(5, clusterBuffers.pointLights.getDescriptorInfo())
+        .writeBuffer(6, clusterBuffers.spotLights.getDescriptorInfo())
+        .writeBuffer(7, clusterBuffers.lightGrid.getDescriptorInfo())
+        .writeBuffer(8, clusterBuffers.lightIndices.getDescriptorInfo())
+        .push(frameInfo.commandBuffer, _pipelineLayout);
 }
 }
@@ -0,0 +1,168 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/systems/LightCullingSystem.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_uint2.hpp>
+#include <glm/matrix.hpp>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/gfx/Camera.h"
+#include "panda/gfx/Light.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Context.h"
+#include "panda/gfx/vulkan/Descriptor.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/FrameInfo.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/UboLight.h"
+#include "panda/internal/config.h"
+#include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
+
+namespace panda::gfx::vulkan
+{
+
+LightCullingSystem::LightCullingSystem(const Device& device, size_t framesInFlight)
+    : _device {device},
+      _descriptorLayout {
+          DescriptorSetLayout::Builder(_device)
+              .addBinding(4, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(5, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(6, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(7, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(8, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR)},
+      _pipelineLayout {createPipelineLayout(_device, _descriptorLayout->getDescriptorSetLayout())},
+      _pipeline {std::make_unique<ComputePipeline>(
+          _device,
+          ComputePipelineConfig {.shaderPath = config::shaderPath / "lightCulling.comp.spv",
+                                 .pipelineLayout = _pipelineLayout,
+                                 .specialization = {}})}
+{
+    for (auto i = uint32_t {}; i < framesInFlight; i++)
+    {
+        _clusterUboBuffers.push_back(std::make_unique<Buffer>(
+            _device,
+            sizeof(ClusterUbo),
+            1,
+            vk::BufferUsageFlagBits::eUniformBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            _device.physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment));
+        _clusterUboBuffers.back()->mapWhole();
+
+        _pointLightBuffers.push_back(std::make_unique<Buffer>(
+            _device,
+            sizeof(UboPointLight),
+            maxClusteredLights,
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
+        _pointLightBuffers.back()->mapWhole();
+
+        _spotLightBuffers.push_back(std::make_unique<Buffer>(
+            _device,
+            sizeof(UboSpotLight),
+            maxClusteredLights,
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
+        _spotLightBuffers.back()->mapWhole();
+
+        _lightGridBuffers.push_back(std::make_unique<Buffer>(_device,
+                                                             sizeof(glm::uvec2),
+                                                             clusterCount,
+                                                             vk::BufferUsageFlagBits::eStorageBuffer,
+                                                             vk::MemoryPropertyFlagBits::eDeviceLocal));
+
+        _lightIndexBuffers.push_back(std::make_unique<Buffer>(_device,
+                                                              sizeof(uint32_t),
+                                                              size_t {clusterCount} * maxLightsPerCluster,
+                                                              vk::BufferUsageFlagBits::eStorageBuffer,
+                                                              vk::MemoryPropertyFlagBits::eDeviceLocal));
+    }
+
+    _pointLights.reserve(maxClusteredLights);
+    _spotLights.reserve(maxClusteredLights);
+}
+
+LightCullingSystem::~LightCullingSystem() noexcept
+{
+    _device.logicalDevice.destroyPipelineLayout(_pipelineLayout);
+}
+
+auto LightCullingSystem::createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout)
+    -> vk::PipelineLayout
+{
+    const auto pipelineLayoutInfo = vk::PipelineLayoutCreateInfo {{}, setLayout};
+    return expect(device.logicalDevice.createPipelineLayout(pipelineLayoutInfo),
+                  vk::Result::eSuccess,
+                  "Can't create pipeline layout");
+}
+
+auto LightCullingSystem::cull(const FrameInfo& frameInfo, vk::Extent2D extent) -> void
+{
+    const auto& lights = frameInfo.scene.getLights();
+    const auto& camera = frameInfo.scene.getCamera();
+
+    _pointLights.clear();
+    _spotLights.clear();
+    std::ranges::transform(lights.pointLights | std::views::take(maxClusteredLights),
+                           std::back_inserter(_pointLights),
+                           fromPointLight);
+    std::ranges::transform(lights.spotLights | std::views::take(maxClusteredLights),
+                           std::back_inserter(_spotLights),
+                           fromSpotLight);
+
+    const auto ubo = ClusterUbo {
+        .view = camera.getView(),
+        .inverseProjection = glm::inverse(camera.getProjection()),
+        .gridSize = {clusterCountX, clusterCountY, clusterCountZ, maxLightsPerCluster},
+        .screenSize = {static_cast<float>(extent.width), static_cast<float>(extent.height)},
+        .near = camera.getNear(),
+        .far = camera.getFar(),
+        .pointLightCount = static_cast<uint32_t>(_pointLights.size()),
+        .spotLightCount = static_cast<uint32_t>(_spotLights.size())};
+
+    _clusterUboBuffers[frameInfo.frameIndex]->writeAt(ubo, 0);
+    _pointLightBuffers[frameInfo.frameIndex]->writeAt(_pointLights, 0);
+    _spotLightBuffers[frameInfo.frameIndex]->writeAt(_spotLights, 0);
+
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, _pipeline->getHandle());
+
+    const auto buffers = getBuffers(frameInfo.frameIndex);
+    DescriptorWriter(*_descriptorLayout)
+        .writeBuffer(4, buffers.clusterUbo.getDescriptorInfo())
+        .writeBuffer(5, buffers.pointLights.getDescriptorInfo())
+        .writeBuffer(6, buffers.spotLights.getDescriptorInfo())
+        .writeBuffer(7, buffers.lightGrid.getDescriptorInfo())
+        .writeBuffer(8, buffers.lightIndices.getDescriptorInfo())
+        .push(frameInfo.commandBuffer, _pipelineLayout, vk::PipelineBindPoint::eCompute);
+
+    frameInfo.commandBuffer.dispatch((clusterCount + workGroupSize - 1) / workGroupSize, 1, 1);
+}
+
+auto LightCullingSystem::latchCamera(uint32_t frameIndex, const Camera& camera) -> void
+{
+    _clusterUboBuffers[frameIndex]->writeAt(camera.getView(), offsetof(ClusterUbo, view));
+}
+
+auto LightCullingSystem::getBuffers(uint32_t frameIndex) const -> Buffers
+{
+    return {.clusterUbo = *_clusterUboBuffers[frameIndex],
+            .pointLights = *_pointLightBuffers[frameIndex],
+            .spotLights = *_spotLightBuffers[frameIndex],
+            .lightGrid = *_lightGridBuffers[frameIndex],
+            .lightIndices = *_lightIndexBuffers[frameIndex]};
+}
+
+}
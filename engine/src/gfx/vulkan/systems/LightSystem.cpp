@@ -4,6 +4,7 @@
 
 #include "panda/gfx/vulkan/systems/LightSystem.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <glm/ext/vector_float4.hpp>
 #include <memory>
@@ -16,6 +17,7 @@
 #include "panda/gfx/vulkan/Device.h"
 #include "panda/gfx/vulkan/FrameInfo.h"
 #include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
 #include "panda/gfx/vulkan/UboLight.h"
 #include "panda/internal/config.h"
 #include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
@@ -35,13 +37,13 @@ struct LightPushConstants
 namespace panda::gfx::vulkan
 {
 
-LightSystem::LightSystem(const Device& device, vk::RenderPass renderPass)
+LightSystem::LightSystem(const Device& device, vk::RenderPass renderPass, ShadingMode shadingMode)
     : _device {device},
       _descriptorLayout {DescriptorSetLayout::Builder(_device)
                              .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
                              .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR)},
       _pipelineLayout {createPipelineLayout(_device, _descriptorLayout->getDescriptorSetLayout())},
-      _pipeline {createPipeline(_device, renderPass, _pipelineLayout)}
+      _pipeline {createPipeline(_device, renderPass, _pipelineLayout, shadingMode)}
 {
 }
 
@@ -50,8 +52,10 @@ LightSystem::~LightSystem() noexcept
     _device.logicalDevice.destroyPipelineLayout(_pipelineLayout);
 }
 
-auto LightSystem::createPipeline(const Device& device, vk::RenderPass renderPass, vk::PipelineLayout pipelineLayout)
-    -> std::unique_ptr<Pipeline>
+auto LightSystem::createPipeline(const Device& device,
+                                 vk::RenderPass renderPass,
+                                 vk::PipelineLayout pipelineLayout,
+                                 ShadingMode shadingMode) -> std::unique_ptr<Pipeline>
 {
     const auto inputAssemblyInfo =
         vk::PipelineInputAssemblyStateCreateInfo {{}, vk::PrimitiveTopology::eTriangleList, vk::False};
@@ -84,8 +88,9 @@ auto LightSystem::createPipeline(const Device& device, vk::RenderPass renderPass
     const auto colorBlendInfo =
         vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachment};
 
+    const auto depthWrite = shadingMode == ShadingMode::Deferred ? vk::False : vk::True;
     const auto depthStencilInfo =
-        vk::PipelineDepthStencilStateCreateInfo {{}, vk::True, vk::True, vk::CompareOp::eLess, vk::False, vk::False};
+        vk::PipelineDepthStencilStateCreateInfo {{}, vk::True, depthWrite, vk::CompareOp::eLess, vk::False, vk::False};
 
     return std::make_unique<Pipeline>(device,
                                       PipelineConfig {.vertexShaderPath = config::shaderPath / "pointLight.vert.spv",
@@ -100,7 +105,7 @@ auto LightSystem::createPipeline(const Device& device, vk::RenderPass renderPass
                                                       .depthStencilInfo = depthStencilInfo,
                                                       .pipelineLayout = pipelineLayout,
                                                       .renderPass = renderPass,
-                                                      .subpass = 0});
+                                                      .subpass = getLightingSubpass(shadingMode)});
 }
 
 auto LightSystem::createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout
@@ -121,7 +126,7 @@ auto LightSystem::render(const FrameInfo& frameInfo) const -> void
     frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, _pipeline->getHandle());
 
     DescriptorWriter(*_descriptorLayout)
-        .writeBuffer(0, frameInfo.vertUbo.getDescriptorInfo())
+        .writeBuffer(0, frameInfo.vertUbo)
         .push(frameInfo.commandBuffer, _pipelineLayout);
     static constexpr auto cubeVerticesCount = 6;
     for (const auto& light : frameInfo.scene.getLights().pointLights)
@@ -171,8 +176,8 @@ auto LightSystem::update(const Lights& lights, FragUbo& ubo) -> void
         ubo.spotLights[i] = fromSpotLight(lights.spotLights[i]);
     }
 
-    ubo.activeDirectionalLights = lights.directionalLights.size();
-    ubo.activePointLights = lights.pointLights.size();
-    ubo.activeSpotLights = lights.spotLights.size();
+    ubo.activeDirectionalLights = std::min(lights.directionalLights.size(), ubo.directionalLights.size());
+    ubo.activePointLights = std::min(lights.pointLights.size(), ubo.pointLights.size());
+    ubo.activeSpotLights = std::min(lights.spotLights.size(), ubo.spotLights.size());
 }
 }
@@ -0,0 +1,429 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/ext/vector_uint2.hpp>
+#include <glm/geometric.hpp>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/gfx/Camera.h"
+#include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Context.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
+#include "panda/gfx/vulkan/Descriptor.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/FrameInfo.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/object/Mesh.h"
+#include "panda/gfx/vulkan/object/Object.h"
+#include "panda/internal/config.h"
+#include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
+
+namespace panda::gfx::vulkan
+{
+
+OcclusionCullingSystem::OcclusionCullingSystem(const Device& device,
+                                               DeletionQueue& deletionQueue,
+                                               size_t framesInFlight)
+    : _device {device},
+      _deletionQueue {deletionQueue},
+      _pyramidDescriptorLayout {
+          DescriptorSetLayout::Builder(_device)
+              .addBinding(0, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(1, vk::DescriptorType::eStorageImage, vk::ShaderStageFlagBits::eCompute)
+              .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR)},
+      _pyramidPipelineLayout {
+          createPipelineLayout(_device, _pyramidDescriptorLayout->getDescriptorSetLayout(), sizeof(glm::uvec2))},
+      _pyramidPipeline {std::make_unique<ComputePipeline>(
+          _device,
+          ComputePipelineConfig {.shaderPath = config::shaderPath / "depthPyramid.comp.spv",
+                                 .pipelineLayout = _pyramidPipelineLayout,
+                                 .specialization = {}})},
+      _cullingDescriptorLayout {
+          DescriptorSetLayout::Builder(_device)
+              .addBinding(0, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(2, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(4, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .addBinding(5, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+              .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR)},
+      _cullingPipelineLayout {
+          createPipelineLayout(_device, _cullingDescriptorLayout->getDescriptorSetLayout(), sizeof(uint32_t))},
+      _objectCullingPipeline {std::make_unique<ComputePipeline>(
+          _device,
+          ComputePipelineConfig {.shaderPath = config::shaderPath / "occlusionCulling.comp.spv",
+                                 .pipelineLayout = _cullingPipelineLayout,
+                                 .specialization = {}})},
+      _instanceCullingPipeline {std::make_unique<ComputePipeline>(
+          _device,
+          ComputePipelineConfig {.shaderPath = config::shaderPath / "instanceCulling.comp.spv",
+                                 .pipelineLayout = _cullingPipelineLayout,
+                                 .specialization = {}})},
+      _sampler {createSampler(_device)},
+      _submittedKeys(framesInFlight)
+{
+    for (auto i = uint32_t {}; i < framesInFlight; i++)
+    {
+        _cullingUboBuffers.push_back(std::make_unique<Buffer>(
+            _device,
+            sizeof(CullingUbo),
+            1,
+            vk::BufferUsageFlagBits::eUniformBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            _device.physicalDevice.getProperties().limits.minUniformBufferOffsetAlignment));
+        _cullingUboBuffers.back()->mapWhole();
+
+        _sphereBuffers.push_back(std::make_unique<Buffer>(
+            _device,
+            sizeof(glm::vec4),
+            maxObjectCount,
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
+        _sphereBuffers.back()->mapWhole();
+
+        _visibilityBuffers.push_back(std::make_unique<Buffer>(
+            _device,
+            sizeof(uint32_t),
+            maxObjectCount,
+            vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
+        _visibilityBuffers.back()->mapWhole();
+    }
+}
+
+OcclusionCullingSystem::~OcclusionCullingSystem() noexcept
+{
+    if (_pyramid.image)
+    {
+        destroyPyramid(_device, _pyramid);
+    }
+    _device.logicalDevice.destroy(_sampler);
+    _device.logicalDevice.destroyPipelineLayout(_cullingPipelineLayout);
+    _device.logicalDevice.destroyPipelineLayout(_pyramidPipelineLayout);
+}
+
+auto OcclusionCullingSystem::getBoundingSphere(const Transform& transform, const Mesh& mesh) -> glm::vec4
+{
+    const auto& boundingSphere = mesh.getBoundingSphere();
+    const auto maxScale =
+        std::max({std::abs(transform.scale.x), std::abs(transform.scale.y), std::abs(transform.scale.z)});
+    return {transform.translation, (glm::length(boundingSphere.center) + boundingSphere.radius) * maxScale};
+}
+
+auto OcclusionCullingSystem::update(const FrameInfo& frameInfo) -> void
+{
+    const auto ubo = CullingUbo {
+        .viewProjection = _pyramidViewProjection,
+        .pyramidSize = {static_cast<float>(_pyramid.extent.width), static_cast<float>(_pyramid.extent.height)},
+        .mipCount = _pyramid.mipCount};
+    _cullingUboBuffers[frameInfo.frameIndex]->writeAt(ubo, 0);
+
+    // Results arrive frames after submission, so they are matched to surfaces by key rather than by draw order
+    const auto& keys = _submittedKeys[frameInfo.frameIndex];
+    _readback.resize(keys.size());
+    _visibilityBuffers[frameInfo.frameIndex]->readAt(std::span {_readback}, 0);
+
+    _visibility.clear();
+    for (auto i = size_t {}; i < keys.size(); i++)
+    {
+        _visibility.insert_or_assign(keys[i], _readback[i] != 0);
+    }
+}
+
+auto OcclusionCullingSystem::cullObjects(const FrameInfo& frameInfo,
+                                         std::span<const glm::vec4> spheres,
+                                         std::span<const DrawKey> keys) -> void
+{
+    expect(spheres.size() == keys.size(), "Every culled sphere needs a draw key");
+    const auto count = static_cast<uint32_t>(std::min<size_t>(spheres.size(), maxObjectCount));
+
+    auto& submittedKeys = _submittedKeys[frameInfo.frameIndex];
+    submittedKeys.clear();
+    if (!_isPyramidReady || count == 0)
+    {
+        return;
+    }
+    submittedKeys.assign(keys.begin(), keys.begin() + count);
+
+    _sphereBuffers[frameInfo.frameIndex]->writeAt(spheres.first(count), 0);
+
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, _objectCullingPipeline->getHandle());
+
+    const auto pyramidInfo = getPyramidDescriptorInfo();
+    DescriptorWriter(*_cullingDescriptorLayout)
+        .writeImage(0, pyramidInfo)
+        .writeBuffer(1, _cullingUboBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+        .writeBuffer(2, _sphereBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+        .writeBuffer(3, _visibilityBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+        .push(frameInfo.commandBuffer, _cullingPipelineLayout, vk::PipelineBindPoint::eCompute);
+
+    frameInfo.commandBuffer.pushConstants<uint32_t>(_cullingPipelineLayout,
+                                                    vk::ShaderStageFlagBits::eCompute,
+                                                    0,
+                                                    count);
+    frameInfo.commandBuffer.dispatch((count + workGroupSize - 1) / workGroupSize, 1, 1);
+
+    const auto barrier = vk::MemoryBarrier {vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eHostRead};
+    frameInfo.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                            vk::PipelineStageFlagBits::eHost,
+                                            {},
+                                            barrier,
+                                            {},
+                                            {});
+}
+
+auto OcclusionCullingSystem::cullInstances(const FrameInfo& frameInfo,
+                                           const InstanceBuffers& buffers,
+                                           uint32_t instanceCount) const -> bool
+{
+    if (!_isPyramidReady || instanceCount == 0)
+    {
+        return false;
+    }
+
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, _instanceCullingPipeline->getHandle());
+
+    const auto pyramidInfo = getPyramidDescriptorInfo();
+    DescriptorWriter(*_cullingDescriptorLayout)
+        .writeImage(0, pyramidInfo)
+        .writeBuffer(1, _cullingUboBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+        .writeBuffer(2, buffers.instances.getDescriptorInfo())
+        .writeBuffer(3, buffers.bounds.getDescriptorInfo())
+        .writeBuffer(4, buffers.culledInstances.getDescriptorInfo())
+        .writeBuffer(5, buffers.drawCommands.getDescriptorInfo())
+        .push(frameInfo.commandBuffer, _cullingPipelineLayout, vk::PipelineBindPoint::eCompute);
+
+    frameInfo.commandBuffer.pushConstants<uint32_t>(_cullingPipelineLayout,
+                                                    vk::ShaderStageFlagBits::eCompute,
+                                                    0,
+                                                    instanceCount);
+    frameInfo.commandBuffer.dispatch((instanceCount + workGroupSize - 1) / workGroupSize, 1, 1);
+    return true;
+}
+
+auto OcclusionCullingSystem::resizePyramid(vk::Extent2D depthExtent) -> void
+{
+    if (_pyramid.image && _pyramid.depthExtent == depthExtent)
+    {
+        return;
+    }
+
+    if (_pyramid.image)
+    {
+        _deletionQueue.push([&device = _device, pyramid = _pyramid] {
+            destroyPyramid(device, pyramid);
+        });
+    }
+    _pyramid = createPyramid(_device, depthExtent);
+    _isPyramidReady = false;
+}
+
+auto OcclusionCullingSystem::buildPyramid(const FrameInfo& frameInfo,
+                                          vk::ImageView depthView,
+                                          vk::Extent2D renderExtent) -> void
+{
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, _pyramidPipeline->getHandle());
+
+    for (auto level = uint32_t {}; level < _pyramid.mipCount; level++)
+    {
+        const auto inputInfo =
+            level == 0
+                ? vk::DescriptorImageInfo {_sampler, depthView, vk::ImageLayout::eDepthStencilReadOnlyOptimal}
+                : vk::DescriptorImageInfo {_sampler, _pyramid.mipViews[level - 1], vk::ImageLayout::eGeneral};
+        const auto outputInfo = vk::DescriptorImageInfo {{}, _pyramid.mipViews[level], vk::ImageLayout::eGeneral};
+
+        DescriptorWriter(*_pyramidDescriptorLayout)
+            .writeImage(0, inputInfo)
+            .writeImage(1, outputInfo)
+            .push(frameInfo.commandBuffer, _pyramidPipelineLayout, vk::PipelineBindPoint::eCompute);
+
+        const auto inputSize = level == 0 ? glm::uvec2 {renderExtent.width, renderExtent.height}
+                                          : glm::uvec2 {std::max(_pyramid.extent.width >> (level - 1), 1U),
+                                                        std::max(_pyramid.extent.height >> (level - 1), 1U)};
+        frameInfo.commandBuffer.pushConstants<glm::uvec2>(_pyramidPipelineLayout,
+                                                          vk::ShaderStageFlagBits::eCompute,
+                                                          0,
+                                                          inputSize);
+
+        const auto width = std::max(_pyramid.extent.width >> level, 1U);
+        const auto height = std::max(_pyramid.extent.height >> level, 1U);
+        frameInfo.commandBuffer.dispatch((width + pyramidWorkGroupSize - 1) / pyramidWorkGroupSize,
+                                         (height + pyramidWorkGroupSize - 1) / pyramidWorkGroupSize,
+                                         1);
+
+        const auto barrier = vk::MemoryBarrier {vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead};
+        frameInfo.commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+                                                vk::PipelineStageFlagBits::eComputeShader,
+                                                {},
+                                                barrier,
+                                                {},
+                                                {});
+    }
+
+    const auto& camera = frameInfo.scene.getCamera();
+    _pyramidViewProjection = camera.getProjection() * camera.getView();
+    _isPyramidReady = true;
+}
+
+auto OcclusionCullingSystem::latchCamera(const Camera& camera) -> void
+{
+    // The depth the pyramid is built from is rendered with the latched camera, so it has to be reprojected with it
+    _pyramidViewProjection = camera.getProjection() * camera.getView();
+}
+
+auto OcclusionCullingSystem::isPyramidReady() const noexcept -> bool
+{
+    return _isPyramidReady;
+}
+
+auto OcclusionCullingSystem::getPyramidImage() const noexcept -> vk::Image
+{
+    return _pyramid.image;
+}
+
+auto OcclusionCullingSystem::getPyramidRange() const noexcept -> vk::ImageSubresourceRange
+{
+    return {vk::ImageAspectFlagBits::eColor, 0, _pyramid.mipCount, 0, 1};
+}
+
+auto OcclusionCullingSystem::isVisible(const DrawKey& key) const noexcept -> bool
+{
+    const auto it = _visibility.find(key);
+    return it == _visibility.end() || it->second;
+}
+
+auto OcclusionCullingSystem::getPyramidDescriptorInfo() const noexcept -> vk::DescriptorImageInfo
+{
+    return {_sampler, _pyramid.view, vk::ImageLayout::eGeneral};
+}
+
+auto OcclusionCullingSystem::createPipelineLayout(const Device& device,
+                                                  vk::DescriptorSetLayout setLayout,
+                                                  uint32_t pushConstantSize) -> vk::PipelineLayout
+{
+    const auto pushConstantData = vk::PushConstantRange {vk::ShaderStageFlagBits::eCompute, 0, pushConstantSize};
+
+    const auto pipelineLayoutInfo =
+        pushConstantSize == 0 ? vk::PipelineLayoutCreateInfo {{}, setLayout}
+                              : vk::PipelineLayoutCreateInfo {{}, setLayout, pushConstantData};
+    return expect(device.logicalDevice.createPipelineLayout(pipelineLayoutInfo),
+                  vk::Result::eSuccess,
+                  "Can't create pipeline layout");
+}
+
+auto OcclusionCullingSystem::createSampler(const Device& device) -> vk::Sampler
+{
+    const auto samplerInfo = vk::SamplerCreateInfo {{},
+                                                    vk::Filter::eNearest,
+                                                    vk::Filter::eNearest,
+                                                    vk::SamplerMipmapMode::eNearest,
+                                                    vk::SamplerAddressMode::eClampToEdge,
+                                                    vk::SamplerAddressMode::eClampToEdge,
+                                                    vk::SamplerAddressMode::eClampToEdge,
+                                                    0.F,
+                                                    vk::False,
+                                                    1.F,
+                                                    vk::False,
+                                                    vk::CompareOp::eAlways,
+                                                    0.F,
+                                                    vk::LodClampNone,
+                                                    vk::BorderColor::eFloatOpaqueWhite,
+                                                    vk::False};
+
+    return expect(device.logicalDevice.createSampler(samplerInfo), vk::Result::eSuccess, "Failed to create sampler");
+}
+
+auto OcclusionCullingSystem::createPyramid(const Device& device, vk::Extent2D depthExtent) -> Pyramid
+{
+    const auto extent =
+        vk::Extent2D {std::max((depthExtent.width + 1) / 2, 1U), std::max((depthExtent.height + 1) / 2, 1U)};
+    const auto mipCount = static_cast<uint32_t>(std::bit_width(std::max(extent.width, extent.height)));
+
+    const auto imageInfo = vk::ImageCreateInfo {
+        {},
+        vk::ImageType::e2D,
+        pyramidFormat,
+        {extent.width, extent.height, 1},
+        mipCount,
+        1,
+        vk::SampleCountFlagBits::e1,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+        vk::SharingMode::eExclusive
+    };
+    const auto image =
+        expect(device.logicalDevice.createImage(imageInfo), vk::Result::eSuccess, "Failed to create depth pyramid");
+
+    const auto memoryRequirements = device.logicalDevice.getImageMemoryRequirements(image);
+    const auto allocInfo = vk::MemoryAllocateInfo {
+        memoryRequirements.size,
+        expect(device.findMemoryType(memoryRequirements.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal),
+               "Failed to find memory type")};
+    const auto memory = expect(device.logicalDevice.allocateMemory(allocInfo),
+                               vk::Result::eSuccess,
+                               "Failed to allocate depth pyramid memory");
+    expect(device.logicalDevice.bindImageMemory(image, memory, 0),
+           vk::Result::eSuccess,
+           "Failed to bind depth pyramid memory");
+
+    const auto createView = [&device, image](uint32_t baseLevel, uint32_t levelCount) {
+        const auto viewInfo = vk::ImageViewCreateInfo {
+            {},
+            image,
+            vk::ImageViewType::e2D,
+            pyramidFormat,
+            {},
+            {vk::ImageAspectFlagBits::eColor, baseLevel, levelCount, 0, 1}
+        };
+        return expect(device.logicalDevice.createImageView(viewInfo),
+                      vk::Result::eSuccess,
+                      "Failed to create depth pyramid view");
+    };
+
+    auto mipViews = std::vector<vk::ImageView> {};
+    mipViews.reserve(mipCount);
+    for (auto level = uint32_t {}; level < mipCount; level++)
+    {
+        mipViews.push_back(createView(level, 1));
+    }
+
+    return {.image = image,
+            .memory = memory,
+            .view = createView(0, mipCount),
+            .mipViews = std::move(mipViews),
+            .depthExtent = depthExtent,
+            .extent = extent,
+            .mipCount = mipCount};
+}
+
+auto OcclusionCullingSystem::destroyPyramid(const Device& device, const Pyramid& pyramid) -> void
+{
+    for (const auto view : pyramid.mipViews)
+    {
+        device.logicalDevice.destroy(view);
+    }
+    device.logicalDevice.destroy(pyramid.view);
+    device.logicalDevice.destroy(pyramid.image);
+    device.logicalDevice.free(pyramid.memory);
+}
+
+}
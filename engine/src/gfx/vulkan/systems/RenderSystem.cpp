@@ -4,24 +4,43 @@
 
 #include "panda/gfx/vulkan/systems/RenderSystem.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
 #include <memory>
+#include <optional>
+#include <span>
+#include <vector>
 #include <vulkan/vulkan.hpp>
 #include <vulkan/vulkan_enums.hpp>
 #include <vulkan/vulkan_handles.hpp>
 
+#include "panda/Logger.h"
 #include "panda/gfx/vulkan/Buffer.h"
+#include "panda/gfx/vulkan/Context.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
 #include "panda/gfx/vulkan/Descriptor.h"
 #include "panda/gfx/vulkan/Device.h"
 #include "panda/gfx/vulkan/FrameInfo.h"
+#include "panda/gfx/vulkan/LightCounts.h"
 #include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/gfx/vulkan/RenderQueue.h"
 #include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/SecondaryCommandRecorder.h"
+#include "panda/gfx/vulkan/ShadingMode.h"
 #include "panda/gfx/vulkan/Vertex.h"
+#include "panda/gfx/vulkan/systems/InstancedRenderSystem.h"
+#include "panda/gfx/vulkan/systems/LightCullingSystem.h"
 #include "panda/gfx/vulkan/object/Mesh.h"
 #include "panda/gfx/vulkan/object/Object.h"
 #include "panda/gfx/vulkan/object/Surface.h"
 #include "panda/gfx/vulkan/object/Texture.h"
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
+#include "panda/gfx/vulkan/systems/SoftwareOcclusionSystem.h"
+#include "panda/gfx/vulkan/systems/StaticBatchSystem.h"
 #include "panda/internal/config.h"
 #include "panda/utils/Utils.h"
 #include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
@@ -32,36 +51,109 @@ namespace panda::gfx::vulkan
 namespace
 {
 
-struct PushConstantData
-{
-    alignas(16) glm::vec3 translation;
-    alignas(16) glm::vec3 scale;
-    alignas(16) glm::vec3 rotation;
-};
+const auto batchTransform = Transform {};
 
 }
 
-RenderSystem::RenderSystem(const Device& device, vk::RenderPass renderPass)
+RenderSystem::RenderSystem(const Device& device,
+                           DeletionQueue& deletionQueue,
+                           utils::JobSystem& jobSystem,
+                           vk::RenderPass renderPass,
+                           size_t framesInFlight,
+                           ShadingMode shadingMode,
+                           const LightCullingSystem* lightCullingSystem,
+                           bool useDepthPrepass,
+                           OcclusionCullingSystem* occlusionCullingSystem,
+                           const SoftwareOcclusionSystem* softwareOcclusionSystem,
+                           bool useStaticCommandBuffers,
+                           const StaticBatchSystem* staticBatchSystem,
+                           const InstancedRenderSystem* instancedRenderSystem)
     : _device {device},
-      _descriptorLayout {
-          DescriptorSetLayout::Builder(_device)
-              .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
-              .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
-              .addBinding(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
-              .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR)},
+      _deletionQueue {deletionQueue},
+      _descriptorLayout {createDescriptorLayout(_device, lightCullingSystem != nullptr)},
       _pipelineLayout {createPipelineLayout(_device, _descriptorLayout->getDescriptorSetLayout())},
-      _pipeline {createPipeline(_device, renderPass, _pipelineLayout)}
-
+      _renderPass {renderPass},
+      _shadingMode {shadingMode},
+      _lightCullingSystem {lightCullingSystem},
+      _useDepthPrepass {useDepthPrepass},
+      _occlusionCullingSystem {occlusionCullingSystem},
+      _softwareOcclusionSystem {softwareOcclusionSystem},
+      _staticBatchSystem {staticBatchSystem},
+      _instancedRenderSystem {instancedRenderSystem},
+      _pipelines {jobSystem, [this](const LightCounts& lightCounts) {
+          return createPipeline(lightCounts);
+      }}
 {
+    if (_useDepthPrepass)
+    {
+        _packedDepthPipeline = createDepthPipeline(true);
+        _interleavedDepthPipeline = createDepthPipeline(false);
+    }
+
+    _objectBuffers.resize(framesInFlight);
+    _objectCapacities.resize(framesInFlight);
+    for (auto i = uint32_t {}; i < framesInFlight; i++)
+    {
+        createObjectBuffer(i, initialObjectCount);
+    }
+
+    if (useStaticCommandBuffers)
+    {
+        const auto commandPoolInfo = vk::CommandPoolCreateInfo {vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+                                                                _device.queueFamilies.graphicsFamily};
+        _staticCommandPool = expect(_device.logicalDevice.createCommandPool(commandPoolInfo),
+                                    vk::Result::eSuccess,
+                                    "Can't create static command pool");
+
+        const auto allocationInfo = vk::CommandBufferAllocateInfo {_staticCommandPool,
+                                                                   vk::CommandBufferLevel::eSecondary,
+                                                                   static_cast<uint32_t>(framesInFlight)};
+        for (const auto commandBuffer : expect(_device.logicalDevice.allocateCommandBuffers(allocationInfo),
+                                               vk::Result::eSuccess,
+                                               "Can't allocate static command buffers"))
+        {
+            _staticCommandBuffers.push_back({.commandBuffer = commandBuffer, .signature = std::nullopt});
+        }
+    }
 }
 
 RenderSystem::~RenderSystem() noexcept
 {
+    if (_staticCommandPool)
+    {
+        _device.logicalDevice.destroyCommandPool(_staticCommandPool);
+    }
+    _pipelines.waitForPending();
     _device.logicalDevice.destroyPipelineLayout(_pipelineLayout);
 }
 
-auto RenderSystem::createPipeline(const Device& device, vk::RenderPass renderPass, vk::PipelineLayout pipelineLayout)
-    -> std::unique_ptr<Pipeline>
+auto RenderSystem::createDescriptorLayout(const Device& device, bool useClusteredLighting)
+    -> std::unique_ptr<DescriptorSetLayout>
+{
+    if (!useClusteredLighting)
+    {
+        return DescriptorSetLayout::Builder(device)
+            .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
+            .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+            .addBinding(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+            .addBinding(3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eVertex)
+            .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR);
+    }
+
+    return DescriptorSetLayout::Builder(device)
+        .addBinding(0, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
+        .addBinding(1, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(2, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(3, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eVertex)
+        .addBinding(4, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(5, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(6, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(7, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .addBinding(8, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eFragment)
+        .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR);
+}
+
+auto RenderSystem::createPipeline(const LightCounts& lightCounts) const -> std::unique_ptr<Pipeline>
 {
     const auto inputAssemblyInfo =
         vk::PipelineInputAssemblyStateCreateInfo {{}, vk::PrimitiveTopology::eTriangleList, vk::False};
@@ -91,16 +183,23 @@ auto RenderSystem::createPipeline(const Device& device, vk::RenderPass renderPas
                                                vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
                                                    vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
 
+    const auto colorBlendAttachments = std::vector(_shadingMode == ShadingMode::Deferred ? 2 : 1, colorBlendAttachment);
+
     const auto colorBlendInfo =
-        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachment};
+        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachments};
 
     const auto depthStencilInfo =
-        vk::PipelineDepthStencilStateCreateInfo {{}, vk::True, vk::True, vk::CompareOp::eLess, vk::False, vk::False};
+        vk::PipelineDepthStencilStateCreateInfo {{},
+                                                 vk::True,
+                                                 _useDepthPrepass ? vk::False : vk::True,
+                                                 _useDepthPrepass ? vk::CompareOp::eEqual : vk::CompareOp::eLess,
+                                                 vk::False,
+                                                 vk::False};
 
     return std::make_unique<Pipeline>(
-        device,
+        _device,
         PipelineConfig {.vertexShaderPath = config::shaderPath / "basic.vert.spv",
-                        .fragmentShaderPath = config::shaderPath / "basic.frag.spv",
+                        .fragmentShaderPath = getFragmentShaderPath(),
                         .vertexBindingDescriptions = {Vertex::getBindingDescription()},
                         .vertexAttributeDescriptions = utils::fromArray(Vertex::getAttributeDescriptions()),
                         .inputAssemblyInfo = inputAssemblyInfo,
@@ -109,51 +208,465 @@ auto RenderSystem::createPipeline(const Device& device, vk::RenderPass renderPas
                         .multisamplingInfo = multisamplingInfo,
                         .colorBlendInfo = colorBlendInfo,
                         .depthStencilInfo = depthStencilInfo,
-                        .pipelineLayout = pipelineLayout,
-                        .renderPass = renderPass,
-                        .subpass = 0});
+                        .pipelineLayout = _pipelineLayout,
+                        .renderPass = _renderPass,
+                        .subpass = 0,
+                        .vertexSpecialization = {},
+                        .fragmentSpecialization = lightCounts.getSpecializationConstants()});
 }
 
-auto RenderSystem::createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout
+auto RenderSystem::createDepthPipeline(bool packedPositions) const -> std::unique_ptr<Pipeline>
 {
-    const auto pushConstantData = vk::PushConstantRange {vk::ShaderStageFlagBits::eVertex, 0, sizeof(PushConstantData)};
+    const auto inputAssemblyInfo =
+        vk::PipelineInputAssemblyStateCreateInfo {{}, vk::PrimitiveTopology::eTriangleList, vk::False};
+
+    const auto viewportInfo = vk::PipelineViewportStateCreateInfo {{}, 1, {}, 1, {}};
+    const auto rasterizationInfo = vk::PipelineRasterizationStateCreateInfo {{},
+                                                                             vk::False,
+                                                                             vk::False,
+                                                                             vk::PolygonMode::eFill,
+                                                                             vk::CullModeFlagBits::eBack,
+                                                                             vk::FrontFace::eCounterClockwise,
+                                                                             vk::False,
+                                                                             {},
+                                                                             {},
+                                                                             {},
+                                                                             1.F};
+
+    const auto multisamplingInfo = vk::PipelineMultisampleStateCreateInfo {{}, vk::SampleCountFlagBits::e1, vk::False};
+    const auto colorBlendAttachment =
+        vk::PipelineColorBlendAttachmentState {vk::False,
+                                               vk::BlendFactor::eOne,
+                                               vk::BlendFactor::eZero,
+                                               vk::BlendOp::eAdd,
+                                               vk::BlendFactor::eOne,
+                                               vk::BlendFactor::eZero,
+                                               vk::BlendOp::eAdd,
+                                               {}};
+
+    const auto colorBlendAttachments = std::vector(_shadingMode == ShadingMode::Deferred ? 2 : 1, colorBlendAttachment);
+
+    const auto colorBlendInfo =
+        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachments};
+
+    static constexpr auto depthStencilInfo =
+        vk::PipelineDepthStencilStateCreateInfo {{}, vk::True, vk::True, vk::CompareOp::eLess, vk::False, vk::False};
+
+    return std::make_unique<Pipeline>(
+        _device,
+        PipelineConfig {.vertexShaderPath = config::shaderPath / "depth.vert.spv",
+                        .fragmentShaderPath = {},
+                        .vertexBindingDescriptions = {Vertex::getPositionBindingDescription(packedPositions)},
+                        .vertexAttributeDescriptions = {Vertex::getPositionAttributeDescription()},
+                        .inputAssemblyInfo = inputAssemblyInfo,
+                        .viewportInfo = viewportInfo,
+                        .rasterizationInfo = rasterizationInfo,
+                        .multisamplingInfo = multisamplingInfo,
+                        .colorBlendInfo = colorBlendInfo,
+                        .depthStencilInfo = depthStencilInfo,
+                        .pipelineLayout = _pipelineLayout,
+                        .renderPass = _renderPass,
+                        .subpass = 0,
+                        .vertexSpecialization = {},
+                        .fragmentSpecialization = {}});
+}
 
-    const auto pipelineLayoutInfo = vk::PipelineLayoutCreateInfo {{}, setLayout, pushConstantData};
+auto RenderSystem::createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout) -> vk::PipelineLayout
+{
+    const auto pipelineLayoutInfo = vk::PipelineLayoutCreateInfo {{}, setLayout};
     return expect(device.logicalDevice.createPipelineLayout(pipelineLayoutInfo),
                   vk::Result::eSuccess,
                   "Can't create pipeline layout");
 }
 
-auto RenderSystem::render(const FrameInfo& frameInfo) const -> void
+auto RenderSystem::getFragmentShaderPath() const -> std::filesystem::path
 {
-    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, _pipeline->getHandle());
+    if (_shadingMode == ShadingMode::Deferred)
+    {
+        return config::shaderPath / "gbuffer.frag.spv";
+    }
+    return config::shaderPath / (_lightCullingSystem != nullptr ? "clustered.frag.spv" : "basic.frag.spv");
+}
+
+auto RenderSystem::getPipeline(LightCounts lightCounts) -> const Pipeline&
+{
+    if (_shadingMode == ShadingMode::Deferred)
+    {
+        lightCounts = LightCounts {};
+    }
+    else if (_lightCullingSystem != nullptr)
+    {
+        lightCounts.pointLights = LightCounts::dynamicCount;
+        lightCounts.spotLights = LightCounts::dynamicCount;
+    }
+
+    return _pipelines.get(lightCounts);
+}
+
+auto RenderSystem::update(const FrameInfo& frameInfo) -> void
+{
+    _draws.clear();
+
+    const auto& view = frameInfo.scene.getCamera().getView();
+    auto surfaceIndex = size_t {};
 
     for (const auto& object : frameInfo.scene.getObjects())
     {
-        const auto push = PushConstantData {.translation = object->transform.translation,
-                                            .scale = object->transform.scale,
-                                            .rotation = object->transform.rotation};
+        const auto depth = (view * glm::vec4 {object->transform.translation, 1.F}).z;
+        const auto isStatic = object->isStatic && _staticCommandPool;
+        const auto isBatched = object->isStatic && _staticBatchSystem != nullptr;
+        const auto surfaces = object->getSurfaces();
+        for (auto i = size_t {}; i < surfaces.size(); i++)
+        {
+            const auto& surface = surfaces[i];
+            if (surface.isInstanced())
+            {
+                continue;
+            }
+
+            const auto isVisible = isSurfaceVisible(surfaceIndex++, {.object = object->getId(), .surface = i});
+            if (isBatched && StaticBatchSystem::isBatchable(surface))
+            {
+                continue;
+            }
+
+            if (!object->isStatic && _instancedRenderSystem != nullptr &&
+                _instancedRenderSystem->isAutoInstanced(surface))
+            {
+                continue;
+            }
+
+            if (isVisible || isStatic)
+            {
+                _draws.push_back(
+                    {.transform = &object->transform, .surface = surface, .depth = depth, .isStatic = isStatic});
+            }
+        }
+    }
 
-        frameInfo.commandBuffer.pushConstants<PushConstantData>(_pipelineLayout,
-                                                                vk::ShaderStageFlagBits::eVertex,
-                                                                0,
-                                                                push);
+    const auto batchSurfaces =
+        _staticBatchSystem != nullptr ? std::span {_staticBatchSystem->getSurfaces()} : std::span<const Surface> {};
 
-        for (const auto& surface : object->getSurfaces())
+    for (const auto& surface : batchSurfaces)
+    {
+        const auto& boundingSphere = surface.getMesh().getBoundingSphere();
+        const auto isVisible =
+            _occlusionCullingSystem == nullptr ||
+            _occlusionCullingSystem->isVisible(
+                {.object = OcclusionCullingSystem::batchObject, .surface = surface.getMesh().getId()});
+        if (isVisible || _staticCommandPool)
         {
-            if (!surface.isInstanced())
+            _draws.push_back({.transform = &batchTransform,
+                              .surface = surface,
+                              .depth = (view * glm::vec4 {boundingSphere.center, 1.F}).z,
+                              .isStatic = static_cast<bool>(_staticCommandPool)});
+        }
+    }
+
+    writeObjects(frameInfo);
+
+    if (_occlusionCullingSystem == nullptr)
+    {
+        return;
+    }
+
+    _spheres.clear();
+    _sphereKeys.clear();
+    for (const auto& object : frameInfo.scene.getObjects())
+    {
+        const auto surfaces = object->getSurfaces();
+        for (auto i = size_t {}; i < surfaces.size(); i++)
+        {
+            if (!surfaces[i].isInstanced())
             {
-                DescriptorWriter(*_descriptorLayout)
-                    .writeBuffer(0, frameInfo.vertUbo.getDescriptorInfo())
-                    .writeBuffer(1, frameInfo.fragUbo.getDescriptorInfo())
-                    .writeImage(2, surface.getTexture().getDescriptorImageInfo())
-                    .push(frameInfo.commandBuffer, _pipelineLayout);
-
-                surface.getMesh().bind(frameInfo.commandBuffer);
-                surface.getMesh().draw(frameInfo.commandBuffer);
+                _spheres.push_back(OcclusionCullingSystem::getBoundingSphere(object->transform, surfaces[i].getMesh()));
+                _sphereKeys.push_back({.object = object->getId(), .surface = i});
             }
         }
     }
+
+    for (const auto& surface : batchSurfaces)
+    {
+        const auto& boundingSphere = surface.getMesh().getBoundingSphere();
+        _spheres.emplace_back(boundingSphere.center, boundingSphere.radius);
+        _sphereKeys.push_back({.object = OcclusionCullingSystem::batchObject, .surface = surface.getMesh().getId()});
+    }
+
+    _occlusionCullingSystem->cullObjects(frameInfo, _spheres, _sphereKeys);
+}
+
+auto RenderSystem::renderDepthPrepass(const FrameInfo& frameInfo) -> void
+{
+    DescriptorWriter(*_descriptorLayout)
+        .writeBuffer(0, frameInfo.vertUbo)
+        .writeBuffer(3, _objectBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+        .push(frameInfo.commandBuffer, _pipelineLayout);
+
+    _renderQueue.clear();
+    for (auto i = uint32_t {}; i < _draws.size(); i++)
+    {
+        const auto& mesh = _draws[i].surface.getMesh();
+        _renderQueue.push({.pass = RenderQueue::Pass::DepthPrepass,
+                           .pipeline = mesh.hasPositionStream() ? 1U : 0U,
+                           .material = 0,
+                           .mesh = mesh.getId(),
+                           .depth = _draws[i].depth},
+                          i);
+    }
+    _renderQueue.sort();
+
+    auto boundPipeline = vk::Pipeline {};
+    const Mesh* boundMesh = nullptr;
+
+    for (const auto& entry : _renderQueue.getEntries())
+    {
+        const auto& draw = _draws[entry.drawIndex];
+        const auto& mesh = draw.surface.getMesh();
+        const auto pipeline =
+            mesh.hasPositionStream() ? _packedDepthPipeline->getHandle() : _interleavedDepthPipeline->getHandle();
+        if (pipeline != boundPipeline)
+        {
+            frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+            boundPipeline = pipeline;
+        }
+
+        if (&mesh != boundMesh)
+        {
+            mesh.bindPositions(frameInfo.commandBuffer);
+            boundMesh = &mesh;
+        }
+
+        mesh.drawInstanced(frameInfo.commandBuffer, 1, entry.drawIndex);
+    }
+}
+
+auto RenderSystem::render(const FrameInfo& frameInfo) -> void
+{
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics,
+                                         getPipeline(LightCounts::fromLights(frameInfo.scene.getLights())).getHandle());
+
+    sortDraws();
+    recordDraws(frameInfo, _renderQueue.getEntries());
+}
+
+auto RenderSystem::renderParallel(const FrameInfo& frameInfo, SecondaryCommandRecorder& commandRecorder)
+    -> std::vector<vk::CommandBuffer>
+{
+    static constexpr auto minDrawsPerCommandBuffer = size_t {64};
+
+    const auto pipeline = getPipeline(LightCounts::fromLights(frameInfo.scene.getLights())).getHandle();
+    sortDraws();
+
+    const auto recordJob = [this, &frameInfo, pipeline](vk::CommandBuffer commandBuffer, size_t begin, size_t end) {
+        auto secondaryFrameInfo = frameInfo;
+        secondaryFrameInfo.commandBuffer = commandBuffer;
+
+        commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+        recordDraws(secondaryFrameInfo, _renderQueue.getEntries().subspan(begin, end - begin));
+    };
+
+    return commandRecorder.record(_renderQueue.getEntries().size(), minDrawsPerCommandBuffer, recordJob);
+}
+
+auto RenderSystem::renderStatic(const FrameInfo& frameInfo, const SecondaryCommandRecorder& commandRecorder)
+    -> std::optional<vk::CommandBuffer>
+{
+    if (!_staticCommandPool || std::ranges::none_of(_draws, &Draw::isStatic))
+    {
+        return std::nullopt;
+    }
+
+    const auto pipeline = getPipeline(LightCounts::fromLights(frameInfo.scene.getLights())).getHandle();
+    const auto signature = getStaticSignature(frameInfo, pipeline, commandRecorder.getExtent());
+    auto& staticCommandBuffer = _staticCommandBuffers[frameInfo.frameIndex];
+
+    if (staticCommandBuffer.signature == signature)
+    {
+        return staticCommandBuffer.commandBuffer;
+    }
+
+    log::Debug("Recording static command buffer for frame {}", frameInfo.frameIndex);
+
+    auto staticFrameInfo = frameInfo;
+    staticFrameInfo.commandBuffer = staticCommandBuffer.commandBuffer;
+
+    sortStaticDraws();
+    commandRecorder.beginReusable(staticCommandBuffer.commandBuffer);
+    staticCommandBuffer.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+    recordDraws(staticFrameInfo, _staticRenderQueue.getEntries());
+    expect(staticCommandBuffer.commandBuffer.end(), vk::Result::eSuccess, "Can't end static command buffer");
+
+    staticCommandBuffer.signature = signature;
+    return staticCommandBuffer.commandBuffer;
+}
+
+auto RenderSystem::sortDraws() -> void
+{
+    _renderQueue.clear();
+    for (auto i = uint32_t {}; i < _draws.size(); i++)
+    {
+        if (_draws[i].isStatic)
+        {
+            continue;
+        }
+
+        _renderQueue.push({.pass = RenderQueue::Pass::Opaque,
+                           .pipeline = 0,
+                           .material = _draws[i].surface.getTexture().getId(),
+                           .mesh = _draws[i].surface.getMesh().getId(),
+                           .depth = _draws[i].depth},
+                          i);
+    }
+    _renderQueue.sort();
+}
+
+auto RenderSystem::sortStaticDraws() -> void
+{
+    _staticRenderQueue.clear();
+    for (auto i = uint32_t {}; i < _draws.size(); i++)
+    {
+        if (!_draws[i].isStatic)
+        {
+            continue;
+        }
+
+        _staticRenderQueue.push({.pass = RenderQueue::Pass::Opaque,
+                                 .pipeline = 0,
+                                 .material = _draws[i].surface.getTexture().getId(),
+                                 .mesh = _draws[i].surface.getMesh().getId(),
+                                 .depth = 0.F},
+                                i);
+    }
+    _staticRenderQueue.sort();
+}
+
+auto RenderSystem::getStaticSignature(const FrameInfo& frameInfo, vk::Pipeline pipeline, vk::Extent2D extent) const
+    -> size_t
+{
+    auto seed = size_t {};
+    utils::hashCombine(seed,
+                       static_cast<VkPipeline>(pipeline),
+                       static_cast<VkBuffer>(_objectBuffers[frameInfo.frameIndex]->buffer),
+                       static_cast<VkBuffer>(frameInfo.vertUbo.buffer),
+                       frameInfo.vertUbo.offset,
+                       static_cast<VkBuffer>(frameInfo.fragUbo.buffer),
+                       frameInfo.fragUbo.offset,
+                       extent.width,
+                       extent.height);
+
+    for (const auto& draw : _draws)
+    {
+        if (!draw.isStatic)
+        {
+            continue;
+        }
+
+        utils::hashCombine(seed,
+                           draw.transform,
+                           draw.surface,
+                           static_cast<VkImageView>(draw.surface.getTexture().getDescriptorImageInfo().imageView));
+    }
+
+    return seed;
+}
+
+auto RenderSystem::recordDraws(const FrameInfo& frameInfo, std::span<const RenderQueue::Entry> entries) const -> void
+{
+    const Texture* boundTexture = nullptr;
+    const Mesh* boundMesh = nullptr;
+
+    for (const auto& entry : entries)
+    {
+        const auto& draw = _draws[entry.drawIndex];
+        if (&draw.surface.getTexture() != boundTexture)
+        {
+            pushDescriptors(frameInfo, draw.surface.getTexture());
+            boundTexture = &draw.surface.getTexture();
+        }
+
+        if (&draw.surface.getMesh() != boundMesh)
+        {
+            draw.surface.getMesh().bind(frameInfo.commandBuffer);
+            boundMesh = &draw.surface.getMesh();
+        }
+
+        draw.surface.getMesh().drawInstanced(frameInfo.commandBuffer, 1, entry.drawIndex);
+    }
+}
+
+auto RenderSystem::writeObjects(const FrameInfo& frameInfo) -> void
+{
+    // Static draws go first so their object indices stay stable for the pre-recorded command buffers
+    std::ranges::stable_partition(_draws, &Draw::isStatic);
+
+    _objects.clear();
+    for (const auto& draw : _draws)
+    {
+        _objects.push_back({.translation = draw.transform->translation,
+                            .scale = draw.transform->scale,
+                            .rotation = draw.transform->rotation});
+    }
+
+    if (_objects.size() > _objectCapacities[frameInfo.frameIndex])
+    {
+        auto capacity = _objectCapacities[frameInfo.frameIndex];
+        while (capacity < _objects.size())
+        {
+            capacity *= 2;
+        }
+
+        _deletionQueue.push([buffer = std::shared_ptr<Buffer> {std::move(_objectBuffers[frameInfo.frameIndex])}] {});
+        createObjectBuffer(frameInfo.frameIndex, capacity);
+    }
+
+    _objectBuffers[frameInfo.frameIndex]->writeAt(_objects, 0);
+}
+
+auto RenderSystem::createObjectBuffer(uint32_t frameIndex, size_t capacity) -> void
+{
+    _objectBuffers[frameIndex] = std::make_unique<Buffer>(
+        _device,
+        sizeof(ObjectData),
+        capacity,
+        vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        _device.physicalDevice.getProperties().limits.minStorageBufferOffsetAlignment);
+    _objectBuffers[frameIndex]->mapWhole();
+    _objectCapacities[frameIndex] = capacity;
+}
+
+auto RenderSystem::pushDescriptors(const FrameInfo& frameInfo, const Texture& texture) const -> void
+{
+    if (_lightCullingSystem == nullptr)
+    {
+        DescriptorWriter(*_descriptorLayout)
+            .writeBuffer(0, frameInfo.vertUbo)
+            .writeBuffer(1, frameInfo.fragUbo)
+            .writeImage(2, texture.getDescriptorImageInfo())
+            .writeBuffer(3, _objectBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+            .push(frameInfo.commandBuffer, _pipelineLayout);
+        return;
+    }
+
+    const auto clusterBuffers = _lightCullingSystem->getBuffers(frameInfo.frameIndex);
+    DescriptorWriter(*_descriptorLayout)
+        .writeBuffer(0, frameInfo.vertUbo)
+        .writeBuffer(1, frameInfo.fragUbo)
+        .writeImage(2, texture.getDescriptorImageInfo())
+        .writeBuffer(3, _objectBuffers[frameInfo.frameIndex]->getDescriptorInfo())
+        .writeBuffer(4, clusterBuffers.clusterUbo.getDescriptorInfo())
+        .writeBuffer(5, clusterBuffers.pointLights.getDescriptorInfo())
+        .writeBuffer(6, clusterBuffers.spotLights.getDescriptorInfo())
+        .writeBuffer(7, clusterBuffers.lightGrid.getDescriptorInfo())
+        .writeBuffer(8, clusterBuffers.lightIndices.getDescriptorInfo())
+        .push(frameInfo.commandBuffer, _pipelineLayout);
+}
+
+auto RenderSystem::isSurfaceVisible(size_t surfaceIndex, const OcclusionCullingSystem::DrawKey& key) const noexcept
+    -> bool
+{
+    return (_occlusionCullingSystem == nullptr || _occlusionCullingSystem->isVisible(key)) &&
+           (_softwareOcclusionSystem == nullptr || _softwareOcclusionSystem->isVisible(surfaceIndex));
 }
 
 }
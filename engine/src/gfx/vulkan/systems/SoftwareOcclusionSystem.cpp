@@ -0,0 +1,345 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/systems/SoftwareOcclusionSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/object/Mesh.h"
+#include "panda/gfx/vulkan/object/Object.h"
+#include "panda/gfx/vulkan/object/Surface.h"
+#include "panda/gfx/vulkan/systems/OcclusionCullingSystem.h"
+#include "panda/utils/JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#    define PD_SOFTWARE_OCCLUSION_SSE
+#    include <emmintrin.h>
+#endif
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+constexpr auto minClipW = 1e-3F;
+constexpr auto rowsPerBatch = size_t {8};
+constexpr auto occludeesPerBatch = size_t {32};
+constexpr auto laneCount = uint32_t {4};
+
+static_assert(SoftwareOcclusionSystem::width % laneCount == 0);
+
+auto toScreen(const glm::vec4& clip) -> glm::vec3
+{
+    const auto ndc = glm::vec3 {clip} / clip.w;
+    return {(ndc.x * 0.5F + 0.5F) * static_cast<float>(SoftwareOcclusionSystem::width),
+            (ndc.y * 0.5F + 0.5F) * static_cast<float>(SoftwareOcclusionSystem::height),
+            ndc.z};
+}
+
+auto edge(const glm::vec3& a, const glm::vec3& b, float x, float y) -> float
+{
+    return (b.x - a.x) * (y - a.y) - (b.y - a.y) * (x - a.x);
+}
+
+auto alignDown(uint32_t value) -> uint32_t
+{
+    return value - value % laneCount;
+}
+
+auto alignUp(uint32_t value) -> uint32_t
+{
+    return alignDown(value + laneCount - 1);
+}
+
+}
+
+SoftwareOcclusionSystem::SoftwareOcclusionSystem(utils::JobSystem& jobSystem, float frustumMargin)
+    : _jobSystem {jobSystem},
+      _frustumMargin {frustumMargin},
+      _depth(size_t {width} * height, 1.F)
+{
+}
+
+SoftwareOcclusionSystem::~SoftwareOcclusionSystem() noexcept
+{
+    finishCulling();
+}
+
+auto SoftwareOcclusionSystem::beginCulling(const Scene& scene) -> void
+{
+    finishCulling();
+
+    // A widened frustum keeps the result valid when the camera is rotated after culling
+    const auto frustumScale = 1.F / (1.F + _frustumMargin);
+    const auto viewProjection = glm::scale(glm::mat4 {1.F}, glm::vec3 {frustumScale, frustumScale, 1.F}) *
+                                scene.getCamera().getProjection() * scene.getCamera().getView();
+    _cullingJob = _jobSystem.submit([this, &scene, viewProjection] {
+        cull(scene, viewProjection);
+    });
+}
+
+auto SoftwareOcclusionSystem::finishCulling() -> void
+{
+    if (_cullingJob.valid())
+    {
+        _cullingJob.get();
+    }
+}
+
+auto SoftwareOcclusionSystem::isVisible(size_t surfaceIndex) const noexcept -> bool
+{
+    return surfaceIndex >= _visibility.size() || _visibility[surfaceIndex] != 0;
+}
+
+auto SoftwareOcclusionSystem::getStatistics() const noexcept -> const Statistics&
+{
+    return _statistics;
+}
+
+auto SoftwareOcclusionSystem::cull(const Scene& scene, const glm::mat4& viewProjection) -> void
+{
+    collect(scene, viewProjection);
+
+    _jobSystem.parallelFor(height, rowsPerBatch, [this](size_t begin, size_t end) {
+        rasterizeRows(static_cast<uint32_t>(begin), static_cast<uint32_t>(end));
+    });
+
+    _jobSystem.parallelFor(_occludees.size(), occludeesPerBatch, [this, &viewProjection](size_t begin, size_t end) {
+        for (auto i = begin; i < end; i++)
+        {
+            _visibility[_occludees[i].surfaceIndex] = testOccludee(_occludees[i].sphere, viewProjection) ? 1 : 0;
+        }
+    });
+
+    _statistics.culledCount = static_cast<size_t>(std::ranges::count(_visibility, uint8_t {0}));
+}
+
+auto SoftwareOcclusionSystem::collect(const Scene& scene, const glm::mat4& viewProjection) -> void
+{
+    _triangles.clear();
+    _occludees.clear();
+    _visibility.clear();
+    _statistics = {};
+
+    for (const auto& object : scene.getObjects())
+    {
+        const auto modelViewProjection = viewProjection * object->transform.getModelMatrix();
+        const auto triangleCount = _triangles.size();
+
+        for (const auto& surface : object->getSurfaces())
+        {
+            if (surface.isInstanced())
+            {
+                continue;
+            }
+
+            const auto& geometry = surface.getMesh().getOccluderGeometry();
+            if (object->isOccluder && !geometry.indices.empty())
+            {
+                addOccluderTriangles(geometry.positions, geometry.indices, modelViewProjection);
+            }
+            else
+            {
+                _occludees.push_back(
+                    {.sphere = OcclusionCullingSystem::getBoundingSphere(object->transform, surface.getMesh()),
+                     .surfaceIndex = _visibility.size()});
+            }
+            _visibility.push_back(1);
+        }
+
+        if (object->isOccluder)
+        {
+            _statistics.occluderCount++;
+        }
+        _statistics.occluderTriangleCount += _triangles.size() - triangleCount;
+    }
+
+    _statistics.occludeeCount = _occludees.size();
+}
+
+auto SoftwareOcclusionSystem::addOccluderTriangles(const std::vector<glm::vec3>& positions,
+                                                   const std::vector<uint32_t>& indices,
+                                                   const glm::mat4& modelViewProjection) -> void
+{
+    for (auto i = size_t {}; i + 2 < indices.size(); i += 3)
+    {
+        const auto clip0 = modelViewProjection * glm::vec4 {positions[indices[i]], 1.F};
+        const auto clip1 = modelViewProjection * glm::vec4 {positions[indices[i + 1]], 1.F};
+        const auto clip2 = modelViewProjection * glm::vec4 {positions[indices[i + 2]], 1.F};
+
+        if (std::min({clip0.w, clip1.w, clip2.w}) < minClipW)
+        {
+            continue;
+        }
+
+        auto triangle = Triangle {toScreen(clip0), toScreen(clip1), toScreen(clip2)};
+
+        // Counter-clockwise front faces have a negative area in framebuffer space
+        if (edge(triangle.v0, triangle.v1, triangle.v2.x, triangle.v2.y) >= 0.F)
+        {
+            continue;
+        }
+
+        std::swap(triangle.v1, triangle.v2);
+        _triangles.push_back(triangle);
+    }
+}
+
+auto SoftwareOcclusionSystem::rasterizeRows(uint32_t beginRow, uint32_t endRow) -> void
+{
+    std::fill(_depth.begin() + static_cast<std::ptrdiff_t>(beginRow * width),
+              _depth.begin() + static_cast<std::ptrdiff_t>(endRow * width),
+              1.F);
+
+    for (const auto& triangle : _triangles)
+    {
+        rasterizeTriangle(triangle, beginRow, endRow);
+    }
+}
+
+auto SoftwareOcclusionSystem::rasterizeTriangle(const Triangle& triangle, uint32_t beginRow, uint32_t endRow) -> void
+{
+    const auto& [v0, v1, v2] = triangle;
+
+    const auto minX = std::max(std::floor(std::min({v0.x, v1.x, v2.x})), 0.F);
+    const auto maxX = std::min(std::ceil(std::max({v0.x, v1.x, v2.x})), static_cast<float>(width));
+    const auto minY = std::max(std::floor(std::min({v0.y, v1.y, v2.y})), static_cast<float>(beginRow));
+    const auto maxY = std::min(std::ceil(std::max({v0.y, v1.y, v2.y})), static_cast<float>(endRow));
+
+    if (minX >= maxX || minY >= maxY)
+    {
+        return;
+    }
+
+    const auto area = edge(v0, v1, v2.x, v2.y);
+    const auto w0dx = v1.y - v2.y;
+    const auto w1dx = v2.y - v0.y;
+    const auto w2dx = v0.y - v1.y;
+    const auto zdx = (w1dx * (v1.z - v0.z) + w2dx * (v2.z - v0.z)) / area;
+
+    const auto beginX = alignDown(static_cast<uint32_t>(minX));
+    const auto endX = alignUp(static_cast<uint32_t>(maxX));
+    const auto startX = static_cast<float>(beginX) + 0.5F;
+
+    for (auto y = static_cast<uint32_t>(minY); y < static_cast<uint32_t>(maxY); y++)
+    {
+        const auto centerY = static_cast<float>(y) + 0.5F;
+        auto w0 = edge(v1, v2, startX, centerY);
+        auto w1 = edge(v2, v0, startX, centerY);
+        auto w2 = edge(v0, v1, startX, centerY);
+        auto z = v0.z + (w1 * (v1.z - v0.z) + w2 * (v2.z - v0.z)) / area;
+        auto* row = _depth.data() + static_cast<size_t>(y) * width;
+
+#ifdef PD_SOFTWARE_OCCLUSION_SSE
+        const auto lanes = _mm_set_ps(3.F, 2.F, 1.F, 0.F);
+        const auto zero = _mm_setzero_ps();
+        const auto step = static_cast<float>(laneCount);
+        auto w0Lanes = _mm_add_ps(_mm_set1_ps(w0), _mm_mul_ps(lanes, _mm_set1_ps(w0dx)));
+        auto w1Lanes = _mm_add_ps(_mm_set1_ps(w1), _mm_mul_ps(lanes, _mm_set1_ps(w1dx)));
+        auto w2Lanes = _mm_add_ps(_mm_set1_ps(w2), _mm_mul_ps(lanes, _mm_set1_ps(w2dx)));
+        auto zLanes = _mm_add_ps(_mm_set1_ps(z), _mm_mul_ps(lanes, _mm_set1_ps(zdx)));
+
+        for (auto x = beginX; x < endX; x += laneCount)
+        {
+            const auto inside = _mm_cmpge_ps(_mm_min_ps(_mm_min_ps(w0Lanes, w1Lanes), w2Lanes), zero);
+            const auto current = _mm_loadu_ps(row + x);
+            const auto nearest = _mm_min_ps(current, _mm_max_ps(zLanes, zero));
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+
+            w0Lanes = _mm_add_ps(w0Lanes, _mm_set1_ps(w0dx * step));
+            w1Lanes = _mm_add_ps(w1Lanes, _mm_set1_ps(w1dx * step));
+            w2Lanes = _mm_add_ps(w2Lanes, _mm_set1_ps(w2dx * step));
+            zLanes = _mm_add_ps(zLanes, _mm_set1_ps(zdx * step));
+        }
+#else
+        for (auto x = beginX; x < endX; x++)
+        {
+            if (w0 >= 0.F && w1 >= 0.F && w2 >= 0.F)
+            {
+                row[x] = std::min(row[x], std::max(z, 0.F));
+            }
+
+            w0 += w0dx;
+            w1 += w1dx;
+            w2 += w2dx;
+            z += zdx;
+        }
+#endif
+    }
+}
+
+auto SoftwareOcclusionSystem::testOccludee(const glm::vec4& sphere, const glm::mat4& viewProjection) const -> bool
+{
+    auto minScreen = glm::vec3 {std::numeric_limits<float>::max()};
+    auto maxScreen = glm::vec3 {std::numeric_limits<float>::lowest()};
+
+    for (auto corner = uint32_t {}; corner < 8; corner++)
+    {
+        const auto offset = glm::vec3 {(corner & 1U) != 0 ? sphere.w : -sphere.w,
+                                       (corner & 2U) != 0 ? sphere.w : -sphere.w,
+                                       (corner & 4U) != 0 ? sphere.w : -sphere.w};
+        const auto clip = viewProjection * glm::vec4 {glm::vec3 {sphere} + offset, 1.F};
+        if (clip.w < minClipW)
+        {
+            return true;
+        }
+
+        const auto screen = toScreen(clip);
+        minScreen = glm::min(minScreen, screen);
+        maxScreen = glm::max(maxScreen, screen);
+    }
+
+    if (maxScreen.x < 0.F || maxScreen.y < 0.F || minScreen.x > static_cast<float>(width) ||
+        minScreen.y > static_cast<float>(height) || minScreen.z > 1.F)
+    {
+        return false;
+    }
+
+    const auto beginX = alignDown(std::min(static_cast<uint32_t>(std::max(minScreen.x, 0.F)), width - 1));
+    const auto rightX = std::min(std::ceil(maxScreen.x), static_cast<float>(width));
+    const auto endX = std::max(alignUp(static_cast<uint32_t>(rightX)), beginX + laneCount);
+    const auto beginY = std::min(static_cast<uint32_t>(std::max(minScreen.y, 0.F)), height - 1);
+    const auto endY =
+        std::max(static_cast<uint32_t>(std::min(std::ceil(maxScreen.y), static_cast<float>(height))), beginY + 1);
+
+    for (auto y = beginY; y < endY; y++)
+    {
+        const auto* row = _depth.data() + static_cast<size_t>(y) * width;
+
+#ifdef PD_SOFTWARE_OCCLUSION_SSE
+        const auto nearest = _mm_set1_ps(minScreen.z);
+        for (auto x = beginX; x < endX; x += laneCount)
+        {
+            if (_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), nearest)) != 0)
+            {
+                return true;
+            }
+        }
+#else
+        for (auto x = beginX; x < endX; x++)
+        {
+            if (row[x] >= minScreen.z)
+            {
+                return true;
+            }
+        }
+#endif
+    }
+
+    return false;
+}
+
+}
@@ -0,0 +1,216 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/systems/StaticBatchSystem.h"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/common.hpp>
+#include <glm/ext/matrix_float3x3.hpp>
+#include <glm/ext/matrix_float4x4.hpp>
+#include <glm/ext/vector_float3.hpp>
+#include <glm/ext/vector_float4.hpp>
+#include <glm/geometric.hpp>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_handles.hpp>
+
+#include "panda/Logger.h"
+#include "panda/gfx/vulkan/DeletionQueue.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/Scene.h"
+#include "panda/gfx/vulkan/Vertex.h"
+#include "panda/gfx/vulkan/object/Mesh.h"
+#include "panda/gfx/vulkan/object/Object.h"
+#include "panda/gfx/vulkan/object/Surface.h"
+#include "panda/gfx/vulkan/object/Texture.h"
+
+namespace panda::gfx::vulkan
+{
+
+StaticBatchSystem::StaticBatchSystem(const Device& device, DeletionQueue& deletionQueue, bool createPositionStream)
+    : _device {device},
+      _deletionQueue {deletionQueue},
+      _createPositionStream {createPositionStream}
+{
+}
+
+StaticBatchSystem::~StaticBatchSystem() noexcept = default;
+
+auto StaticBatchSystem::isBatchable(const Surface& surface) noexcept -> bool
+{
+    return !surface.isInstanced() && !surface.getMesh().getGeometry().vertices.empty();
+}
+
+auto StaticBatchSystem::update(vk::CommandBuffer commandBuffer, const Scene& scene) -> void
+{
+    auto dirtyKeys = std::set<BatchKey> {};
+    auto staticObjects = std::unordered_set<Object::Id> {};
+
+    for (const auto& object : scene.getObjects())
+    {
+        if (!object->isStatic)
+        {
+            continue;
+        }
+
+        staticObjects.insert(object->getId());
+        auto surfaces = object->getSurfaces();
+        const auto it = _objects.find(object->getId());
+        if (it != _objects.end() && it->second.transform == object->transform && it->second.surfaces == surfaces)
+        {
+            continue;
+        }
+
+        if (it != _objects.end())
+        {
+            dirtyKeys.insert(it->second.keys.cbegin(), it->second.keys.cend());
+        }
+
+        auto keys = getBatchKeys(object->transform, surfaces);
+        dirtyKeys.insert(keys.cbegin(), keys.cend());
+        _objects.insert_or_assign(
+            object->getId(),
+            BatchedObject {.transform = object->transform, .surfaces = std::move(surfaces), .keys = std::move(keys)});
+    }
+
+    for (auto it = _objects.begin(); it != _objects.end();)
+    {
+        if (staticObjects.contains(it->first))
+        {
+            ++it;
+            continue;
+        }
+
+        dirtyKeys.insert(it->second.keys.cbegin(), it->second.keys.cend());
+        it = _objects.erase(it);
+    }
+
+    if (dirtyKeys.empty())
+    {
+        return;
+    }
+
+    const auto upload = Mesh::Upload {.commandBuffer = commandBuffer, .deletionQueue = _deletionQueue};
+    for (const auto& key : dirtyKeys)
+    {
+        rebuildBatch(upload, key);
+    }
+
+    _surfaces.clear();
+    for (const auto& [key, mesh] : _batches)
+    {
+        _surfaces.emplace_back(key.texture, mesh.get());
+    }
+
+    log::Info("Rebuilt {} static batches, {} batches in total", dirtyKeys.size(), _batches.size());
+}
+
+auto StaticBatchSystem::getSurfaces() const noexcept -> const std::vector<Surface>&
+{
+    return _surfaces;
+}
+
+auto StaticBatchSystem::getBatchKeys(const Transform& transform, const std::vector<Surface>& surfaces)
+    -> std::vector<BatchKey>
+{
+    auto keys = std::vector<BatchKey> {};
+    for (const auto& surface : surfaces)
+    {
+        const auto key = BatchKey {.texture = &surface.getTexture(), .cell = getCell(transform)};
+        if (isBatchable(surface) && std::ranges::find(keys, key) == keys.cend())
+        {
+            keys.push_back(key);
+        }
+    }
+
+    return keys;
+}
+
+auto StaticBatchSystem::getCell(const Transform& transform) -> std::array<int32_t, 3>
+{
+    const auto cell = glm::floor(transform.translation / cellSize);
+    return {static_cast<int32_t>(cell.x), static_cast<int32_t>(cell.y), static_cast<int32_t>(cell.z)};
+}
+
+auto StaticBatchSystem::appendGeometry(const MeshGeometry& geometry, const Transform& transform, MeshGeometry& batch)
+    -> void
+{
+    const auto modelMatrix = transform.getModelMatrix();
+    const auto rotationMatrix = transform.getRotationMatrix();
+    const auto baseVertex = static_cast<uint32_t>(batch.vertices.size());
+
+    for (const auto& vertex : geometry.vertices)
+    {
+        batch.vertices.push_back({.position = glm::vec3 {modelMatrix * glm::vec4 {vertex.position, 1.F}},
+                                  .normal = glm::normalize(rotationMatrix * vertex.normal),
+                                  .uv = vertex.uv});
+    }
+
+    if (geometry.indices.empty())
+    {
+        const auto indexCount = geometry.vertices.size() - geometry.vertices.size() % 3;
+        batch.indices.resize(batch.indices.size() + indexCount);
+        std::iota(batch.indices.end() - static_cast<std::ptrdiff_t>(indexCount), batch.indices.end(), baseVertex);
+        return;
+    }
+
+    std::ranges::transform(geometry.indices, std::back_inserter(batch.indices), [baseVertex](auto index) {
+        return baseVertex + index;
+    });
+}
+
+auto StaticBatchSystem::rebuildBatch(const Mesh::Upload& upload, const BatchKey& key) -> void
+{
+    auto batch = MeshGeometry {};
+    for (const auto& [id, object] : _objects)
+    {
+        if (std::ranges::find(object.keys, key) == object.keys.cend())
+        {
+            continue;
+        }
+
+        for (const auto& surface : object.surfaces)
+        {
+            if (isBatchable(surface) && &surface.getTexture() == key.texture)
+            {
+                appendGeometry(surface.getMesh().getGeometry(), object.transform, batch);
+            }
+        }
+    }
+
+    if (const auto it = _batches.find(key); it != _batches.end())
+    {
+        _deletionQueue.push([mesh = std::shared_ptr<Mesh> {std::move(it->second)}] {});
+        _batches.erase(it);
+    }
+
+    if (batch.vertices.size() < 3)
+    {
+        return;
+    }
+
+    _batches.emplace(key,
+                     std::make_unique<Mesh>(fmt::format("StaticBatch[{}, {}, {}, {}]",
+                                                        key.texture->getId(),
+                                                        key.cell[0],
+                                                        key.cell[1],
+                                                        key.cell[2]),
+                                            _device,
+                                            upload,
+                                            batch.vertices,
+                                            batch.indices,
+                                            _createPositionStream));
+}
+
+}
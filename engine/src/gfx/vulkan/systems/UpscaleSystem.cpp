@@ -0,0 +1,178 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/gfx/vulkan/systems/UpscaleSystem.h"
+
+#include <glm/ext/vector_float2.hpp>
+#include <memory>
+#include <vulkan/vulkan.hpp>
+#include <vulkan/vulkan_enums.hpp>
+#include <vulkan/vulkan_handles.hpp>
+#include <vulkan/vulkan_structs.hpp>
+
+#include "panda/gfx/vulkan/Descriptor.h"
+#include "panda/gfx/vulkan/Device.h"
+#include "panda/gfx/vulkan/FrameInfo.h"
+#include "panda/gfx/vulkan/Pipeline.h"
+#include "panda/internal/config.h"
+#include "panda/utils/format/gfx/api/vulkan/ResultFormatter.h"  // NOLINT(misc-include-cleaner)
+
+namespace panda::gfx::vulkan
+{
+
+namespace
+{
+
+struct PushConstantData
+{
+    glm::vec2 uvScale;
+    float sharpness;
+};
+
+}
+
+UpscaleSystem::UpscaleSystem(const Device& device, vk::RenderPass renderPass, float sharpness)
+    : _device {device},
+      _descriptorLayout {createDescriptorLayout(_device)},
+      _pipelineLayout {createPipelineLayout(_device, _descriptorLayout->getDescriptorSetLayout())},
+      _renderPass {renderPass},
+      _sampler {createSampler(_device)},
+      _pipeline {createPipeline()},
+      _sharpness {sharpness}
+{
+}
+
+UpscaleSystem::~UpscaleSystem() noexcept
+{
+    _device.logicalDevice.destroy(_sampler);
+    _device.logicalDevice.destroyPipelineLayout(_pipelineLayout);
+}
+
+auto UpscaleSystem::createDescriptorLayout(const Device& device) -> std::unique_ptr<DescriptorSetLayout>
+{
+    return DescriptorSetLayout::Builder(device)
+        .addBinding(0, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+        .build(vk::DescriptorSetLayoutCreateFlagBits::ePushDescriptorKHR);
+}
+
+auto UpscaleSystem::createPipelineLayout(const Device& device, vk::DescriptorSetLayout setLayout)
+    -> vk::PipelineLayout
+{
+    const auto pushConstantData =
+        vk::PushConstantRange {vk::ShaderStageFlagBits::eFragment, 0, sizeof(PushConstantData)};
+
+    const auto pipelineLayoutInfo = vk::PipelineLayoutCreateInfo {{}, setLayout, pushConstantData};
+    return expect(device.logicalDevice.createPipelineLayout(pipelineLayoutInfo),
+                  vk::Result::eSuccess,
+                  "Can't create pipeline layout");
+}
+
+auto UpscaleSystem::createSampler(const Device& device) -> vk::Sampler
+{
+    const auto samplerInfo = vk::SamplerCreateInfo {{},
+                                                    vk::Filter::eLinear,
+                                                    vk::Filter::eLinear,
+                                                    vk::SamplerMipmapMode::eNearest,
+                                                    vk::SamplerAddressMode::eClampToEdge,
+                                                    vk::SamplerAddressMode::eClampToEdge,
+                                                    vk::SamplerAddressMode::eClampToEdge,
+                                                    0.F,
+                                                    vk::False,
+                                                    1.F,
+                                                    vk::False,
+                                                    vk::CompareOp::eAlways,
+                                                    0.F,
+                                                    0.F,
+                                                    vk::BorderColor::eFloatOpaqueBlack,
+                                                    vk::False};
+
+    return expect(device.logicalDevice.createSampler(samplerInfo), vk::Result::eSuccess, "Failed to create sampler");
+}
+
+auto UpscaleSystem::createPipeline() const -> std::unique_ptr<Pipeline>
+{
+    const auto inputAssemblyInfo =
+        vk::PipelineInputAssemblyStateCreateInfo {{}, vk::PrimitiveTopology::eTriangleList, vk::False};
+
+    const auto viewportInfo = vk::PipelineViewportStateCreateInfo {{}, 1, {}, 1, {}};
+    const auto rasterizationInfo = vk::PipelineRasterizationStateCreateInfo {{},
+                                                                             vk::False,
+                                                                             vk::False,
+                                                                             vk::PolygonMode::eFill,
+                                                                             vk::CullModeFlagBits::eNone,
+                                                                             vk::FrontFace::eCounterClockwise,
+                                                                             vk::False,
+                                                                             {},
+                                                                             {},
+                                                                             {},
+                                                                             1.F};
+
+    const auto multisamplingInfo = vk::PipelineMultisampleStateCreateInfo {{}, vk::SampleCountFlagBits::e1, vk::False};
+    const auto colorBlendAttachment =
+        vk::PipelineColorBlendAttachmentState {vk::False,
+                                               vk::BlendFactor::eOne,
+                                               vk::BlendFactor::eZero,
+                                               vk::BlendOp::eAdd,
+                                               vk::BlendFactor::eOne,
+                                               vk::BlendFactor::eZero,
+                                               vk::BlendOp::eAdd,
+                                               vk::ColorComponentFlagBits::eR | vk::ColorComponentFlagBits::eG |
+                                                   vk::ColorComponentFlagBits::eB | vk::ColorComponentFlagBits::eA};
+
+    const auto colorBlendInfo =
+        vk::PipelineColorBlendStateCreateInfo {{}, vk::False, vk::LogicOp::eCopy, colorBlendAttachment};
+
+    const auto depthStencilInfo = vk::PipelineDepthStencilStateCreateInfo {{},
+                                                                           vk::False,
+                                                                           vk::False,
+                                                                           vk::CompareOp::eAlways,
+                                                                           vk::False,
+                                                                           vk::False};
+
+    return std::make_unique<Pipeline>(_device,
+                                      PipelineConfig {.vertexShaderPath = config::shaderPath / "fullscreen.vert.spv",
+                                                      .fragmentShaderPath = config::shaderPath / "upscale.frag.spv",
+                                                      .vertexBindingDescriptions = {},
+                                                      .vertexAttributeDescriptions = {},
+                                                      .inputAssemblyInfo = inputAssemblyInfo,
+                                                      .viewportInfo = viewportInfo,
+                                                      .rasterizationInfo = rasterizationInfo,
+                                                      .multisamplingInfo = multisamplingInfo,
+                                                      .colorBlendInfo = colorBlendInfo,
+                                                      .depthStencilInfo = depthStencilInfo,
+                                                      .pipelineLayout = _pipelineLayout,
+                                                      .renderPass = _renderPass,
+                                                      .subpass = 0,
+                                                      .vertexSpecialization = {},
+                                                      .fragmentSpecialization = {}});
+}
+
+auto UpscaleSystem::render(const FrameInfo& frameInfo,
+                           vk::ImageView sceneColor,
+                           vk::Extent2D renderExtent,
+                           vk::Extent2D renderTargetExtent) const -> void
+{
+    frameInfo.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, _pipeline->getHandle());
+
+    const auto sceneColorInfo =
+        vk::DescriptorImageInfo {_sampler, sceneColor, vk::ImageLayout::eShaderReadOnlyOptimal};
+    DescriptorWriter(*_descriptorLayout)
+        .writeImage(0, sceneColorInfo)
+        .push(frameInfo.commandBuffer, _pipelineLayout);
+
+    const auto push = PushConstantData {
+        .uvScale = {static_cast<float>(renderExtent.width) / static_cast<float>(renderTargetExtent.width),
+                    static_cast<float>(renderExtent.height) / static_cast<float>(renderTargetExtent.height)},
+        .sharpness = _sharpness
+    };
+    frameInfo.commandBuffer.pushConstants<PushConstantData>(_pipelineLayout,
+                                                            vk::ShaderStageFlagBits::eFragment,
+                                                            0,
+                                                            push);
+
+    static constexpr auto fullscreenTriangleVerticesCount = 3;
+    frameInfo.commandBuffer.draw(fullscreenTriangleVerticesCount, 1, 0, 0);
+}
+
+}
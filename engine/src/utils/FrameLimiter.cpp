@@ -0,0 +1,43 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/utils/FrameLimiter.h"
+
+#include <chrono>
+#include <thread>
+
+namespace panda::utils
+{
+
+FrameLimiter::FrameLimiter(float maxFrameRate)
+    : _frameDuration {std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+          std::chrono::duration<float> {1.F / maxFrameRate})},
+      _nextFrame {std::chrono::steady_clock::now()}
+{
+    expect(maxFrameRate > 0.F, "Frame rate limit must be positive");
+}
+
+auto FrameLimiter::wait() -> void
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (_nextFrame <= now)
+    {
+        _nextFrame = now + _frameDuration;
+        return;
+    }
+
+    // Sleeping is only accurate to the scheduler tick, so the last part of the wait is spent yielding
+    if (_nextFrame - now > spinThreshold)
+    {
+        std::this_thread::sleep_for(_nextFrame - now - spinThreshold);
+    }
+    while (std::chrono::steady_clock::now() < _nextFrame)
+    {
+        std::this_thread::yield();
+    }
+
+    _nextFrame += _frameDuration;
+}
+
+}
@@ -0,0 +1,133 @@
+// clang-format off
+#include "panda/utils/Assert.h"
+// clang-format on
+
+#include "panda/utils/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace panda::utils
+{
+
+JobSystem::JobSystem(size_t workerCount)
+{
+    _workers.reserve(workerCount);
+    for (auto i = size_t {}; i < workerCount; i++)
+    {
+        _workers.emplace_back([this](const std::stop_token& stopToken) {
+            work(stopToken);
+        });
+    }
+}
+
+auto JobSystem::getDefaultWorkerCount() noexcept -> size_t
+{
+    return std::max(std::thread::hardware_concurrency(), 2U) - 1;
+}
+
+auto JobSystem::submit(Job job) -> std::future<void>
+{
+    auto task = std::packaged_task<void()> {std::move(job)};
+    auto result = task.get_future();
+
+    if (_workers.empty())
+    {
+        task();
+        return result;
+    }
+
+    {
+        const auto lock = std::lock_guard {_queueMutex};
+        _jobs.push(std::move(task));
+    }
+    _queueCondition.notify_one();
+    return result;
+}
+
+auto JobSystem::parallelFor(size_t count, size_t minBatchSize, const RangeJob& job) -> void
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    const auto batchCount = std::clamp(count / std::max(minBatchSize, size_t {1}), size_t {1}, _workers.size() + 1);
+    const auto batchSize = (count + batchCount - 1) / batchCount;
+
+    auto batches = std::vector<std::future<void>> {};
+    batches.reserve(batchCount);
+
+    for (auto begin = batchSize; begin < count; begin += batchSize)
+    {
+        batches.push_back(submit([&job, begin, end = std::min(begin + batchSize, count)] {
+            job(begin, end);
+        }));
+    }
+
+    job(0, std::min(batchSize, count));
+
+    for (auto& batch : batches)
+    {
+        while (batch.wait_for(std::chrono::seconds {}) != std::future_status::ready)
+        {
+            if (!tryRunPendingJob())
+            {
+                std::this_thread::yield();
+            }
+        }
+        batch.get();
+    }
+}
+
+auto JobSystem::getWorkerCount() const noexcept -> size_t
+{
+    return _workers.size();
+}
+
+auto JobSystem::tryRunPendingJob() -> bool
+{
+    auto task = std::packaged_task<void()> {};
+    {
+        const auto lock = std::lock_guard {_queueMutex};
+        if (_jobs.empty())
+        {
+            return false;
+        }
+
+        task = std::move(_jobs.front());
+        _jobs.pop();
+    }
+    task();
+    return true;
+}
+
+auto JobSystem::work(const std::stop_token& stopToken) -> void
+{
+    while (true)
+    {
+        auto task = std::packaged_task<void()> {};
+        {
+            auto lock = std::unique_lock {_queueMutex};
+            if (!_queueCondition.wait(lock, stopToken, [this] {
+                    return !_jobs.empty();
+                }))
+            {
+                return;
+            }
+
+            task = std::move(_jobs.front());
+            _jobs.pop();
+        }
+        task();
+    }
+}
+
+}